@@ -67,6 +67,18 @@ async::result<protocols::fs::Error> doFlock(void *object, int flags) {
 
 namespace detail {
 
+// Resizes the file and keeps clients that read from the page cache up to date.
+template <Inode T>
+async::result<frg::expected<protocols::fs::Error>> resizeFile(T *inode, size_t newSize) {
+	if (!inode->cacheStatus)
+		co_return co_await inode->resizeFile(newSize);
+
+	inode->cacheStatus->beginResize();
+	auto outcome = co_await inode->resizeFile(newSize);
+	inode->cacheStatus->endResize(inode->fileSize());
+	co_return outcome;
+}
+
 template <Inode T>
 async::result<protocols::fs::ReadResult> doReadImpl(T *inode, void *buffer, size_t length, auto &offset) {
 	protocols::ostrace::Timer timer;
@@ -97,8 +109,7 @@ async::result<protocols::fs::ReadResult> doReadImpl(T *inode, void *buffer, size
 	auto chunkOffset = offset;
 	offset += chunkSize;
 
-	// TODO: Add a sendFromMemory action to exchangeMsgs to avoid
-	// having to copy this data twice.
+	// Note that doReadMemoryRangeImpl() avoids this copy.
 	auto readMemory = co_await helix_ng::readMemory(
 		inode->accessMemory(),
 		chunkOffset, chunkSize, buffer);
@@ -130,10 +141,9 @@ doWriteImpl(T *inode, const void *buffer, size_t length, bool append, auto &offs
 	if (append)
 		offset = inode->fileSize();
 	if (offset >= inode->fileSize())
-		FRG_CO_TRY(co_await inode->resizeFile(offset + length));
+		FRG_CO_TRY(co_await resizeFile(inode, offset + length));
 
-	// TODO: Add a recvToMemory action to exchangeMsgs to avoid
-	// having to copy this data twice.
+	// Note that doWriteMemoryRangeImpl() avoids this copy.
 	auto writeMemory = co_await helix_ng::writeMemory(
 		inode->accessMemory(),
 		offset, length, buffer);
@@ -144,6 +154,71 @@ doWriteImpl(T *inode, const void *buffer, size_t length, bool append, auto &offs
 	co_return length;
 }
 
+// Returns the range of the page cache that holds the data.
+// The caller sends it to the client using helix_ng::sendFromMemory().
+template <Inode T>
+async::result<protocols::fs::MemoryRangeResult>
+doReadMemoryRangeImpl(T *inode, size_t length, auto &offset) {
+	protocols::ostrace::Timer timer;
+	frg::scope_exit evtOnExit{[&] {
+		ostContext.emit(
+			ostEvtRead,
+			ostAttrNumBytes(length),
+			ostAttrTime(timer.elapsed())
+		);
+	}};
+
+	co_await inode->readyEvent.wait();
+
+	if (inode->fileType == FileType::kTypeDirectory)
+		co_return std::unexpected{protocols::fs::Error::isDirectory};
+	if (!length)
+		co_return protocols::fs::MemoryRange{inode->accessMemory(), 0, 0};
+	if (offset >= inode->fileSize())
+		co_return std::unexpected{protocols::fs::Error::endOfFile};
+
+	auto chunkSize = std::min(length, inode->fileSize() - offset);
+	protocols::fs::MemoryRange range{inode->accessMemory(), offset, chunkSize};
+	offset += chunkSize;
+
+	co_return range;
+}
+
+// Returns the range of the page cache that the data needs to be written to.
+// The caller receives it from the client using helix_ng::recvToMemory().
+template <Inode T>
+async::result<protocols::fs::MemoryRangeResult>
+doWriteMemoryRangeImpl(T *inode, size_t length, bool append, auto &offset) {
+	protocols::ostrace::Timer timer;
+	frg::scope_exit evtOnExit{[&] {
+		ostContext.emit(
+			ostEvtWrite,
+			ostAttrNumBytes(length),
+			ostAttrTime(timer.elapsed())
+		);
+	}};
+
+	co_await inode->readyEvent.wait();
+
+	if (inode->fileType == FileType::kTypeDirectory)
+		co_return std::unexpected{protocols::fs::Error::isDirectory};
+	if (!length)
+		co_return protocols::fs::MemoryRange{inode->accessMemory(), 0, 0};
+
+	if (append)
+		offset = inode->fileSize();
+	// The range must be covered by the file before the data arrives.
+	if (offset + length > inode->fileSize()) {
+		auto resizeOutcome = co_await resizeFile(inode, offset + length);
+		if (!resizeOutcome)
+			co_return std::unexpected{resizeOutcome.error()};
+	}
+
+	protocols::fs::MemoryRange range{inode->accessMemory(), offset, length};
+	offset += length;
+
+	co_return range;
+}
 
 } // namespace detail
 
@@ -221,6 +296,74 @@ async::result<frg::expected<protocols::fs::Error, size_t>> doPwrite(void *object
 	co_return co_await detail::doWriteImpl(inode.get(), buffer, length, false, unsignedOffset);
 }
 
+template <FileSystem T>
+async::result<protocols::fs::MemoryRangeResult> doReadMemoryRange(void *object,
+		std::optional<int64_t> offset, helix_ng::CredentialsView, size_t length,
+		async::cancellation_token) {
+	using File = typename T::File;
+	using Inode = typename T::Inode;
+
+	auto self = static_cast<File *>(object);
+	auto inode = std::static_pointer_cast<Inode>(self->inode);
+
+	if (!offset) {
+		co_await self->mutex.async_lock();
+		frg::unique_lock lock{frg::adopt_lock, self->mutex};
+
+		co_return co_await detail::doReadMemoryRangeImpl(inode.get(), length, self->offset);
+	}
+
+	if (*offset < 0)
+		co_return std::unexpected{protocols::fs::Error::illegalArguments};
+	size_t unsignedOffset = *offset;
+
+	co_await self->mutex.async_lock_shared();
+	frg::shared_lock lock{frg::adopt_lock, self->mutex};
+
+	co_return co_await detail::doReadMemoryRangeImpl(inode.get(), length, unsignedOffset);
+}
+
+template <FileSystem T>
+async::result<protocols::fs::MemoryRangeResult> doWriteMemoryRange(void *object,
+		std::optional<int64_t> offset, helix_ng::CredentialsView, size_t length) {
+	using File = typename T::File;
+	using Inode = typename T::Inode;
+
+	auto self = static_cast<File *>(object);
+	auto inode = std::static_pointer_cast<Inode>(self->inode);
+
+	// The range must not be truncated before the data arrives.
+	co_await inode->resizeMutex.async_lock_shared();
+	std::shared_ptr<void> hold{nullptr, [inode] (void *) {
+		inode->resizeMutex.unlock_shared();
+	}};
+
+	protocols::fs::MemoryRangeResult range;
+	if (!offset) {
+		if (!self->write)
+			co_return std::unexpected{protocols::fs::Error::badFileDescriptor};
+
+		co_await self->mutex.async_lock();
+		frg::unique_lock lock{frg::adopt_lock, self->mutex};
+
+		range = co_await detail::doWriteMemoryRangeImpl(inode.get(), length,
+				self->append, self->offset);
+	} else {
+		if (*offset < 0)
+			co_return std::unexpected{protocols::fs::Error::illegalArguments};
+		size_t unsignedOffset = *offset;
+
+		co_await self->mutex.async_lock_shared();
+		frg::shared_lock lock{frg::adopt_lock, self->mutex};
+
+		range = co_await detail::doWriteMemoryRangeImpl(inode.get(), length, false, unsignedOffset);
+	}
+
+	if (range)
+		range->hold = std::move(hold);
+	co_return range;
+}
+
 template <FileSystem T>
 async::result<frg::expected<protocols::fs::Error>> doTruncate(void *object, size_t size) {
 	using File = typename T::File;
@@ -229,12 +372,17 @@ async::result<frg::expected<protocols::fs::Error>> doTruncate(void *object, size
 	auto self = static_cast<File *>(object);
 	auto inode = std::static_pointer_cast<Inode>(self->inode);
 
+	// Wait until data that is in flight to the page cache has arrived.
+	// This is locked before the file's mutex, like in doWriteMemoryRange().
+	co_await inode->resizeMutex.async_lock();
+	frg::unique_lock resizeLock{frg::adopt_lock, inode->resizeMutex};
+
 	co_await self->mutex.async_lock_shared();
 	frg::shared_lock lock{frg::adopt_lock, self->mutex};
 
 	co_await inode->readyEvent.wait();
 
-	FRG_CO_TRY(co_await inode->resizeFile(size));
+	FRG_CO_TRY(co_await detail::resizeFile(inode.get(), size));
 
 	co_return frg::success;
 }
@@ -252,6 +400,25 @@ doAccessMemory(void *object) {
 	co_return inode->accessMemory();
 }
 
+template <FileSystem T>
+async::result<std::expected<protocols::fs::CacheAccess, protocols::fs::Error>>
+doAccessCache(void *object) {
+	using File = typename T::File;
+	using Inode = typename T::Inode;
+
+	auto self = static_cast<File *>(object);
+	auto inode = std::static_pointer_cast<Inode>(self->inode);
+
+	co_await inode->readyEvent.wait();
+
+	if (inode->fileType != FileType::kTypeRegular)
+		co_return std::unexpected{protocols::fs::Error::illegalOperationTarget};
+
+	if (!inode->cacheStatus)
+		inode->cacheStatus.emplace(inode->fileSize());
+	co_return protocols::fs::CacheAccess{inode->accessMemory(), inode->cacheStatus->getMemory()};
+}
+
 template <FileSystem T>
 async::result<void> doObstructLink(std::shared_ptr<void> object, std::string name) {
 	using Inode = typename T::Inode;
@@ -151,6 +151,9 @@ Inode::insertEntry(std::string name, int64_t ino, blockfs::FileType type) {
 				target->diskInode(), fs.inodeSize);
 		HEL_CHECK(syncInode.error());
 
+		fs.changes.notify(number);
+		fs.changes.notify(ino);
+
 		DirEntry entry;
 		entry.inode = ino;
 		entry.fileType = type;
@@ -284,6 +287,8 @@ async::result<frg::expected<protocols::fs::Error>> Inode::removeEntry(std::strin
 					target->diskInode(), fs.inodeSize);
 			HEL_CHECK(syncInode.error());
 
+			fs.changes.notify(number);
+			fs.changes.notify(target->number);
 			co_return {};
 		}
 
@@ -522,6 +527,8 @@ async::result<protocols::fs::Error> Inode::chmod(int mode) {
 			diskInode(), fs.inodeSize);
 	HEL_CHECK(syncInode.error());
 
+	fs.changes.notify(number);
+
 	co_return protocols::fs::Error::none;
 }
 
@@ -538,6 +545,8 @@ async::result<protocols::fs::Error> Inode::chown(std::optional<uid_t> uid, std::
 			diskInode(), fs.inodeSize);
 	HEL_CHECK(syncInode.error());
 
+	fs.changes.notify(number);
+
 	co_return protocols::fs::Error::none;
 }
 
@@ -557,6 +566,11 @@ async::result<protocols::fs::Error> Inode::updateTimes(
 			diskInode(), fs.inodeSize);
 	HEL_CHECK(syncInode.error());
 
+	// Every open() updates the access time. Do not report such updates, otherwise clients
+	// could hardly ever use their caches. Cached access times are thus not exact.
+	if(mtime || ctime)
+		fs.changes.notify(number);
+
 	co_return protocols::fs::Error::none;
 }
 
@@ -598,6 +612,8 @@ Inode::resizeFile(size_t newSize) {
 		diskInode(), fs.inodeSize);
 	HEL_CHECK(syncInode.error());
 
+	fs.changes.notify(number);
+
 	co_return frg::success;
 }
 
@@ -955,6 +971,8 @@ async::result<std::shared_ptr<BaseInode>> FileSystem::createRegular(int uid, int
 			disk_inode, inodeSize);
 	HEL_CHECK(syncInode.error());
 
+	// Clients might still know a previous incarnation of this inode number.
+	changes.notify(ino);
 	co_return accessInode(ino);
 }
 
@@ -994,6 +1012,7 @@ async::result<std::shared_ptr<Inode>> FileSystem::createDirectory() {
 			disk_inode, inodeSize);
 	HEL_CHECK(syncInode.error());
 
+	changes.notify(ino);
 	co_return std::static_pointer_cast<Inode>(accessInode(ino));
 }
 
@@ -1028,6 +1047,7 @@ async::result<std::shared_ptr<Inode>> FileSystem::createSymlink() {
 			disk_inode, inodeSize);
 	HEL_CHECK(syncInode.error());
 
+	changes.notify(ino);
 	co_return std::static_pointer_cast<Inode>(accessInode(ino));
 }
 
@@ -268,6 +268,10 @@ struct FileSystem final : BaseFileSystem {
 	async::result<std::shared_ptr<BaseInode>> createRegular(int uid, int gid, uint32_t parentIno) override;
 	protocols::fs::FsStats getFsStats() override;
 
+	protocols::fs::ChangeTracker *changeTracker() override {
+		return &changes;
+	}
+
 	async::result<std::shared_ptr<Inode>> createDirectory();
 	async::result<std::shared_ptr<Inode>> createSymlink();
 
@@ -311,6 +315,9 @@ struct FileSystem final : BaseFileSystem {
 	helix::Mapping inodeTableMapping;
 
 	std::unordered_map<uint32_t, std::weak_ptr<Inode>> activeInodes;
+
+	// Inodes need to report changes of directory entries and of their attributes.
+	protocols::fs::ChangeTracker changes;
 };
 
 // --------------------------------------------------------
@@ -276,8 +276,11 @@ constinit protocols::fs::FileOperations fileOperations {
 	.pread        = &doPread<FileSystem>,
 	.write        = &doWrite<FileSystem>,
 	.pwrite       = &doPwrite<FileSystem>,
+	.readMemoryRange  = &doReadMemoryRange<FileSystem>,
+	.writeMemoryRange = &doWriteMemoryRange<FileSystem>,
 	.readEntries  = &readEntries,
 	.accessMemory = &doAccessMemory<FileSystem>,
+	.accessCache = &doAccessCache<FileSystem>,
 	.truncate     = &doTruncate<FileSystem>,
 	.flock        = &doFlock<FileSystem>,
 	.getFileFlags = &getFileFlags,
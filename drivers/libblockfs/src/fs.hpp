@@ -2,6 +2,7 @@
 
 #include "common.hpp"
 #include <memory>
+#include <optional>
 #include <unordered_set>
 
 #include <async/mutex.hpp>
@@ -36,6 +37,13 @@ struct BaseInode {
 
 	FlockManager flockManager;
 	std::unordered_set<std::string> obstructedLinks;
+
+	// Held shared while data is received into the page cache (see doWriteMemoryRange())
+	// and exclusively by truncation. Otherwise, data could land beyond EOF.
+	async::shared_mutex resizeMutex;
+
+	// Created once a client maps the page cache (see doAccessCache()).
+	std::optional<protocols::fs::CacheStatusProvider> cacheStatus;
 };
 
 struct BaseFile {
@@ -69,6 +77,11 @@ struct BaseFileSystem {
 	virtual async::result<std::shared_ptr<BaseInode>> createRegular(int uid, int gid, uint32_t parentIno) = 0;
 	virtual protocols::fs::FsStats getFsStats() = 0;
 
+	// Returns nullptr if the file system does not report changes to clients.
+	virtual protocols::fs::ChangeTracker *changeTracker() {
+		return nullptr;
+	}
+
 	constexpr BaseFileSystem() = default;
 
 	BaseFileSystem(const BaseFileSystem &) = delete;
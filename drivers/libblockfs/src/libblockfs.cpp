@@ -243,6 +243,57 @@ async::detached servePartition(helix::UniqueLane lane, gpt::Partition *partition
 			auto [send_resp] = co_await helix_ng::exchangeMsgs(conversation,
 				helix_ng::sendBuffer(ser.data(), ser.size()));
 			HEL_CHECK(send_resp.error());
+		}else if(req.req_type() == managarm::fs::CntReqType::SB_MAP_CHANGES) {
+			auto tracker = fs ? fs->changeTracker() : nullptr;
+
+			managarm::fs::SvrResponse resp;
+			if(!tracker) {
+				resp.set_error(managarm::fs::Errors::ILLEGAL_OPERATION_TARGET);
+
+				auto ser = resp.SerializeAsString();
+				auto [send_resp] = co_await helix_ng::exchangeMsgs(
+					conversation,
+					helix_ng::sendBuffer(ser.data(), ser.size())
+				);
+				HEL_CHECK(send_resp.error());
+				continue;
+			}
+
+			resp.set_error(managarm::fs::Errors::SUCCESS);
+
+			auto ser = resp.SerializeAsString();
+			auto [send_resp, push_page] = co_await helix_ng::exchangeMsgs(
+				conversation,
+				helix_ng::sendBuffer(ser.data(), ser.size()),
+				helix_ng::pushDescriptor(tracker->getMemory())
+			);
+			HEL_CHECK(send_resp.error());
+			HEL_CHECK(push_page.error());
+		}else if(preamble.id() == managarm::fs::WatchChangesRequest::message_id) {
+			auto req = bragi::parse_head_only<managarm::fs::WatchChangesRequest>(recv_head);
+			recv_head.reset();
+
+			if (!req) {
+				std::cout << "libblockfs: Rejecting request due to decoding failure" << std::endl;
+				break;
+			}
+
+			auto tracker = fs ? fs->changeTracker() : nullptr;
+			if(!tracker) {
+				managarm::fs::WatchChangesResponse resp;
+				resp.set_error(managarm::fs::Errors::ILLEGAL_OPERATION_TARGET);
+
+				auto [send_resp, send_tail] = co_await helix_ng::exchangeMsgs(
+					conversation,
+					helix_ng::sendBragiHeadTail(resp, frg::stl_allocator{})
+				);
+				HEL_CHECK(send_resp.error());
+				HEL_CHECK(send_tail.error());
+				continue;
+			}
+
+			// This only completes on the next change, hence it must not block the loop.
+			tracker->serveWatch(std::move(conversation), req->sequence());
 		}else if(req.req_type() == managarm::fs::CntReqType::DEV_OPEN) {
 			helix::UniqueLane local_lane, remote_lane;
 			std::tie(local_lane, remote_lane) = helix::createStream();
@@ -155,6 +155,11 @@ extern inline __attribute__ (( always_inline )) HelError helCreateVirtualizedSpa
 	return error;
 };
 
+extern inline __attribute__ (( always_inline )) HelError helQueryMemoryStats(HelHandle spaceHandle,
+		struct HelMemoryStats *stats) {
+	return helSyscall2(kHelCallQueryMemoryStats, (HelWord)spaceHandle, (HelWord)stats);
+};
+
 extern inline __attribute__ (( always_inline )) HelError helCreateVirtualizedCpu(HelHandle handle, HelHandle *out_handle) {
 	HelWord handle_word;
 	HelError error = helSyscall1_1(kHelCallCreateVirtualizedCpu, (HelWord)handle, &handle_word);
@@ -310,6 +315,17 @@ extern inline __attribute__ (( always_inline )) HelError helShutdownLane(HelHand
 	return helSyscall1(kHelCallShutdownLane, (HelWord)handle);
 };
 
+extern inline __attribute__ (( always_inline )) HelError helCallLane(HelHandle lane,
+		uint32_t flags, struct HelLaneMessage *message) {
+	return helSyscall3(kHelCallCallLane, (HelWord)lane, (HelWord)flags, (HelWord)message);
+};
+
+extern inline __attribute__ (( always_inline )) HelError helReplyAndWait(HelHandle conversation,
+		HelHandle listenLane, uint32_t flags, struct HelLaneMessage *message) {
+	return helSyscall4(kHelCallReplyAndWait, (HelWord)conversation, (HelWord)listenLane,
+			(HelWord)flags, (HelWord)message);
+};
+
 extern inline __attribute__ (( always_inline )) HelError helFutexWait(int *pointer,
 		int expected, int64_t deadline) {
 	return helSyscall3(kHelCallFutexWait, (HelWord)pointer, (HelWord)expected,
@@ -320,6 +336,18 @@ extern inline __attribute__ (( always_inline )) HelError helFutexWake(int *point
 	return helSyscall2(kHelCallFutexWake, (HelWord)pointer, count);
 };
 
+extern inline __attribute__ (( always_inline )) HelError helFutexRequeue(int *pointer, int *target,
+		int expected, unsigned int wakeCount, unsigned int requeueCount) {
+	return helSyscall5(kHelCallFutexRequeue, (HelWord)pointer, (HelWord)target,
+			(HelWord)expected, wakeCount, requeueCount);
+};
+
+extern inline __attribute__ (( always_inline )) HelError helFutexWakeOp(int *pointer, unsigned int count,
+		int *target, unsigned int targetCount, uint32_t op) {
+	return helSyscall5(kHelCallFutexWakeOp, (HelWord)pointer, count,
+			(HelWord)target, targetCount, op);
+};
+
 extern inline __attribute__ (( always_inline )) HelError helCreateOneshotEvent(HelHandle *handle) {
 	HelWord handle_word;
 	HelError error = helSyscall0_1(kHelCallCreateOneshotEvent, &handle_word);
@@ -338,6 +366,15 @@ extern inline __attribute__ (( always_inline )) HelError helRaiseEvent(HelHandle
 	return helSyscall1(kHelCallRaiseEvent, (HelWord)handle);
 };
 
+extern inline __attribute__ (( always_inline )) HelError helCreateMemoryPressureEvent(
+		const uint64_t *thresholds, size_t numThresholds, HelHandle *handle) {
+	HelWord handle_word;
+	HelError error = helSyscall2_1(kHelCallCreateMemoryPressureEvent,
+			(HelWord)thresholds, (HelWord)numThresholds, &handle_word);
+	*handle = (HelHandle)handle_word;
+	return error;
+};
+
 extern inline __attribute__ (( always_inline )) HelError helAccessIrq(int number, 
 		HelHandle *handle) {
 	HelWord handle_word;
@@ -18,7 +18,7 @@
 
 enum {
 	// largest system call number plus 1
-	kHelNumCalls = 107,
+	kHelNumCalls = 113,
 
 	kHelCallLog = 1,
 	kHelCallPanic = 10,
@@ -59,6 +59,7 @@ enum {
 	kHelCallSubmitLockMemoryView = 48,
 	kHelCallLoadahead = 49,
 	kHelCallCreateVirtualizedSpace = 50,
+	kHelCallQueryMemoryStats = 112,
 
 	kHelCallCreateThread = 67,
 	kHelCallQueryThreadStats = 95,
@@ -85,13 +86,18 @@ enum {
 	kHelCallCreateStream = 68,
 	kHelCallSubmitAsync = 79,
 	kHelCallShutdownLane = 91,
+	kHelCallCallLane = 109,
+	kHelCallReplyAndWait = 110,
 
 	kHelCallFutexWait = 73,
 	kHelCallFutexWake = 71,
+	kHelCallFutexRequeue = 107,
+	kHelCallFutexWakeOp = 108,
 
 	kHelCallCreateOneshotEvent = 96,
 	kHelCallCreateBitsetEvent = 97,
 	kHelCallRaiseEvent = 98,
+	kHelCallCreateMemoryPressureEvent = 111,
 	kHelCallAccessIrq = 14,
 	kHelCallAcknowledgeIrq = 81,
 	kHelCallSubmitAwaitEvent = 82,
@@ -209,7 +215,9 @@ enum {
 	kHelActionRecvInline = 7,
 	kHelActionRecvToBuffer = 3,
 	kHelActionPushDescriptor = 2,
-	kHelActionPullDescriptor = 4
+	kHelActionPullDescriptor = 4,
+	kHelActionSendFromMemory = 12,
+	kHelActionRecvToMemory = 13
 };
 
 enum {
@@ -235,6 +243,35 @@ struct HelAction {
 	void *buffer;
 	size_t length;
 	HelHandle handle;
+	// Offset into the memory object given by handle.
+	// Only used by kHelActionSendFromMemory and kHelActionRecvToMemory.
+	uintptr_t offset;
+};
+
+// Flags for helCallLane().
+enum HelCallLaneFlags {
+	// Pull a descriptor after receiving the reply.
+	kHelCallLanePullDescriptor = 1
+};
+
+// Flags for helReplyAndWait().
+enum HelReplyFlags {
+	// Push the descriptor given in HelLaneMessage::handle after sending the reply.
+	kHelReplyPushDescriptor = 1
+};
+
+// In-/output of helCallLane() and helReplyAndWait().
+struct HelLaneMessage {
+	// Inline buffer that is sent (at most one page).
+	const void *sendBuffer;
+	size_t sendLength;
+	// Inline buffer that receives the reply (or request) (at most one page).
+	void *recvBuffer;
+	size_t recvMaxLength;
+	// Set by the kernel: number of bytes that were received.
+	size_t recvLength;
+	// Descriptor that is pulled (or pushed), or the conversation handle.
+	HelHandle handle;
 };
 
 struct HelDescriptorInfo {
@@ -244,6 +281,29 @@ struct HelDescriptorInfo {
 enum HelAllocFlags {
 	kHelAllocContinuous = 4,
 	kHelAllocOnDemand = 1,
+	// Back the memory by large (e.g., 2 MiB) physical chunks if possible.
+	kHelAllocLargePages = 8,
+};
+
+// Operations for helFutexWakeOp().
+enum HelFutexOps {
+	kHelFutexOpSet = 0,
+	kHelFutexOpAdd = 1,
+	kHelFutexOpOr = 2,
+	kHelFutexOpAndn = 3,
+	kHelFutexOpXor = 4,
+	// If set, the operand is replaced by 1 << operand.
+	kHelFutexOpArgShift = 8
+};
+
+// Comparisons for helFutexWakeOp().
+enum HelFutexCmps {
+	kHelFutexCmpEq = 0,
+	kHelFutexCmpNe = 1,
+	kHelFutexCmpLt = 2,
+	kHelFutexCmpLe = 3,
+	kHelFutexCmpGt = 4,
+	kHelFutexCmpGe = 5
 };
 
 struct HelAllocRestrictions {
@@ -525,6 +585,12 @@ static const uint32_t kHelSubmitForkMemory = 13;
 static const uint32_t kHelSubmitWritebackFence = 14;
 //! SQ opcode: invalidate memory.
 static const uint32_t kHelSubmitInvalidateMemory = 15;
+//! SQ opcode: map memory.
+static const uint32_t kHelSubmitMapMemory = 16;
+//! SQ opcode: unmap memory.
+static const uint32_t kHelSubmitUnmapMemory = 17;
+//! SQ opcode: close descriptor.
+static const uint32_t kHelSubmitCloseDescriptor = 18;
 
 //! In-memory kernel/user-space queue.
 struct HelQueue {
@@ -601,6 +667,9 @@ struct HelSqAwaitClock {
 	uint64_t counter;
 	//! Tag to cancel this operation.
 	uint64_t cancellationTag;
+	//! The operation may complete up to this many nanoseconds after the deadline.
+	//! This allows the kernel to coalesce timer interrupts.
+	uint64_t slack;
 };
 
 //! SQ data for kHelSubmitAwaitEvent.
@@ -715,6 +784,41 @@ struct HelSqInvalidateMemory {
 	size_t size;
 };
 
+//! SQ data for kHelSubmitMapMemory.
+//! The arguments have the same meaning as for helMapMemory().
+struct HelSqMapMemory {
+	//! Handle to the memory object.
+	HelHandle memoryHandle;
+	//! Handle to the address space.
+	HelHandle spaceHandle;
+	//! Requested pointer of the mapping.
+	void *pointer;
+	//! Offset within the memory object.
+	uintptr_t offset;
+	//! Size of the mapping.
+	size_t size;
+	//! Mapping flags.
+	uint32_t flags;
+};
+
+//! SQ data for kHelSubmitUnmapMemory.
+struct HelSqUnmapMemory {
+	//! Handle to the address space.
+	HelHandle spaceHandle;
+	//! Pointer to the mapping.
+	void *pointer;
+	//! Size of the mapping.
+	size_t size;
+};
+
+//! SQ data for kHelSubmitCloseDescriptor.
+struct HelSqCloseDescriptor {
+	//! Handle to the universe that contains the descriptor.
+	HelHandle universeHandle;
+	//! Handle to the descriptor.
+	HelHandle handle;
+};
+
 struct HelSimpleResult {
 	HelError error;
 	int reserved;
@@ -763,6 +867,12 @@ struct HelHandleResult {
 	HelHandle handle;
 };
 
+struct HelMapResult {
+	HelError error;
+	int reserved;
+	void *pointer;
+};
+
 struct HelEventResult {
 	HelError error;
 	uint32_t bitset;
@@ -784,6 +894,21 @@ struct HelThreadStats {
 	uint64_t userTime;
 };
 
+struct HelMemoryStats {
+	//! Total amount of usable physical memory (in bytes).
+	uint64_t totalMemory;
+	//! Amount of free physical memory (in bytes).
+	uint64_t freeMemory;
+	//! Amount of memory that is used by managed memory objects, i.e., page caches (in bytes).
+	uint64_t cachedMemory;
+	//! Amount of anonymous memory that is stored in compressed form (in bytes).
+	uint64_t compressedStored;
+	//! Amount of memory that the compressed data occupies (in bytes).
+	uint64_t compressedPool;
+	//! Amount of memory that is mapped into the address space (in bytes).
+	uint64_t residentMemory;
+};
+
 enum {
   kHelVmexitHlt = 0,
   kHelVmexitTranslationFault = 1,
@@ -920,6 +1045,11 @@ HEL_C_LINKAGE HelError helAlertQueue(HelHandle queueHandle);
 //! @param[in] size
 //!    	Size of the memory object in bytes.
 //!    	Must be aligned to the system's page size.
+//!    	If ::kHelAllocLargePages is set, must be aligned to the large page size (2 MiB).
+//! @param[in] flags
+//!    	Combination of ::HelAllocFlags.
+//!    	If ::kHelAllocLargePages is set, the kernel tries to back the memory
+//!    	by large pages and to map it using large page table entries.
 //! @param[in] restrictions
 //!    	Specifies restrictions for the kernel's memory allocator.
 //!    	May be @p NULL if there are no restrictions.
@@ -1063,6 +1193,14 @@ HEL_C_LINKAGE HelError helLoadahead(HelHandle handle, uintptr_t offset, size_t l
 
 HEL_C_LINKAGE HelError helCreateVirtualizedSpace(HelHandle *handle);
 
+//! Query memory usage statistics of the system and of an address space.
+//! @param[in] spaceHandle
+//!     Handle to the address space.
+//!     If this is ::kHelNullHandle, the current thread's address space is used.
+//! @param[out] stats
+//!     Memory usage statistics.
+HEL_C_LINKAGE HelError helQueryMemoryStats(HelHandle spaceHandle, struct HelMemoryStats *stats);
+
 //! @}
 //! @name Thread Management
 //! @{
@@ -1207,6 +1345,49 @@ HEL_C_LINKAGE HelError helCreateStream(HelHandle *lane1, HelHandle *lane2, uint3
 
 HEL_C_LINKAGE HelError helShutdownLane(HelHandle handle);
 
+//! Synchronously performs a call on a lane.
+//!
+//! Offers a new lane on @p lane, sends @p message->sendBuffer over it,
+//! and blocks until a reply is received into @p message->recvBuffer.
+//! This is equivalent to submitting an offer with the ancillary actions
+//! SendFromBuffer, RecvInline (and optionally PullDescriptor) via ::helSubmitAsync
+//! and waiting for its completion. Hence, servers can handle such calls
+//! using either ::helSubmitAsync or ::helReplyAndWait.
+//! If the thread is interrupted while waiting, the call is aborted
+//! and ::kHelErrCancelled is returned.
+//! @param[in] lane
+//!     Handle to the lane.
+//! @param[in] flags
+//!     Flags from ::HelCallLaneFlags.
+//! @param[in,out] message
+//!     Describes the buffers of the call. On return, @p recvLength is set
+//!     to the length of the reply and @p handle to the pulled descriptor
+//!     (or to ::kHelNullHandle if no descriptor was requested).
+HEL_C_LINKAGE HelError helCallLane(HelHandle lane, uint32_t flags, struct HelLaneMessage *message);
+
+//! Synchronously replies to a call and waits for the next one.
+//!
+//! If @p conversation is not ::kHelNullHandle, sends @p message->sendBuffer over
+//! @p conversation (optionally followed by a descriptor) and closes the handle.
+//! Failures to deliver the reply are not reported since the caller might have
+//! gone away in the meantime.
+//! Afterwards, if @p listenLane is not ::kHelNullHandle, accepts a lane on
+//! @p listenLane and receives the request into @p message->recvBuffer.
+//! If the thread is interrupted while waiting, the pending operation is aborted
+//! and ::kHelErrCancelled is returned.
+//! @param[in] conversation
+//!     Handle to the lane that the reply is sent to.
+//! @param[in] listenLane
+//!     Handle to the lane that new calls are accepted from.
+//! @param[in] flags
+//!     Flags from ::HelReplyFlags.
+//! @param[in,out] message
+//!     Describes the buffers of the reply and the request. On return, @p recvLength
+//!     is set to the length of the request and @p handle to the accepted lane,
+//!     which is passed as @p conversation to the next call of this function.
+HEL_C_LINKAGE HelError helReplyAndWait(HelHandle conversation, HelHandle listenLane,
+		uint32_t flags, struct HelLaneMessage *message);
+
 //! Create a token object.
 //!
 //! A token object represents some unnamed credentials which can be shared.
@@ -1237,6 +1418,46 @@ HEL_C_LINKAGE HelError helFutexWait(int *pointer, int expected, int64_t deadline
 //!     Maximum number of waiters to wake.
 HEL_C_LINKAGE HelError helFutexWake(int *pointer, unsigned int count);
 
+//! Wakes up waiters of a futex and moves remaining waiters to another futex.
+//!
+//! Can be used to implement condition variable broadcasts without waking up
+//! all waiters at once.
+//! @param[in] pointer
+//!     Pointer that identifies the futex.
+//! @param[in] target
+//!     Pointer that identifies the futex that waiters are moved to.
+//! @param[in] expected
+//!     Expected value of the futex at @p pointer. If the value does not match,
+//!     this function fails with ::kHelErrFutexRace.
+//! @param[in] wakeCount
+//!     Maximum number of waiters to wake.
+//! @param[in] requeueCount
+//!     Maximum number of waiters to move to @p target.
+HEL_C_LINKAGE HelError helFutexRequeue(int *pointer, int *target, int expected,
+		unsigned int wakeCount, unsigned int requeueCount);
+
+//! Atomically modifies a futex and wakes up waiters of two futexes.
+//!
+//! Let @c v be the old value of the futex at @p target.
+//! This function atomically replaces @c v by <tt>v OP oparg</tt>,
+//! wakes up to @p count waiters of the futex at @p pointer and,
+//! if <tt>v CMP cmparg</tt> holds, up to @p targetCount waiters of the futex at @p target.
+//! @param[in] pointer
+//!     Pointer that identifies the first futex.
+//! @param[in] count
+//!     Maximum number of waiters of the first futex to wake.
+//! @param[in] target
+//!     Pointer that identifies the futex that is modified.
+//!     Must be mapped writable.
+//! @param[in] targetCount
+//!     Maximum number of waiters of the second futex to wake.
+//! @param[in] op
+//!     Encodes the operation as <tt>(OP << 28) | (CMP << 24) | (oparg << 12) | cmparg</tt>,
+//!     where @c OP is a ::HelFutexOps value, @c CMP is a ::HelFutexCmps value
+//!     and @c oparg and @c cmparg are signed 12-bit integers.
+HEL_C_LINKAGE HelError helFutexWakeOp(int *pointer, unsigned int count,
+		int *target, unsigned int targetCount, uint32_t op);
+
 //! @}
 //! @name Event Handling
 //! @{
@@ -1256,6 +1477,21 @@ HEL_C_LINKAGE HelError helCreateBitsetEvent(HelHandle *handle);
 //!     Handle to the event that will be raised.
 HEL_C_LINKAGE HelError helRaiseEvent(HelHandle handle);
 
+//! Create a bitset event that is raised on memory pressure.
+//!
+//! Bit @c i of the event is raised when the amount of free physical memory
+//! drops below @p thresholds[i]. The bit is only raised again after
+//! free memory has recovered above the threshold. Free memory is sampled
+//! periodically by the kernel; hence, events are delivered with some delay.
+//! @param[in] thresholds
+//!     Array of thresholds (in bytes).
+//! @param[in] numThresholds
+//!     Number of thresholds. Must be between 1 and 32.
+//! @param[out] handle
+//!     Handle to the new event.
+HEL_C_LINKAGE HelError helCreateMemoryPressureEvent(const uint64_t *thresholds,
+		size_t numThresholds, HelHandle *handle);
+
 HEL_C_LINKAGE HelError helAccessIrq(int number, HelHandle *handle);
 
 HEL_C_LINKAGE HelError helAcknowledgeIrq(HelHandle handle, uint32_t flags, uint64_t sequence);
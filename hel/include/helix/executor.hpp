@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include <async/execution.hpp>
+#include <helix/ipc.hpp>
+
+namespace helix {
+
+struct Executor;
+
+template<typename Receiver>
+struct ScheduleOperation final : private RemoteWork {
+	ScheduleOperation(Dispatcher *dispatcher, Receiver receiver)
+	: dispatcher_{dispatcher}, receiver_{std::move(receiver)} { }
+
+	ScheduleOperation(const ScheduleOperation &) = delete;
+
+	ScheduleOperation &operator= (const ScheduleOperation &) = delete;
+
+	void start() {
+		dispatcher_->post(this);
+	}
+
+private:
+	void run() override {
+		async::execution::set_value(receiver_);
+	}
+
+	Dispatcher *dispatcher_;
+	Receiver receiver_;
+};
+
+struct [[nodiscard]] ScheduleSender {
+	using value_type = void;
+
+	template<typename Receiver>
+	ScheduleOperation<Receiver> connect(Receiver receiver) {
+		return {dispatcher, std::move(receiver)};
+	}
+
+	Dispatcher *dispatcher;
+};
+
+inline async::sender_awaiter<ScheduleSender>
+operator co_await (ScheduleSender sender) {
+	return {std::move(sender)};
+}
+
+// Runs coroutines on a fixed set of threads ("workers"). Each worker owns a Dispatcher
+// and thus its own HelQueue. Operations complete on the worker that submitted them,
+// i.e., coroutines stay on their worker until they co_await schedule().
+//
+// Work that is not bound to a worker is posted to a shared queue. Workers pull
+// from this queue whenever they wake up, such that idle workers pick up such work.
+struct Executor {
+	// The calling thread becomes worker 0; the remaining workers are started immediately.
+	explicit Executor(unsigned int numWorkers);
+
+	Executor(const Executor &) = delete;
+
+	Executor &operator= (const Executor &) = delete;
+
+	unsigned int numWorkers() {
+		return _dispatchers.size();
+	}
+
+	// Returns the worker that the calling thread runs or -1 if it is not a worker.
+	static int currentWorker();
+
+	// Thread-safe. Runs the function on the given worker.
+	void post(unsigned int worker, std::function<void()> fn);
+
+	// Thread-safe. Runs the function on some worker.
+	void post(std::function<void()> fn);
+
+	// Thread-safe. Resumes the awaiting coroutine on the given worker.
+	ScheduleSender schedule(unsigned int worker) {
+		return {_dispatchers[worker]};
+	}
+
+	// Runs worker 0 on the calling thread. Does not return.
+	[[noreturn]] void run();
+
+private:
+	void _bindWorker(unsigned int index);
+	[[noreturn]] void _runWorker(unsigned int index);
+	void _runShared();
+
+	// Indexed by worker.
+	std::vector<Dispatcher *> _dispatchers;
+	std::atomic<unsigned int> _numBound{0};
+
+	std::mutex _mutex;
+	std::deque<std::function<void()>> _sharedQueue;
+	std::atomic<size_t> _sharedSize{0};
+	// Next worker to alert for shared work (round-robin).
+	std::atomic<unsigned int> _nextAlert{0};
+};
+
+} // namespace helix
@@ -335,6 +335,54 @@ private:
 	size_t _length;
 };
 
+struct SendFromMemoryResult {
+	SendFromMemoryResult() :_valid{false} {}
+
+	HelError error() {
+		FRG_ASSERT(_valid);
+		return _error;
+	}
+
+	void parse(void *&ptr, ElementHandle) {
+		auto result = reinterpret_cast<HelSimpleResult *>(ptr);
+		_error = result->error;
+		ptr = (char *)ptr + sizeof(HelSimpleResult);
+		_valid = true;
+	}
+
+private:
+	bool _valid;
+	HelError _error;
+};
+
+struct RecvToMemoryResult {
+	RecvToMemoryResult() :_valid{false} {}
+
+	HelError error() {
+		FRG_ASSERT(_valid);
+		return _error;
+	}
+
+	size_t actualLength() {
+		FRG_ASSERT(_valid);
+		HEL_CHECK(error());
+		return _length;
+	}
+
+	void parse(void *&ptr, ElementHandle) {
+		auto result = reinterpret_cast<HelLengthResult *>(ptr);
+		_error = result->error;
+		_length = result->length;
+		ptr = (char *)ptr + sizeof(HelLengthResult);
+		_valid = true;
+	}
+
+private:
+	bool _valid;
+	HelError _error;
+	size_t _length;
+};
+
 struct RecvInlineResult {
 	RecvInlineResult() :_valid{false} {}
 
@@ -477,6 +525,18 @@ struct RecvBuffer {
 	size_t size;
 };
 
+struct SendFromMemory {
+	HelHandle handle;
+	uintptr_t offset;
+	size_t size;
+};
+
+struct RecvToMemory {
+	HelHandle handle;
+	uintptr_t offset;
+	size_t size;
+};
+
 struct RecvInline { };
 
 struct PushDescriptor {
@@ -568,6 +628,14 @@ inline auto recvBuffer(void *data, size_t length) {
 	return RecvBuffer{data, length};
 }
 
+inline auto sendFromMemory(BorrowedDescriptor memory, uintptr_t offset, size_t length) {
+	return SendFromMemory{memory.getHandle(), offset, length};
+}
+
+inline auto recvToMemory(BorrowedDescriptor memory, uintptr_t offset, size_t length) {
+	return RecvToMemory{memory.getHandle(), offset, length};
+}
+
 inline auto recvInline() {
 	return RecvInline{};
 }
@@ -707,6 +775,28 @@ inline auto createActionsArrayFor(bool chain, const RecvBuffer &item) {
 	return frg::array<HelAction, 1>{action};
 }
 
+inline auto createActionsArrayFor(bool chain, const SendFromMemory &item) {
+	HelAction action{};
+	action.type = kHelActionSendFromMemory;
+	action.flags = chain ? kHelItemChain : 0;
+	action.handle = item.handle;
+	action.offset = item.offset;
+	action.length = item.size;
+
+	return frg::array<HelAction, 1>{action};
+}
+
+inline auto createActionsArrayFor(bool chain, const RecvToMemory &item) {
+	HelAction action{};
+	action.type = kHelActionRecvToMemory;
+	action.flags = chain ? kHelItemChain : 0;
+	action.handle = item.handle;
+	action.offset = item.offset;
+	action.length = item.size;
+
+	return frg::array<HelAction, 1>{action};
+}
+
 inline auto createActionsArrayFor(bool chain, const RecvInline &) {
 	HelAction action{};
 	action.type = kHelActionRecvInline;
@@ -802,6 +892,14 @@ inline auto resultTypeTuple(const RecvBuffer &) {
 	return frg::tuple<RecvBufferResult>{};
 }
 
+inline auto resultTypeTuple(const SendFromMemory &) {
+	return frg::tuple<SendFromMemoryResult>{};
+}
+
+inline auto resultTypeTuple(const RecvToMemory &) {
+	return frg::tuple<RecvToMemoryResult>{};
+}
+
 inline auto resultTypeTuple(const RecvInline &) {
 	return frg::tuple<RecvInlineResult>{};
 }
@@ -1,12 +1,14 @@
 #pragma once
 
 #include <assert.h>
+#include <atomic>
 #include <tuple>
 #include <array>
 #include <vector>
 #include <span>
 
 #include <async/oneshot-event.hpp>
+#include <frg/std_compat.hpp>
 
 // This is here since ipc-structs.hpp needs ElementHandle
 namespace helix {
@@ -142,6 +144,20 @@ struct CurrentDispatcherToken {
 	void wait();
 };
 
+// Work that other threads hand to a Dispatcher (see Dispatcher::post()).
+struct RemoteWork {
+	friend struct Dispatcher;
+
+protected:
+	~RemoteWork() = default;
+
+private:
+	// Runs on the thread that owns the Dispatcher.
+	virtual void run() = 0;
+
+	RemoteWork *_next = nullptr;
+};
+
 inline constexpr CurrentDispatcherToken currentDispatcher;
 
 struct Dispatcher {
@@ -234,10 +250,34 @@ public:
 		return _nextAsyncId++;
 	}
 
+	// Thread-safe. Runs the work on the thread that owns this dispatcher
+	// (i.e., the thread that acquired it), the next time that thread calls wait().
+	// The owner must have acquired the dispatcher already.
+	void post(RemoteWork *work) {
+		auto head = _remoteHead.load(std::memory_order_relaxed);
+		do {
+			work->_next = head;
+		} while(!_remoteHead.compare_exchange_weak(head, work,
+				std::memory_order_release, std::memory_order_relaxed));
+
+		// If the list was not empty, the owner has not drained it yet and is already alerted.
+		if(!head)
+			alert();
+	}
+
+	// Thread-safe. Makes the owner return from wait().
+	void alert() {
+		HEL_CHECK(helAlertQueue(__atomic_load_n(&_handle, __ATOMIC_ACQUIRE)));
+	}
+
+	// Waits until an element is completed or until the dispatcher is alerted.
 	void wait() {
 		while(true) {
 			bool done;
-			_waitProgressFutex(&done);
+			if(_waitProgressFutex(&done)) {
+				_processRemote();
+				return;
+			}
 			if(done) {
 				auto cn = _retrieveChunk;
 				auto next = __atomic_load_n(&_chunks[cn]->next, __ATOMIC_ACQUIRE);
@@ -254,7 +294,7 @@ public:
 			_lastProgress += sizeof(HelElement) + element->length;
 
 			auto context = reinterpret_cast<Context *>(element->context);
-			_refCounts[_retrieveChunk]++;
+			_refCounts[_retrieveChunk].fetch_add(1, std::memory_order_relaxed);
 			context->complete(ElementHandle{this, _retrieveChunk,
 					ptr + sizeof(HelElement)});
 			return;
@@ -263,20 +303,55 @@ public:
 
 private:
 	void _surrender(int cn) {
-		assert(_refCounts[cn] > 0);
-		if(_refCounts[cn]-- > 1)
+		auto count = _refCounts[cn].fetch_sub(1, std::memory_order_acq_rel);
+		assert(count > 0);
+		if(count > 1)
+			return;
+
+		// Elements can be released on other threads if coroutines move between threads.
+		// Only the owner may touch the CQ, hence it resupplies such chunks.
+		if(this != &global()) {
+			_surrenderedChunks.fetch_or(uint32_t{1} << cn, std::memory_order_release);
+			alert();
 			return;
+		}
 		_resetChunk(cn);
 		_supplyChunk(cn);
 	}
 
+	void _processRemote() {
+		auto chunks = _surrenderedChunks.exchange(0, std::memory_order_acquire);
+		for(int cn = 0; chunks; cn++, chunks >>= 1) {
+			if(!(chunks & 1))
+				continue;
+			_resetChunk(cn);
+			_supplyChunk(cn);
+		}
+
+		// The list is in LIFO order; reverse it such that work runs in the order it was posted.
+		RemoteWork *work = nullptr;
+		auto list = _remoteHead.exchange(nullptr, std::memory_order_acquire);
+		while(list) {
+			auto next = list->_next;
+			list->_next = work;
+			work = list;
+			list = next;
+		}
+		while(work) {
+			// run() may destroy the work item.
+			auto next = work->_next;
+			work->run();
+			work = next;
+		}
+	}
+
 	void _resetChunk(int cn) {
 		// Reset the chunk's state.
 		_chunks[cn]->next = 0;
 		_chunks[cn]->progressFutex = 0;
 
 		// Internal bookkeeping.
-		_refCounts[cn] = 1;
+		_refCounts[cn].store(1, std::memory_order_relaxed);
 	}
 
 	void _supplyChunk(int cn) {
@@ -286,13 +361,15 @@ private:
 	}
 
 	void _reference(int cn) {
-		_refCounts[cn]++;
+		_refCounts[cn].fetch_add(1, std::memory_order_relaxed);
 	}
 
 public:
 	// Push an element to the SQ using a gather list.
+	// Only the owner may push to the SQ; other threads need to post() to the owner.
 	void pushSq(uint32_t opcode, uintptr_t context,
 			std::span<const std::span<const std::byte>> segments) {
+		assert(this == &global());
 		acquire();
 
 		size_t dataLength = 0;
@@ -350,7 +427,27 @@ public:
 		__atomic_fetch_or(&_queue->kernelNotify, kHelKernelNotifySqProgress, __ATOMIC_RELEASE);
 	}
 
+	// Thread-safe. Cancellation is routed to the owner of the dispatcher that the
+	// operation was submitted to.
 	inline void cancel(uint64_t cancellationTag) {
+		if(this != &global()) {
+			struct CancelWork final : RemoteWork {
+				CancelWork(Dispatcher *dispatcher, uint64_t cancellationTag)
+				: dispatcher{dispatcher}, cancellationTag{cancellationTag} { }
+
+				void run() override {
+					dispatcher->cancel(cancellationTag);
+					delete this;
+				}
+
+				Dispatcher *dispatcher;
+				uint64_t cancellationTag;
+			};
+
+			post(new CancelWork{this, cancellationTag});
+			return;
+		}
+
 		HelSqCancel sqData{};
 		sqData.cancellationTag = cancellationTag;
 		std::array segments{std::as_bytes(std::span{&sqData, 1})};
@@ -364,7 +461,8 @@ private:
 			HEL_CHECK(helDriveQueue(_handle, 0, 0));
 	}
 
-	void _waitProgressFutex(bool *done) {
+	// Returns true if the dispatcher was alerted.
+	bool _waitProgressFutex(bool *done) {
 		// userNotify bits checked by this function (these MUST be checked in the loop below!).
 		const auto relevantNotify = kHelUserNotifyCqProgress;
 		// userNotify bits ignored by this function.
@@ -378,6 +476,14 @@ private:
 			// Note: notify is reloaded at the end of each iteration below.
 			_pendingNotify |= notify;
 
+			if (_pendingNotify & kHelUserNotifyAlert) {
+				// Clear the bit before the caller drains posted work. Work that is posted
+				// afterwards raises a new alert.
+				_pendingNotify &= ~kHelUserNotifyAlert;
+				__atomic_fetch_and(&_queue->userNotify, ~kHelUserNotifyAlert, __ATOMIC_ACQUIRE);
+				return true;
+			}
+
 			if (_pendingNotify & kHelUserNotifyCqProgress) {
 				auto progress = __atomic_load_n(&_chunks[_retrieveChunk]->progressFutex, __ATOMIC_ACQUIRE);
 				assert(!(progress & ~(kHelProgressMask | kHelProgressFull | kHelProgressDone)));
@@ -385,11 +491,11 @@ private:
 					assert(_retrieveChunk != _tailChunk);
 				if(_lastProgress != (progress & kHelProgressMask)) {
 					*done = false;
-					return;
+					return false;
 				}else if(progress & kHelProgressDone) {
 					assert(progress & kHelProgressFull);
 					*done = true;
-					return;
+					return false;
 				}
 			}
 
@@ -436,8 +542,13 @@ private:
 	int _tailChunk;
 	// Progress into the current CQ chunk.
 	int _lastProgress;
-	// Per-chunk reference counts.
-	int _refCounts[16];
+	// Per-chunk reference counts. Elements can be released on any thread.
+	std::atomic<int> _refCounts[16];
+	// Chunks whose last element was released on another thread (bit i = chunk i).
+	std::atomic<uint32_t> _surrenderedChunks{0};
+
+	// Work posted by other threads, most recent first.
+	std::atomic<RemoteWork *> _remoteHead{nullptr};
 
 	// SQ state.
 	// Chunk that we are currently writing to.
@@ -560,13 +671,14 @@ private:
 
 struct Submission : private Context {
 	Submission(AwaitClock *operation,
-			uint64_t counter, Dispatcher &dispatcher)
+			uint64_t counter, uint64_t slack, Dispatcher &dispatcher)
 	: _result(operation) {
 		auto asyncId = dispatcher.makeAsyncId();
 
 		HelSqAwaitClock sqData;
 		sqData.counter = counter;
 		sqData.cancellationTag = asyncId;
+		sqData.slack = slack;
 		std::array segments{std::as_bytes(std::span{&sqData, 1})};
 		dispatcher.pushSq(kHelSubmitAwaitClock,
 				reinterpret_cast<uintptr_t>(context()), segments);
@@ -661,7 +773,13 @@ private:
 
 inline Submission submitAwaitClock(AwaitClock *operation, uint64_t counter,
 		Dispatcher &dispatcher) {
-	return {operation, counter, dispatcher};
+	return {operation, counter, 0, dispatcher};
+}
+
+// The kernel may complete the operation up to slack nanoseconds after counter.
+inline Submission submitAwaitClock(AwaitClock *operation, uint64_t counter,
+		uint64_t slack, Dispatcher &dispatcher) {
+	return {operation, counter, slack, dispatcher};
 }
 
 inline Submission submitProtectMemory(BorrowedDescriptor memory, ProtectMemory *operation,
@@ -767,6 +885,81 @@ auto exchangeMsgs(BorrowedDescriptor descriptor, Args &&...args) {
 	};
 }
 
+// --------------------------------------------------------------------
+// Synchronous calls.
+// --------------------------------------------------------------------
+
+struct CallLaneResult {
+	CallLaneResult() = default;
+
+	CallLaneResult(HelError error, std::vector<uint8_t> buffer, UniqueDescriptor descriptor)
+	: _error{error}, _buffer{std::move(buffer)}, _descriptor{std::move(descriptor)} { }
+
+	HelError error() const {
+		return _error;
+	}
+
+	const void *data() const {
+		HEL_CHECK(error());
+		return _buffer.data();
+	}
+
+	size_t length() const {
+		HEL_CHECK(error());
+		return _buffer.size();
+	}
+
+	size_t size() const {
+		return length();
+	}
+
+	UniqueDescriptor descriptor() {
+		HEL_CHECK(error());
+		return std::move(_descriptor);
+	}
+
+private:
+	HelError _error = kHelErrNone;
+	std::vector<uint8_t> _buffer;
+	UniqueDescriptor _descriptor;
+};
+
+// Offers a lane, sends the request over it and blocks the calling thread until the reply
+// arrives (see helCallLane()). On the wire, this is identical to
+//     offer(sendBuffer(request, length), recvInline() [, pullDescriptor()]),
+// hence clients can switch individual request types to callLane() without
+// changing the server. Since the thread does not drive its dispatcher while it is blocked,
+// this should only be used for requests that the server answers promptly.
+inline CallLaneResult callLane(BorrowedDescriptor lane, const void *request, size_t length,
+		size_t maxReplyLength, bool pullDescriptor = false) {
+	std::vector<uint8_t> buffer(maxReplyLength);
+	HelLaneMessage msg{
+		.sendBuffer = request,
+		.sendLength = length,
+		.recvBuffer = buffer.data(),
+		.recvMaxLength = buffer.size(),
+		.recvLength = 0,
+		.handle = kHelNullHandle
+	};
+	auto error = helCallLane(lane.getHandle(),
+			pullDescriptor ? kHelCallLanePullDescriptor : 0, &msg);
+	if(error != kHelErrNone)
+		return {error, {}, {}};
+
+	buffer.resize(msg.recvLength);
+	return {kHelErrNone, std::move(buffer), UniqueDescriptor{msg.handle}};
+}
+
+// Same as callLane() but sends a bragi message that consists of a head only.
+// The result can be passed to bragi::parse_head_only().
+template <typename Message>
+inline CallLaneResult callLaneBragi(BorrowedDescriptor lane, Message &msg,
+		size_t maxReplyLength = 128, bool pullDescriptor = false) {
+	auto item = sendBragiHeadOnly(msg, frg::stl_allocator{});
+	return callLane(std::move(lane), item.head.data(), item.head.size(),
+			maxReplyLength, pullDescriptor);
+}
+
 // --------------------------------------------------------------------
 // Operations other than exchangeMsgs().
 // --------------------------------------------------------------------
@@ -1057,7 +1250,8 @@ struct AwaitEventOperation : private Context {
 	: event_{std::move(event)}, sequence_{sequence}, ct_{ct}, receiver_{std::move(receiver)} { }
 
 	void start() {
-		asyncId_ = Dispatcher::global().makeAsyncId();
+		dispatcher_ = &Dispatcher::global();
+		asyncId_ = dispatcher_->makeAsyncId();
 
 		HelSqAwaitEvent header;
 		header.handle = event_.getHandle();
@@ -1069,7 +1263,7 @@ struct AwaitEventOperation : private Context {
 		};
 
 		auto context = static_cast<Context *>(this);
-		Dispatcher::global().pushSq(kHelSubmitAwaitEvent,
+		dispatcher_->pushSq(kHelSubmitAwaitEvent,
 				reinterpret_cast<uintptr_t>(context), segments);
 
 		cb_.emplace(ct_, this);
@@ -1088,13 +1282,15 @@ private:
 	}
 
 	void cancel() {
-		Dispatcher::global().cancel(asyncId_);
+		// The cancellation token may be triggered on another thread.
+		dispatcher_->cancel(asyncId_);
 	}
 
 	BorrowedDescriptor event_;
 	uint64_t sequence_;
 	async::cancellation_token ct_;
 	std::optional<async::cancellation_callback<frg::bound_mem_fn<&AwaitEventOperation::cancel>>> cb_ = std::nullopt;
+	Dispatcher *dispatcher_;
 	uint64_t asyncId_;
 	Receiver receiver_;
 };
@@ -1469,4 +1665,243 @@ inline auto invalidateMemory(BorrowedDescriptor memory, uintptr_t offset, size_t
 	return InvalidateMemorySender{std::move(memory), offset, size};
 }
 
+// --------------------------------------------------------------------
+// MapMemory
+// --------------------------------------------------------------------
+
+struct MapMemoryResult {
+	HelError error() {
+		assert(valid_);
+		return error_;
+	}
+
+	void *pointer() {
+		assert(valid_);
+		return pointer_;
+	}
+
+	void parse(void *&ptr, const ElementHandle &) {
+		auto result = reinterpret_cast<HelMapResult *>(ptr);
+		error_ = result->error;
+		pointer_ = result->pointer;
+		ptr = (char *)ptr + sizeof(HelMapResult);
+		valid_ = true;
+	}
+
+private:
+	bool valid_ = false;
+	HelError error_;
+	void *pointer_;
+};
+
+template <typename Receiver>
+struct MapMemoryOperation : private Context {
+	MapMemoryOperation(BorrowedDescriptor memory, BorrowedDescriptor space,
+			void *pointer, uintptr_t offset, size_t size, uint32_t flags, Receiver r)
+	: memory_{std::move(memory)}, space_{std::move(space)}, pointer_{pointer},
+		offset_{offset}, size_{size}, flags_{flags}, r_{std::move(r)} {}
+
+	void start() {
+		HelSqMapMemory header;
+		header.memoryHandle = memory_.getHandle();
+		header.spaceHandle = space_.getHandle();
+		header.pointer = pointer_;
+		header.offset = offset_;
+		header.size = size_;
+		header.flags = flags_;
+
+		std::array segments{
+			std::as_bytes(std::span{&header, 1})
+		};
+
+		auto context = static_cast<Context *>(this);
+		Dispatcher::global().pushSq(kHelSubmitMapMemory,
+				reinterpret_cast<uintptr_t>(context), segments);
+	}
+
+	MapMemoryOperation(const MapMemoryOperation &) = delete;
+	MapMemoryOperation &operator= (const MapMemoryOperation &) = delete;
+
+private:
+	void complete(ElementHandle element) override {
+		MapMemoryResult result;
+		void *ptr = element.data();
+		result.parse(ptr, element);
+		async::execution::set_value(r_, std::move(result));
+	}
+
+	BorrowedDescriptor memory_;
+	BorrowedDescriptor space_;
+	void *pointer_;
+	uintptr_t offset_;
+	size_t size_;
+	uint32_t flags_;
+	Receiver r_;
+};
+
+struct [[nodiscard]] MapMemorySender {
+	using value_type = MapMemoryResult;
+
+	MapMemorySender(BorrowedDescriptor memory, BorrowedDescriptor space,
+			void *pointer, uintptr_t offset, size_t size, uint32_t flags)
+	: memory_{std::move(memory)}, space_{std::move(space)}, pointer_{pointer},
+		offset_{offset}, size_{size}, flags_{flags} { }
+
+	template<typename Receiver>
+	MapMemoryOperation<Receiver> connect(Receiver receiver) {
+		return {std::move(memory_), std::move(space_), pointer_, offset_, size_, flags_,
+				std::move(receiver)};
+	}
+
+private:
+	BorrowedDescriptor memory_;
+	BorrowedDescriptor space_;
+	void *pointer_;
+	uintptr_t offset_;
+	size_t size_;
+	uint32_t flags_;
+};
+
+inline async::sender_awaiter<MapMemorySender, MapMemoryResult>
+operator co_await (MapMemorySender sender) {
+	return {std::move(sender)};
+}
+
+inline auto mapMemory(BorrowedDescriptor memory, BorrowedDescriptor space,
+		void *pointer, uintptr_t offset, size_t size, uint32_t flags) {
+	return MapMemorySender{std::move(memory), std::move(space), pointer, offset, size, flags};
+}
+
+// --------------------------------------------------------------------
+// UnmapMemory
+// --------------------------------------------------------------------
+
+template <typename Receiver>
+struct UnmapMemoryOperation : private Context {
+	UnmapMemoryOperation(BorrowedDescriptor space, void *pointer, size_t size, Receiver r)
+	: space_{std::move(space)}, pointer_{pointer}, size_{size}, r_{std::move(r)} {}
+
+	void start() {
+		HelSqUnmapMemory header;
+		header.spaceHandle = space_.getHandle();
+		header.pointer = pointer_;
+		header.size = size_;
+
+		std::array segments{
+			std::as_bytes(std::span{&header, 1})
+		};
+
+		auto context = static_cast<Context *>(this);
+		Dispatcher::global().pushSq(kHelSubmitUnmapMemory,
+				reinterpret_cast<uintptr_t>(context), segments);
+	}
+
+	UnmapMemoryOperation(const UnmapMemoryOperation &) = delete;
+	UnmapMemoryOperation &operator= (const UnmapMemoryOperation &) = delete;
+
+private:
+	void complete(ElementHandle element) override {
+		SynchronizeSpaceResult result;
+		void *ptr = element.data();
+		result.parse(ptr, element);
+		async::execution::set_value(r_, std::move(result));
+	}
+
+	BorrowedDescriptor space_;
+	void *pointer_;
+	size_t size_;
+	Receiver r_;
+};
+
+struct [[nodiscard]] UnmapMemorySender {
+	using value_type = SynchronizeSpaceResult;
+
+	UnmapMemorySender(BorrowedDescriptor space, void *pointer, size_t size)
+	: space_{std::move(space)}, pointer_{pointer}, size_{size} { }
+
+	template<typename Receiver>
+	UnmapMemoryOperation<Receiver> connect(Receiver receiver) {
+		return {std::move(space_), pointer_, size_, std::move(receiver)};
+	}
+
+private:
+	BorrowedDescriptor space_;
+	void *pointer_;
+	size_t size_;
+};
+
+inline async::sender_awaiter<UnmapMemorySender, SynchronizeSpaceResult>
+operator co_await (UnmapMemorySender sender) {
+	return {std::move(sender)};
+}
+
+inline auto unmapMemory(BorrowedDescriptor space, void *pointer, size_t size) {
+	return UnmapMemorySender{std::move(space), pointer, size};
+}
+
+// --------------------------------------------------------------------
+// CloseDescriptor
+// --------------------------------------------------------------------
+
+template <typename Receiver>
+struct CloseDescriptorOperation : private Context {
+	CloseDescriptorOperation(HelHandle universe, HelHandle handle, Receiver r)
+	: universe_{universe}, handle_{handle}, r_{std::move(r)} {}
+
+	void start() {
+		HelSqCloseDescriptor header;
+		header.universeHandle = universe_;
+		header.handle = handle_;
+
+		std::array segments{
+			std::as_bytes(std::span{&header, 1})
+		};
+
+		auto context = static_cast<Context *>(this);
+		Dispatcher::global().pushSq(kHelSubmitCloseDescriptor,
+				reinterpret_cast<uintptr_t>(context), segments);
+	}
+
+	CloseDescriptorOperation(const CloseDescriptorOperation &) = delete;
+	CloseDescriptorOperation &operator= (const CloseDescriptorOperation &) = delete;
+
+private:
+	void complete(ElementHandle element) override {
+		SynchronizeSpaceResult result;
+		void *ptr = element.data();
+		result.parse(ptr, element);
+		async::execution::set_value(r_, std::move(result));
+	}
+
+	HelHandle universe_;
+	HelHandle handle_;
+	Receiver r_;
+};
+
+struct [[nodiscard]] CloseDescriptorSender {
+	using value_type = SynchronizeSpaceResult;
+
+	CloseDescriptorSender(HelHandle universe, HelHandle handle)
+	: universe_{universe}, handle_{handle} { }
+
+	template<typename Receiver>
+	CloseDescriptorOperation<Receiver> connect(Receiver receiver) {
+		return {universe_, handle_, std::move(receiver)};
+	}
+
+private:
+	HelHandle universe_;
+	HelHandle handle_;
+};
+
+inline async::sender_awaiter<CloseDescriptorSender, SynchronizeSpaceResult>
+operator co_await (CloseDescriptorSender sender) {
+	return {std::move(sender)};
+}
+
+// Asynchronous counterpart of helCloseDescriptor().
+inline auto closeDescriptor(HelHandle universe, HelHandle handle) {
+	return CloseDescriptorSender{universe, handle};
+}
+
 } // namespace helix_ng
@@ -30,14 +30,14 @@ private:
 		uint64_t tick;
 		HEL_CHECK(helGetClock(&tick));
 
+		auto &dispatcher = helix::Dispatcher::global();
 		helix::AwaitClock await;
-		auto &&submit = helix::submitAwaitClock(&await, tick + duration,
-				helix::Dispatcher::global());
+		auto &&submit = helix::submitAwaitClock(&await, tick + duration, dispatcher);
 		auto async_id = await.asyncId();
 
 		{
 			async::cancellation_callback cb{_cancelTimer, [&] {
-				helix::Dispatcher::global().cancel(async_id);
+				dispatcher.cancel(async_id);
 			}};
 			co_await submit.async_wait();
 		}
@@ -76,18 +76,21 @@ private:
 	TimeoutCallback<Functor> _tb;
 };
 
-inline async::result<bool> sleepFor(uint64_t duration, async::cancellation_token cancel = {}) {
+// If slack is non-zero, the sleep may take up to slack nanoseconds longer;
+// this allows the kernel to coalesce timer interrupts.
+inline async::result<bool> sleepFor(uint64_t duration, async::cancellation_token cancel = {},
+		uint64_t slack = 0) {
 	uint64_t tick;
 	HEL_CHECK(helGetClock(&tick));
 
+	auto &dispatcher = helix::Dispatcher::global();
 	helix::AwaitClock await;
-	auto &&submit = helix::submitAwaitClock(&await, tick + duration,
-			helix::Dispatcher::global());
+	auto &&submit = helix::submitAwaitClock(&await, tick + duration, slack, dispatcher);
 	auto async_id = await.asyncId();
 
 	{
 		async::cancellation_callback cb{cancel, [&] {
-			helix::Dispatcher::global().cancel(async_id);
+			dispatcher.cancel(async_id);
 		}};
 		co_await submit.async_wait();
 	}
@@ -98,14 +101,15 @@ inline async::result<bool> sleepFor(uint64_t duration, async::cancellation_token
 	co_return true;
 }
 
-inline async::result<bool> sleepUntil(uint64_t tick, async::cancellation_token cancelToken) {
+inline async::result<bool> sleepUntil(uint64_t tick, async::cancellation_token cancelToken,
+		uint64_t slack = 0) {
+	auto &dispatcher = helix::Dispatcher::global();
 	helix::AwaitClock await;
-	auto &&submit = helix::submitAwaitClock(&await, tick,
-			helix::Dispatcher::global());
+	auto &&submit = helix::submitAwaitClock(&await, tick, slack, dispatcher);
 	auto asyncId = await.asyncId();
 	{
 		async::cancellation_callback cb{cancelToken, [&] {
-			helix::Dispatcher::global().cancel(asyncId);
+			dispatcher.cancel(asyncId);
 		}};
 		co_await submit.async_wait();
 	}
@@ -0,0 +1,107 @@
+#include <thread>
+
+#include <helix/executor.hpp>
+
+namespace helix {
+
+namespace {
+
+thread_local int currentWorkerIndex = -1;
+
+} // anonymous namespace
+
+Executor::Executor(unsigned int numWorkers) {
+	assert(numWorkers >= 1);
+	_dispatchers.resize(numWorkers);
+
+	_bindWorker(0);
+
+	// Workers run forever, just like worker 0.
+	for(unsigned int i = 1; i < numWorkers; i++) {
+		std::thread{[this, i] {
+			_bindWorker(i);
+			_runWorker(i);
+		}}.detach();
+	}
+
+	// post() requires that the queues exist, hence wait until all workers acquired them.
+	while(true) {
+		auto n = _numBound.load(std::memory_order_acquire);
+		if(n == numWorkers)
+			break;
+		_numBound.wait(n, std::memory_order_acquire);
+	}
+}
+
+int Executor::currentWorker() {
+	return currentWorkerIndex;
+}
+
+void Executor::post(unsigned int worker, std::function<void()> fn) {
+	struct FunctionWork final : RemoteWork {
+		FunctionWork(std::function<void()> fn)
+		: fn{std::move(fn)} { }
+
+		void run() override {
+			fn();
+			delete this;
+		}
+
+		std::function<void()> fn;
+	};
+
+	_dispatchers[worker]->post(new FunctionWork{std::move(fn)});
+}
+
+void Executor::post(std::function<void()> fn) {
+	{
+		std::lock_guard lock{_mutex};
+		_sharedQueue.push_back(std::move(fn));
+		_sharedSize.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	auto worker = _nextAlert.fetch_add(1, std::memory_order_relaxed) % _dispatchers.size();
+	_dispatchers[worker]->alert();
+}
+
+void Executor::run() {
+	assert(currentWorkerIndex == 0);
+	_runWorker(0);
+}
+
+void Executor::_bindWorker(unsigned int index) {
+	auto &dispatcher = Dispatcher::global();
+	dispatcher.acquire();
+	_dispatchers[index] = &dispatcher;
+	currentWorkerIndex = index;
+
+	_numBound.fetch_add(1, std::memory_order_release);
+	_numBound.notify_all();
+}
+
+void Executor::_runWorker(unsigned int index) {
+	auto &dispatcher = *_dispatchers[index];
+	while(true) {
+		_runShared();
+		dispatcher.wait();
+	}
+}
+
+void Executor::_runShared() {
+	// Avoid taking the lock after each completion. Shared work that we miss here
+	// comes with an alert, i.e., we will check again after the next wait().
+	while(_sharedSize.load(std::memory_order_relaxed)) {
+		std::function<void()> fn;
+		{
+			std::lock_guard lock{_mutex};
+			if(_sharedQueue.empty())
+				return;
+			fn = std::move(_sharedQueue.front());
+			_sharedQueue.pop_front();
+			_sharedSize.fetch_sub(1, std::memory_order_relaxed);
+		}
+		fn();
+	}
+}
+
+} // namespace helix
@@ -0,0 +1,174 @@
+#include <assert.h>
+#include <string.h>
+
+#include <lz-compress.hpp>
+
+namespace common {
+
+namespace {
+
+// Matches shorter than this are not worth encoding.
+constexpr size_t minMatch = 4;
+
+uint32_t read32(const uint8_t *p) {
+	uint32_t v;
+	memcpy(&v, p, sizeof(uint32_t));
+	return v;
+}
+
+uint32_t hashSequence(uint32_t v) {
+	return (v * UINT32_C(2654435761)) >> (32 - lzHashBits);
+}
+
+// Lengths that do not fit into a nibble of the token are continued by a run of bytes;
+// all bytes except for the last one are 255.
+bool writeExtraLength(uint8_t *dst, size_t &dp, size_t capacity, size_t length) {
+	while(length >= 255) {
+		if(dp == capacity)
+			return false;
+		dst[dp++] = 255;
+		length -= 255;
+	}
+	if(dp == capacity)
+		return false;
+	dst[dp++] = length;
+	return true;
+}
+
+// Each sequence consists of a token, literals and (except for the last sequence) a match.
+// The token stores the number of literals in its high nibble and the match length
+// (minus minMatch) in its low nibble.
+bool writeSequence(const uint8_t *literals, size_t numLiterals,
+		size_t offset, size_t matchLength,
+		uint8_t *dst, size_t &dp, size_t capacity) {
+	if(dp == capacity)
+		return false;
+	auto tokenPos = dp++;
+
+	uint8_t token = (numLiterals < 15 ? numLiterals : 15) << 4;
+	if(numLiterals >= 15 && !writeExtraLength(dst, dp, capacity, numLiterals - 15))
+		return false;
+	if(capacity - dp < numLiterals)
+		return false;
+	memcpy(dst + dp, literals, numLiterals);
+	dp += numLiterals;
+
+	if(matchLength) {
+		assert(matchLength >= minMatch);
+		assert(offset && offset <= 0xFFFF);
+		auto code = matchLength - minMatch;
+		token |= code < 15 ? code : 15;
+
+		if(capacity - dp < 2)
+			return false;
+		dst[dp++] = offset & 0xFF;
+		dst[dp++] = offset >> 8;
+		if(code >= 15 && !writeExtraLength(dst, dp, capacity, code - 15))
+			return false;
+	}
+
+	dst[tokenPos] = token;
+	return true;
+}
+
+} // anonymous namespace
+
+size_t lzCompress(const void *srcPtr, size_t size, void *dstPtr, size_t capacity,
+		LzWorkspace *workspace) {
+	assert(size <= 0x10000);
+	auto src = static_cast<const uint8_t *>(srcPtr);
+	auto dst = static_cast<uint8_t *>(dstPtr);
+
+	// Stale entries are harmless since candidates are verified below.
+	for(auto &entry : workspace->table)
+		entry = 0;
+
+	size_t dp = 0;
+	size_t anchor = 0;
+	size_t ip = 0;
+	while(ip + minMatch <= size) {
+		auto sequence = read32(src + ip);
+		auto &entry = workspace->table[hashSequence(sequence)];
+		size_t ref = entry;
+		entry = ip;
+
+		if(ref >= ip || read32(src + ref) != sequence) {
+			ip++;
+			continue;
+		}
+
+		// Matches may overlap the current position; this encodes runs efficiently.
+		size_t length = minMatch;
+		while(ip + length < size && src[ref + length] == src[ip + length])
+			length++;
+
+		if(!writeSequence(src + anchor, ip - anchor, ip - ref, length, dst, dp, capacity))
+			return 0;
+		ip += length;
+		anchor = ip;
+	}
+
+	if(!writeSequence(src + anchor, size - anchor, 0, 0, dst, dp, capacity))
+		return 0;
+	return dp;
+}
+
+bool lzDecompress(const void *srcPtr, size_t compressedSize, void *dstPtr, size_t size) {
+	auto src = static_cast<const uint8_t *>(srcPtr);
+	auto dst = static_cast<uint8_t *>(dstPtr);
+
+	size_t sp = 0;
+	size_t dp = 0;
+
+	auto readExtraLength = [&] (size_t &length) -> bool {
+		while(true) {
+			if(sp == compressedSize)
+				return false;
+			auto b = src[sp++];
+			length += b;
+			if(b != 255)
+				return true;
+		}
+	};
+
+	while(sp < compressedSize) {
+		auto token = src[sp++];
+
+		size_t numLiterals = token >> 4;
+		if(numLiterals == 15 && !readExtraLength(numLiterals))
+			return false;
+		if(compressedSize - sp < numLiterals || size - dp < numLiterals)
+			return false;
+		memcpy(dst + dp, src + sp, numLiterals);
+		sp += numLiterals;
+		dp += numLiterals;
+
+		// The last sequence has no match.
+		if(sp == compressedSize)
+			break;
+
+		if(compressedSize - sp < 2)
+			return false;
+		size_t offset = src[sp] | (size_t{src[sp + 1]} << 8);
+		sp += 2;
+
+		size_t length = token & 15;
+		if(length == 15 && !readExtraLength(length))
+			return false;
+		length += minMatch;
+
+		if(!offset || offset > dp || size - dp < length)
+			return false;
+		if(offset >= length) {
+			memcpy(dst + dp, dst + dp - offset, length);
+		}else{
+			for(size_t i = 0; i < length; i++)
+				dst[dp + i] = dst[dp - offset + i];
+		}
+		dp += length;
+	}
+
+	return dp == size;
+}
+
+} // namespace common
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace common {
+
+// Simple LZ77-style block compressor (the format resembles LZ4 blocks).
+// Thor uses this for its compressed swap; the code is shared such that it can be tested in userspace.
+// Offsets are limited to 16 bits, hence inputs must not exceed 64 KiB.
+
+inline constexpr size_t lzHashBits = 12;
+
+// Scratch space for lzCompress(). Kept outside of the function to avoid large stack frames.
+struct LzWorkspace {
+	uint16_t table[size_t{1} << lzHashBits];
+};
+
+// Returns the compressed size or zero if the output does not fit into capacity bytes.
+size_t lzCompress(const void *src, size_t size, void *dst, size_t capacity,
+		LzWorkspace *workspace);
+
+// Returns false if the compressed data is malformed or does not expand to exactly size bytes.
+bool lzDecompress(const void *src, size_t compressedSize, void *dst, size_t size);
+
+} // namespace common
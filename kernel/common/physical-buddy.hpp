@@ -56,6 +56,42 @@ private:
 		return base + index;
 	}
 
+	// Finds a free chunk of the target order below slice[index] that lies entirely
+	// within [lowerLimit, upperLimit). Returns its index in the target order's slice.
+	AddressType findChunkInRange(
+	    int8_t *slice,
+	    AddressType index,
+	    int current,
+	    int target,
+	    AddressType lowerLimit,
+	    AddressType upperLimit
+	) {
+		if (slice[index] < target)
+			return illegalAddress;
+
+		auto chunkSize = AddressType(1) << (current + _sizeShift);
+		auto address = _baseAddress + index * chunkSize;
+		if (address >= upperLimit || address + chunkSize <= lowerLimit)
+			return illegalAddress;
+
+		if (current == target) {
+			if (address < lowerLimit || address + chunkSize > upperLimit)
+				return illegalAddress;
+			return index;
+		}
+
+		// Only chunks that straddle one of the limits are partially visited,
+		// hence this visits at most two paths per order.
+		auto nextSlice = slice + (size_t(numRoots_) << (tableOrder_ - current));
+		for (AddressType i = 0; i < 2; i++) {
+			auto found =
+			    findChunkInRange(nextSlice, 2 * index + i, current - 1, target, lowerLimit, upperLimit);
+			if (found != illegalAddress)
+				return found;
+		}
+		return illegalAddress;
+	}
+
 	// Determines the largest free chunk in the given range.
 	static int scanFreeChunks(int8_t *slice, AddressType base, AddressType limit, int order) {
 		int freeOrder = -1;
@@ -225,6 +261,47 @@ public:
 		return physical;
 	}
 
+	// Like allocate() but the returned chunk lies entirely within [lowerLimit, upperLimit).
+	AddressType allocateInRange(int order, AddressType lowerLimit, AddressType upperLimit) {
+		assert(order >= 0);
+		if (order > tableOrder_)
+			return illegalAddress;
+
+		if constexpr (enableBuddySanityChecking)
+			sanityCheck();
+
+		AddressType allocIndex = illegalAddress;
+		for (AddressType root = 0; root < numRoots_ && allocIndex == illegalAddress; root++)
+			allocIndex = findChunkInRange(buddyPointer_, root, tableOrder_, order, lowerLimit, upperLimit);
+		if (allocIndex == illegalAddress)
+			return illegalAddress;
+
+		int currentOrder = tableOrder_;
+		int8_t *slice = buddyPointer_;
+		while (currentOrder > order) {
+			slice += size_t(numRoots_) << (tableOrder_ - currentOrder);
+			currentOrder--;
+		}
+
+		assert(slice[allocIndex] == order);
+		slice[allocIndex] = -1;
+
+		// Same as in allocate(): fix all superior elements.
+		AddressType updateIndex = allocIndex;
+		while (currentOrder < tableOrder_) {
+			updateIndex /= 2;
+			auto freeOrder = scanFreeChunks(slice, 2 * updateIndex, 2, currentOrder);
+			currentOrder++;
+			slice -= size_t(numRoots_) << (tableOrder_ - currentOrder);
+			slice[updateIndex] = freeOrder;
+		}
+
+		if constexpr (enableBuddySanityChecking)
+			sanityCheck();
+
+		return _baseAddress + (allocIndex << (order + _sizeShift));
+	}
+
 	void free(AddressType address, int order) {
 		assert(address >= _baseAddress);
 		assert(order >= 0 && order <= tableOrder_);
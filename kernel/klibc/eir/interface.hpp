@@ -72,6 +72,7 @@ enum class RiscvExtension {
 	sstc,
 	// Z extensions.
 	za64rs,
+	zawrs,
 	zic64b,
 	zicbom,
 	zicbop,
@@ -106,6 +107,7 @@ constexpr const char *stringifyRiscvExtension(RiscvExtension ext) {
 		EIR_STRINGIFY_RISCV_EXTENSION_CASE(m)
 		EIR_STRINGIFY_RISCV_EXTENSION_CASE(sstc)
 		EIR_STRINGIFY_RISCV_EXTENSION_CASE(za64rs)
+		EIR_STRINGIFY_RISCV_EXTENSION_CASE(zawrs)
 		EIR_STRINGIFY_RISCV_EXTENSION_CASE(zic64b)
 		EIR_STRINGIFY_RISCV_EXTENSION_CASE(zicbom)
 		EIR_STRINGIFY_RISCV_EXTENSION_CASE(zicbop)
@@ -13,6 +13,28 @@ void suspendSelf() {
 	enableIntsAndHaltForever();
 }
 
+bool haveWaitOnAddress() {
+	return true;
+}
+
+void waitOnAddress(std::atomic<unsigned int> *word, unsigned int value) {
+	assert(!intsAreEnabled());
+	// Masked interrupts do not wake up WFE, hence we enable them first.
+	// Interrupts that are taken before WFE set the event register on exception return,
+	// such that WFE does not block in this case.
+	enableInts();
+
+	// LDAXR arms the exclusive monitor. Stores to *word by other CPUs clear it,
+	// which generates a wake-up event for WFE.
+	unsigned int current;
+	asm volatile ("ldaxr %w0, [%1]" : "=r"(current) : "r"(word) : "memory");
+	if(current != value) {
+		asm volatile ("clrex" : : : "memory");
+		return;
+	}
+	asm volatile ("wfe" : : : "memory");
+}
+
 void sendPingIpi(CpuData *dstData) {
 	std::visit(
 	    frg::overloaded{
@@ -41,6 +63,20 @@ void sendShootdownIpi() {
 	);
 }
 
+void sendShootdownIpi(CpuData *dstData) {
+	std::visit(
+	    frg::overloaded{
+	        [](std::monostate) {
+		        panicLogger() << "thor: Cannot send IPIs without an IRQ controller" << frg::endlog;
+		        __builtin_unreachable();
+	        },
+	        [&](GicV2 *gic) { gic->sendIpi(dstData->cpuIndex, 1); },
+	        [&](GicV3 *gic) { gic->sendIpi(dstData->cpuIndex, 1); },
+	    },
+	    externalIrq
+	);
+}
+
 void sendSelfCallIpi() {
 	auto *dstData = getCpuData();
 	std::visit(
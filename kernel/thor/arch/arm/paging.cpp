@@ -146,7 +146,8 @@ ClientPageSpace::~ClientPageSpace() {
 		PageAccessor accessor{ps};
 		auto tbl = reinterpret_cast<uint64_t *>(accessor.get());
 		for(int i = 0; i < 512; i++) {
-			if(tbl[i] & kPageValid)
+			// Block descriptors are not owned by the page space.
+			if((tbl[i] & kPageValid) && (tbl[i] & kPageTable))
 				physicalAllocator->free(tbl[i] & kPageAddress, kPageSize);
 		}
 	};
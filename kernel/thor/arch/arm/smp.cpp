@@ -10,6 +10,7 @@
 #include <thor-internal/arch-generic/paging.hpp>
 #include <thor-internal/fiber.hpp>
 #include <thor-internal/load-balancing.hpp>
+#include <thor-internal/numa.hpp>
 #include <thor-internal/ring-buffer.hpp>
 #include <thor-internal/rcu.hpp>
 
@@ -138,6 +139,7 @@ bool bootSecondary(DeviceTreeNode *node, size_t cpuIndex) {
 	void *stackPtr = kernelAlloc->allocate(stackSize);
 
 	auto *context = getCpuData(cpuIndex);
+	context->numaNode = numaNodeOfCpuHardwareId(id);
 	context->localLogRing = frg::construct<ReentrantRecordRing>(*kernelAlloc);
 
 	// Participate in global TLB invalidation *before* paging is used by the target CPU.
@@ -17,6 +17,8 @@ inline void disableInts() { asm volatile("msr daifset, #15"); }
 
 inline void halt() { asm volatile("wfi"); }
 
+inline void pause() { asm volatile("yield"); }
+
 void suspendSelf();
 
 } // namespace thor
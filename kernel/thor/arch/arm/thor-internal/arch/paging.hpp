@@ -215,6 +215,24 @@ struct ARMCursorPolicy {
 
 		return newPtAddr | kPageValid | kPageTable;
 	}
+
+	static constexpr bool pteIsLargePage(uint64_t pte) {
+		// Block descriptors have the table bit cleared.
+		return (pte & kPageValid) && !(pte & kPageTable);
+	}
+
+	static constexpr uint64_t pteBuildLarge(PhysicalAddr physical, PageFlags flags, CachingMode cachingMode) {
+		auto pte = pteBuild(physical, flags, cachingMode) & ~kPageL3Page;
+		// We do not emulate dirty bits for blocks: writable blocks start out dirty.
+		if(pte & kPageShouldBeWritable)
+			pte &= ~kPageRO;
+		return pte;
+	}
+
+	static constexpr uint64_t pteSplitLarge(uint64_t pte, size_t index) {
+		auto physical = (pte & kPageAddress) + (index << kPageShift);
+		return physical | (pte & ~kPageAddress) | kPageL3Page;
+	}
 };
 
 using KernelCursorPolicy = ARMCursorPolicy<true>;
@@ -222,6 +240,7 @@ static_assert(CursorPolicy<KernelCursorPolicy>);
 
 using ClientCursorPolicy = ARMCursorPolicy<false>;
 static_assert(CursorPolicy<ClientCursorPolicy>);
+static_assert(LargePageCursorPolicy<ClientCursorPolicy>);
 
 
 struct KernelPageSpace : PageSpace {
@@ -1,5 +1,6 @@
 #include <riscv/sbi.hpp>
 #include <thor-internal/arch-generic/ints.hpp>
+#include <thor-internal/arch/system.hpp>
 #include <thor-internal/cpu-data.hpp>
 #include <thor-internal/debug.hpp>
 
@@ -38,12 +39,35 @@ void sendShootdownIpi() {
 	}
 }
 
+void sendShootdownIpi(CpuData *dstData) {
+	if (raiseIpiBit(dstData, PlatformCpuData::ipiShootdown))
+		doSendIpi(dstData);
+}
+
 void sendSelfCallIpi() {
 	auto *selfData = getCpuData();
 	if (raiseIpiBit(selfData, PlatformCpuData::ipiSelfCall))
 		doSendIpi(selfData);
 }
 
+bool haveWaitOnAddress() {
+	return riscvHartCapsNote->hasExtension(RiscvExtension::zawrs);
+}
+
+void waitOnAddress(std::atomic<unsigned int> *word, unsigned int value) {
+	assert(!intsAreEnabled());
+	// LR.W registers a reservation set on *word. WRS.NTO stalls until the reservation
+	// is invalidated by a store from another hart or until an interrupt becomes
+	// pending (even if interrupts are disabled).
+	unsigned int current;
+	asm volatile ("lr.w %0, (%1)" : "=r"(current) : "r"(word) : "memory");
+	if(current == value) {
+		// Encoding of WRS.NTO (Zawrs).
+		asm volatile (".4byte 0x00d00073" : : : "memory");
+	}
+	enableInts();
+}
+
 void suspendSelf() {
 	enableInts();
 	while (true)
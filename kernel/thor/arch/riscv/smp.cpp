@@ -8,6 +8,7 @@
 #include <thor-internal/fiber.hpp>
 #include <thor-internal/load-balancing.hpp>
 #include <thor-internal/main.hpp>
+#include <thor-internal/numa.hpp>
 #include <thor-internal/physical.hpp>
 #include <thor-internal/rcu.hpp>
 #include <thor-internal/ring-buffer.hpp>
@@ -104,6 +105,7 @@ void bootAp(uint64_t hartId, size_t cpuIndex) {
 	// Setup the CpuData.
 	auto *smpCpu = getCpuData(cpuIndex);
 	smpCpu->hartId = hartId;
+	smpCpu->numaNode = numaNodeOfCpuHardwareId(hartId);
 	// Ensure that the CPU data is visible to the HART.
 	__atomic_thread_fence(__ATOMIC_SEQ_CST);
 
@@ -18,6 +18,9 @@ inline void disableInts() {
 
 inline void halt() { asm volatile("wfi"); }
 
+// Encoding of the Zihintpause PAUSE instruction (a no-op on harts that do not support it).
+inline void pause() { asm volatile(".4byte 0x0100000f"); }
+
 void suspendSelf();
 
 } // namespace thor
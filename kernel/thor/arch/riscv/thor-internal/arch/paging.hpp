@@ -139,6 +139,25 @@ struct RiscvCursorPolicy {
 
 		return (newPtAddr >> 2) | pteValid;
 	}
+
+	static constexpr bool pteIsLargePage(uint64_t pte) {
+		// Non-leaf PTEs have R = W = X = 0.
+		return (pte & pteValid) && (pte & (pteRead | pteWrite | pteExecute));
+	}
+
+	static constexpr uint64_t
+	pteBuildLarge(PhysicalAddr physical, PageFlags flags, CachingMode cachingMode) {
+		auto pte = pteBuild(physical, flags, cachingMode);
+		// We do not emulate dirty bits for megapages: writable megapages start out dirty.
+		if (pte & pteWrite)
+			pte |= pteDirty;
+		return pte;
+	}
+
+	static constexpr uint64_t pteSplitLarge(uint64_t pte, size_t index) {
+		auto physical = ptePageAddress(pte) + (index << kPageShift);
+		return ((physical >> 2) & ptePpnMask) | (pte & ~ptePpnMask);
+	}
 };
 
 using KernelCursorPolicy = RiscvCursorPolicy<true>;
@@ -146,6 +165,7 @@ static_assert(CursorPolicy<KernelCursorPolicy>);
 
 using ClientCursorPolicy = RiscvCursorPolicy<false>;
 static_assert(CursorPolicy<ClientCursorPolicy>);
+static_assert(LargePageCursorPolicy<ClientCursorPolicy>);
 
 struct KernelPageSpace : PageSpace {
 public:
@@ -6,6 +6,7 @@
 #include <thor-internal/kasan.hpp>
 #include <thor-internal/load-balancing.hpp>
 #include <thor-internal/main.hpp>
+#include <thor-internal/numa.hpp>
 #include <thor-internal/physical.hpp>
 #include <thor-internal/rcu.hpp>
 #include <thor-internal/ring-buffer.hpp>
@@ -68,6 +69,42 @@ size_t Executor::determineSize() {
 	return sizeof(General) + 0x10 + determineSimdSize();
 }
 
+void Executor::exportSimdState(void *buffer) {
+	auto bytes = static_cast<uint8_t *>(buffer);
+	memcpy(bytes, _fxState(), determineSimdSize());
+	if(!getGlobalCpuFeatures()->haveXsave)
+		return;
+
+	// XSTATE_BV follows the legacy region.
+	uint64_t xstateBv;
+	memcpy(&xstateBv, bytes + sizeof(FxState), sizeof(uint64_t));
+
+	auto fxState = reinterpret_cast<FxState *>(bytes);
+	if(!(xstateBv & 1)) {
+		// Architectural initial values, as loaded by XRSTOR.
+		fxState->fcw = 0x037F;
+		fxState->fsw = 0;
+		fxState->ftw = 0;
+		fxState->fop = 0;
+		fxState->fpuIp = 0;
+		fxState->fpuDp = 0;
+		memset(bytes + offsetof(FxState, st0), 0, offsetof(FxState, xmm0) - offsetof(FxState, st0));
+	}
+	// MXCSR is always written, even if the SSE component is in its initial configuration.
+	if(!(xstateBv & 2))
+		memset(bytes + offsetof(FxState, xmm0), 0, offsetof(FxState, reserved9) - offsetof(FxState, xmm0));
+
+	// The initial configuration of all extended components that we enable
+	// (AVX and AVX-512) is all zeros.
+	auto xcr0 = common::x86::rdxcr(0);
+	for(int i = 2; i < 64; i++) {
+		if(!(xcr0 & (uint64_t(1) << i)) || (xstateBv & (uint64_t(1) << i)))
+			continue;
+		auto componentCpuid = common::x86::cpuid(0xD, i);
+		memset(bytes + componentCpuid[1], 0, componentCpuid[0]);
+	}
+}
+
 Executor::Executor()
 : _pointer{nullptr}, _syscallStack{nullptr}, _tss{nullptr} { }
 
@@ -155,11 +192,7 @@ void saveExecutor(Executor *executor, FaultImageAccessor accessor) {
 	executor->general()->clientGs = common::x86::rdmsr(common::x86::kMsrIndexKernelGsBase);
 	executor->general()->iplState = accessor._frame()->iplState;
 
-	if(getGlobalCpuFeatures()->haveXsave){
-		common::x86::xsave((uint8_t*)executor->_fxState(), ~0);
-	} else {
-		asm volatile ("fxsaveq %0" : : "m" (*executor->_fxState()));
-	}
+	saveCurrentSimdState(executor);
 }
 
 void saveExecutor(Executor *executor, IrqImageAccessor accessor) {
@@ -189,11 +222,7 @@ void saveExecutor(Executor *executor, IrqImageAccessor accessor) {
 	executor->general()->clientGs = common::x86::rdmsr(common::x86::kMsrIndexKernelGsBase);
 	executor->general()->iplState = accessor._frame()->iplState;
 
-	if(getGlobalCpuFeatures()->haveXsave){
-		common::x86::xsave((uint8_t*)executor->_fxState(), ~0);
-	}else{
-		asm volatile ("fxsaveq %0" : : "m" (*executor->_fxState()));
-	}
+	saveCurrentSimdState(executor);
 }
 
 void saveExecutor(Executor *executor, SyscallImageAccessor accessor) {
@@ -223,11 +252,7 @@ void saveExecutor(Executor *executor, SyscallImageAccessor accessor) {
 	executor->general()->clientGs = common::x86::rdmsr(common::x86::kMsrIndexKernelGsBase);
 	executor->general()->iplState = accessor._frame()->iplState;
 
-	if(getGlobalCpuFeatures()->haveXsave){
-		common::x86::xsave((uint8_t*)executor->_fxState(), ~0);
-	}else{
-		asm volatile ("fxsaveq %0" : : "m" (*executor->_fxState()));
-	}
+	saveCurrentSimdState(executor);
 }
 
 extern "C" void forkExecutorRegisters(Executor *executor, void (*functor)(void *), void *context);
@@ -406,6 +431,11 @@ static initgraph::Task enumerateCpuFeaturesTask{&globalInitEngine, "x86.enumerat
 
 			auto xsaveCpuid = common::x86::cpuid(0xD);
 			globalCpuFeatures.xsaveRegionSize = xsaveCpuid[2];
+
+			if(common::x86::cpuid(0xD, 1)[0] & 1) {
+				debugLogger() << "thor: CPUs support XSAVEOPT" << frg::endlog;
+				globalCpuFeatures.haveXsaveopt = true;
+			}
 		}else{
 			debugLogger() << "thor: CPUs do not support XSAVE!" << frg::endlog;
 		}
@@ -828,6 +858,7 @@ void bootSecondary(unsigned int apic_id, size_t cpuIndex) {
 
 	auto *context = getCpuData(cpuIndex);
 	context->localApicId = apic_id;
+	context->numaNode = numaNodeOfCpuHardwareId(apic_id);
 	context->localLogRing = frg::construct<ReentrantRecordRing>(*kernelAlloc);
 
 	// Participate in global TLB invalidation *before* paging is used by the target CPU.
@@ -133,6 +133,12 @@ frg::expected<Error, PagesAffected> EptOperations::mapPresentPages(VirtualAddr v
 			va, view, offset, size, flags, mode);
 }
 
+frg::expected<Error, PagesAffected> EptOperations::mapAbsentPages(VirtualAddr va, MemoryView *view,
+		uintptr_t offset, size_t size, PageFlags flags, CachingMode mode) {
+	return mapAbsentPagesByCursor<EptCursor>(pageSpace_,
+			va, view, offset, size, flags, mode);
+}
+
 frg::expected<Error, PagesAffected> EptOperations::restrictPages(VirtualAddr va,
 		size_t size, PageFlags flags, CachingMode mode) {
 	return restrictPagesByCursor<EptCursor>(pageSpace_, va, size, flags, mode);
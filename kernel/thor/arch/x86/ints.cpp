@@ -699,5 +699,21 @@ void suspendSelf() {
 	enableIntsAndHaltForever();
 }
 
+bool haveWaitOnAddress() {
+	return common::x86::cpuid(0x01)[2] & (uint32_t(1) << 3);
+}
+
+void waitOnAddress(std::atomic<unsigned int> *word, unsigned int value) {
+	assert(!intsAreEnabled());
+	asm volatile ("monitor" : : "a"(word), "c"(0), "d"(0) : "memory");
+	if(word->load(std::memory_order_relaxed) != value) {
+		enableInts();
+		return;
+	}
+	// MWAIT is in the interrupt shadow of STI. Hence, interrupts that arrive
+	// after STI still terminate MWAIT and are taken afterwards.
+	asm volatile ("sti\n\tmwait" : : "a"(0), "c"(0) : "memory");
+}
+
 } // namespace thor
 
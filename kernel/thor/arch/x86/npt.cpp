@@ -121,6 +121,12 @@ frg::expected<Error, PagesAffected> NptOperations::mapPresentPages(VirtualAddr v
 			va, view, offset, size, flags, mode);
 }
 
+frg::expected<Error, PagesAffected> NptOperations::mapAbsentPages(VirtualAddr va, MemoryView *view,
+		uintptr_t offset, size_t size, PageFlags flags, CachingMode mode) {
+	return mapAbsentPagesByCursor<NptCursor>(pageSpace_,
+			va, view, offset, size, flags, mode);
+}
+
 frg::expected<Error, PagesAffected> NptOperations::restrictPages(VirtualAddr va,
 		size_t size, PageFlags flags, CachingMode mode) {
 	return restrictPagesByCursor<NptCursor>(pageSpace_, va, size, flags, mode);
@@ -166,7 +166,8 @@ ClientPageSpace::~ClientPageSpace() {
 		PageAccessor accessor{ps};
 		auto tbl = reinterpret_cast<uint64_t *>(accessor.get());
 		for(int i = 0; i < 512; i++) {
-			if(tbl[i] & ptePresent)
+			// Large page leaves are not owned by the page space.
+			if((tbl[i] & ptePresent) && !(tbl[i] & ptePageSize))
 				physicalAllocator->free(tbl[i] & pteAddress, kPageSize);
 		}
 	};
@@ -391,6 +391,21 @@ void sendShootdownIpi() {
 	}
 }
 
+void sendShootdownIpi(CpuData *dstData) {
+	auto apic = dstData->localApicId;
+	if(picBase.isUsingX2apic()) {
+		picBase.store(lX2ApicIcr, x2apicIcrLowVector(0xF0) | x2apicIcrLowDelivMode(0)
+				| x2apicIcrLowLevel(true) | x2apicIcrLowShorthand(0) | x2apicIcrHighDestField(apic));
+	} else {
+		picBase.store(lApicIcrHigh, apicIcrHighDestField(apic));
+		picBase.store(lApicIcrLow, apicIcrLowVector(0xF0) | apicIcrLowDelivMode(0)
+				| apicIcrLowLevel(true) | apicIcrLowShorthand(0));
+		while(picBase.load(lApicIcrLow) & apicIcrLowDelivStatus) {
+			// Wait for IPI delivery.
+		}
+	}
+}
+
 void sendPingIpi(CpuData *dstData) {
 	auto apic = dstData->localApicId;
 //	infoLogger() << "thor [CPU" << getLocalApicId() << "]: Sending ping" << frg::endlog;
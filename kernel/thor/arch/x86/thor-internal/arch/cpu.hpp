@@ -501,6 +501,11 @@ public:
 		return reinterpret_cast<FxState *>(_pointer + sizeof(General) + 0x08);
 	}
 
+	// Copies the SIMD state (determineSimdSize() bytes) into buffer.
+	// XSAVEOPT does not write components that are in their initial configuration,
+	// hence such components are replaced by their initial values in the copy.
+	void exportSimdState(void *buffer);
+
 	UserAccessRegion *currentUar() {
 		return _uar;
 	}
@@ -526,6 +531,7 @@ struct CpuFeatures {
 	static constexpr uint32_t profileAmdSupported = 2;
 
 	bool haveXsave;
+	bool haveXsaveopt;
 	bool haveAvx;
 	bool haveZmm;
 	bool haveInvariantTsc;
@@ -557,8 +563,12 @@ void initializeThisProcessor();
 void bootSecondary(unsigned int apic_id, size_t cpuIndex);
 
 // Save the current SIMD register state into the given executor.
+// Since restoreExecutor() always restores from the executor's own area,
+// XSAVEOPT only needs to write components that were modified since then.
 inline void saveCurrentSimdState(Executor *executor) {
-	if(getGlobalCpuFeatures()->haveXsave) {
+	if(getGlobalCpuFeatures()->haveXsaveopt) {
+		common::x86::xsaveopt((uint8_t*)executor->_fxState(), ~0);
+	} else if(getGlobalCpuFeatures()->haveXsave) {
 		common::x86::xsave((uint8_t*)executor->_fxState(), ~0);
 	} else {
 		asm volatile ("fxsaveq %0" : : "m" (*executor->_fxState()));
@@ -27,6 +27,10 @@ constexpr uint64_t pteGlobal = 0x100;
 constexpr uint64_t pteAgeMask = UINT64_C(3) << pteAgeShift;
 constexpr uint64_t pteXd = 0x8000000000000000;
 constexpr uint64_t pteAddress = 0x000F'FFFF'FFFF'F000;
+// Bits that only have this meaning in large page leaves.
+constexpr uint64_t ptePageSize = 0x80;
+constexpr uint64_t ptePatLarge = 0x1000;
+constexpr uint64_t pteAddressLarge = 0x000F'FFFF'FFE0'0000;
 
 inline int getLowerHalfBits() {
 	return 47;
@@ -150,6 +154,26 @@ struct X86CursorPolicy {
 
 		return newPtAddr | ptePresent | pteWrite | pteUser;
 	}
+
+	static constexpr bool pteIsLargePage(uint64_t pte) {
+		return (pte & ptePresent) && (pte & ptePageSize);
+	}
+
+	static constexpr uint64_t pteBuildLarge(PhysicalAddr physical, PageFlags flags, CachingMode cachingMode) {
+		auto pte = pteBuild(physical, flags, cachingMode);
+		// In large page leaves, the PAT bit is moved to make room for the PS bit.
+		if(pte & ptePat)
+			pte = (pte & ~ptePat) | ptePatLarge;
+		return pte | ptePageSize;
+	}
+
+	static constexpr uint64_t pteSplitLarge(uint64_t pte, size_t index) {
+		auto physical = (pte & pteAddressLarge) + (index << kPageShift);
+		auto attrs = pte & ~(pteAddress | ptePageSize);
+		if(pte & ptePatLarge)
+			attrs |= ptePat;
+		return physical | attrs;
+	}
 };
 
 using KernelCursorPolicy = X86CursorPolicy<true>;
@@ -157,6 +181,7 @@ static_assert(CursorPolicy<KernelCursorPolicy>);
 
 using ClientCursorPolicy = X86CursorPolicy<false>;
 static_assert(CursorPolicy<ClientCursorPolicy>);
+static_assert(LargePageCursorPolicy<ClientCursorPolicy>);
 
 
 struct KernelPageSpace : PageSpace {
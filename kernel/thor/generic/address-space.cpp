@@ -4,6 +4,7 @@
 #include <thor-internal/coroutine.hpp>
 #include <thor-internal/physical.hpp>
 #include <thor-internal/fiber.hpp>
+#include <thor-internal/ostrace.hpp>
 #include <thor-internal/timer.hpp>
 #include <frg/container_of.hpp>
 #include <thor-internal/types.hpp>
@@ -19,6 +20,10 @@ namespace {
 	//       to control weights or similar for working set size computation.
 	constinit std::atomic<size_t> numVirtualSpaces{0};
 
+	// On read faults in file-backed mappings, we also map neighbouring pages
+	// that are already present. This is the size of the (aligned) window that we consider.
+	constexpr size_t faultAroundSize = 16 * kPageSize;
+
 	uint32_t compilePageFlags(MappingFlags mappingFlags) {
 		uint32_t pageFlags = 0;
 		if(mappingFlags & MappingFlags::protRead)
@@ -162,7 +167,7 @@ coroutine<void> Mapping::runEvictionLoop() {
 				anyRevoked = unmapOutcome.value().anyRevoked;
 
 				if(anyRevoked)
-					co_await owner->_ops->shootdown(address + shootOffset, shootSize);
+					co_await owner->_shootdown(address + shootOffset, shootSize);
 			}
 			if(!anyRevoked)
 				co_await revokeRcu.barrier();
@@ -235,6 +240,18 @@ bool VirtualSpace::shouldContinueAging_() {
 		&& agingTurnover_.load(std::memory_order_relaxed) >= goal / 5;
 }
 
+coroutine<void> VirtualSpace::_shootdown(VirtualAddr address, size_t size) {
+	auto before = getClockNanos();
+	co_await _ops->shootdown(address, size);
+	ostrace::emit(ostEvtShootdown, ostAttrSize(size), ostAttrTime(getClockNanos() - before));
+}
+
+coroutine<void> VirtualSpace::_shootdown(ShootdownBatch &batch) {
+	if(batch.empty())
+		co_return;
+	co_await _shootdown(batch.address(), batch.size());
+}
+
 void VirtualSpace::setupInitialHole(VirtualAddr address, size_t size) {
 	auto hole = frg::construct<Hole>(*kernelAlloc, address, size);
 	_holes.insert(hole);
@@ -370,7 +387,7 @@ coroutine<void> VirtualSpace::runAgingLoop() {
 				anyRevoked = ageOutcome.value().anyRevoked;
 
 				if(anyRevoked)
-					co_await _ops->shootdown(mapping->address, mapping->length);
+					co_await _shootdown(mapping->address, mapping->length);
 			}
 			if(!anyRevoked)
 				co_await mapping->revokeRcu.barrier();
@@ -507,7 +524,7 @@ VirtualSpace::map(smarter::borrowed_ptr<MemorySlice> slice,
 				assert(mapOutcome);
 				notifyRss_(mapOutcome.value());
 				if(mapOutcome.value().anyRevoked)
-					co_await _ops->shootdown(mapping->address, mapping->length);
+					co_await _shootdown(mapping->address, mapping->length);
 			}
 		}
 	}
@@ -551,6 +568,7 @@ VirtualSpace::protect(VirtualAddr address, size_t length, uint32_t flags) {
 
 	auto [start, end] = co_await _splitMappings(address, length);
 	assert(start || (!start && !end));
+
 	for (auto it = start; it != end;) {
 		auto mapping = it->selfPtr.lock();
 		it = MappingTree::successor(it);
@@ -559,7 +577,16 @@ VirtualSpace::protect(VirtualAddr address, size_t length, uint32_t flags) {
 
 		assert(mapping->state.load(std::memory_order_relaxed) == MappingState::active);
 
-		auto actualMappingFlags = mapping->flags.load(std::memory_order_relaxed);
+		co_await mapping->exposeRcu.barrier();
+	}
+
+	// Restrict the page tables of all mappings and perform a single shootdown afterwards.
+	// The revoke guards are held until that shootdown completes.
+	frg::vector<LocalRcuEngine::Guard, KernelAlloc> revokeGuards{*kernelAlloc};
+	frg::vector<Mapping *, KernelAlloc> unrevokedMappings{*kernelAlloc};
+	ShootdownBatch batch;
+	for (auto it = start; it != end; it = MappingTree::successor(it)) {
+		auto actualMappingFlags = it->flags.load(std::memory_order_relaxed);
 		uint32_t pageFlags = 0;
 		if((actualMappingFlags & MappingFlags::permissionMask) & MappingFlags::protWrite)
 			pageFlags |= page_access::write;
@@ -569,27 +596,27 @@ VirtualSpace::protect(VirtualAddr address, size_t length, uint32_t flags) {
 			pageFlags |= page_access::read;
 
 		auto caching = CachingMode::null;
-		if(mapping->slice->getCachingFlags() == cacheWriteCombine)
+		if(it->slice->getCachingFlags() == cacheWriteCombine)
 			caching = CachingMode::writeCombine;
 
-		co_await mapping->exposeRcu.barrier();
+		revokeGuards.push_back(LocalRcuEngine::Guard{it->revokeRcu});
 
-		bool anyRevoked;
-		{
-			LocalRcuEngine::Guard revokeGuard{mapping->revokeRcu};
+		auto restrictOutcome = _ops->restrictPages(it->address,
+				it->length, pageFlags, caching);
+		assert(restrictOutcome);
 
-			auto restrictOutcome = _ops->restrictPages(mapping->address,
-					mapping->length, pageFlags, caching);
-			assert(restrictOutcome);
-			anyRevoked = restrictOutcome.value().anyRevoked;
-
-			if(anyRevoked)
-				co_await _ops->shootdown(mapping->address, mapping->length);
+		if(restrictOutcome.value().anyRevoked) {
+			batch.add(it->address, it->length);
+		}else{
+			unrevokedMappings.push_back(it);
 		}
-		if(!anyRevoked)
-			co_await mapping->revokeRcu.barrier();
 	}
 
+	co_await _shootdown(batch);
+	revokeGuards.clear();
+	for(auto mapping : unrevokedMappings)
+		co_await mapping->revokeRcu.barrier();
+
 	co_return {};
 }
 
@@ -639,7 +666,7 @@ VirtualSpace::synchronize(VirtualAddr address, size_t size) {
 			assert(cleanOutcome);
 			anyRevoked = cleanOutcome.value().anyRevoked;
 			if(anyRevoked)
-				co_await _ops->shootdown(mapping->address + mappingOffset, mappingChunk);
+				co_await _shootdown(mapping->address + mappingOffset, mappingChunk);
 		}
 
 		overallProgress += mappingChunk;
@@ -706,6 +733,29 @@ VirtualSpace::handleFault(VirtualAddr address, uint32_t faultFlags) {
 			{
 				LocalRcuEngine::Guard revokeGuard{mapping->revokeRcu};
 
+				// If the surrounding large page is backed by physically contiguous memory,
+				// map it as a whole (using a large page if possible).
+				auto largeAddress = address & ~(kLargePageSize - 1);
+				auto largeOffset = mapping->viewOffset + (largeAddress - mapping->address);
+				if(largeAddress >= mapping->address
+						&& largeAddress + kLargePageSize <= mapping->address + mapping->length
+						&& !(largeOffset & (kLargePageSize - 1))) {
+					auto largeRange = mapping->view->peekRange(largeOffset, fetchFlags);
+					if(largeRange.physical != PhysicalAddr(-1)
+							&& !(largeRange.physical & (kLargePageSize - 1))
+							&& largeRange.size >= kLargePageSize
+							&& largeRange.isMutable) {
+						auto mapOutcome = _ops->mapPresentPages(largeAddress, mapping->view.get(),
+								largeOffset, kLargePageSize, compilePageFlags(flags), caching);
+						if(mapOutcome) {
+							notifyRss_(mapOutcome.value());
+							if(mapOutcome.value().anyRevoked)
+								co_await _shootdown(largeAddress, kLargePageSize);
+							co_return {};
+						}
+					}
+				}
+
 				auto remapOutcome = _ops->faultPage(
 					address & ~(kPageSize - 1),
 					mapping->view.get(),
@@ -728,7 +778,29 @@ VirtualSpace::handleFault(VirtualAddr address, uint32_t faultFlags) {
 				} else {
 					notifyRss_(remapOutcome.value());
 					if(remapOutcome.value().anyRevoked)
-						co_await _ops->shootdown(address & ~(kPageSize - 1), kPageSize);
+						co_await _shootdown(address & ~(kPageSize - 1), kPageSize);
+
+					// Fault-around: map neighbouring pages that do not require I/O.
+					// Since this only installs PTEs that are not present, no shootdown is needed.
+					if(!(faultFlags & VirtualSpace::kFaultWrite)
+							&& mapping->view->isFileBacked()) {
+						auto aroundAddress = frg::max(address & ~(faultAroundSize - 1),
+								mapping->address);
+						auto aroundLimit = frg::min((address & ~(faultAroundSize - 1))
+								+ faultAroundSize, mapping->address + mapping->length);
+						auto viewLimit = mapping->viewOffset + (aroundLimit - mapping->address);
+						auto viewLength = mapping->view->getLength();
+						if(viewLimit > viewLength)
+							aroundLimit -= viewLimit - viewLength;
+						if(aroundLimit > aroundAddress) {
+							auto aroundOutcome = _ops->mapAbsentPages(aroundAddress,
+									mapping->view.get(),
+									mapping->viewOffset + (aroundAddress - mapping->address),
+									aroundLimit - aroundAddress, compilePageFlags(flags), caching);
+							if(aroundOutcome)
+								notifyRss_(aroundOutcome.value());
+						}
+					}
 				}
 			}
 			co_return {};
@@ -1048,32 +1120,54 @@ coroutine<frg::tuple<Mapping *, Mapping *>> VirtualSpace::_splitMappings(uintptr
 }
 
 coroutine<void> VirtualSpace::_unmapMappings(VirtualAddr address, size_t length, Mapping *start, Mapping *end) {
-	for (auto it = start; it != end;) {
-		auto mapping = it->selfPtr.lock();
-		it = MappingTree::successor(it);
+	auto inRange = [&] (Mapping *mapping) {
+		return mapping->address >= address
+				&& (mapping->address + mapping->length) <= (address + length);
+	};
 
-		if (mapping->address >= address && (mapping->address + mapping->length) <= (address + length)) {
-			assert(mapping->state.load(std::memory_order_relaxed) == MappingState::active);
-			mapping->state.store(MappingState::zombie, std::memory_order_relaxed);
+	for (auto it = start; it != end; it = MappingTree::successor(it)) {
+		if (!inRange(it))
+			continue;
 
-			co_await mapping->exposeRcu.barrier();
+		assert(it->state.load(std::memory_order_relaxed) == MappingState::active);
+		it->state.store(MappingState::zombie, std::memory_order_relaxed);
 
-			bool anyRevoked;
-			{
-				LocalRcuEngine::Guard revokeGuard{mapping->revokeRcu};
+		co_await it->exposeRcu.barrier();
+	}
 
-				// Mark pages as dirty and unmap without holding a lock.
-				auto unmapOutcome = _ops->unmapPages(mapping->address, mapping->length);
-				assert(unmapOutcome);
-				notifyRss_(unmapOutcome.value());
-				anyRevoked = unmapOutcome.value().anyRevoked;
+	// Unmap all mappings and perform a single shootdown afterwards.
+	// The revoke guards are held until that shootdown completes.
+	frg::vector<LocalRcuEngine::Guard, KernelAlloc> revokeGuards{*kernelAlloc};
+	frg::vector<Mapping *, KernelAlloc> unrevokedMappings{*kernelAlloc};
+	ShootdownBatch batch;
+	for (auto it = start; it != end; it = MappingTree::successor(it)) {
+		if (!inRange(it))
+			continue;
 
-				if(anyRevoked)
-					co_await _ops->shootdown(mapping->address, mapping->length);
-			}
-			if(!anyRevoked)
-				co_await mapping->revokeRcu.barrier();
+		revokeGuards.push_back(LocalRcuEngine::Guard{it->revokeRcu});
+
+		// Mark pages as dirty and unmap without holding a lock.
+		auto unmapOutcome = _ops->unmapPages(it->address, it->length);
+		assert(unmapOutcome);
+		notifyRss_(unmapOutcome.value());
+
+		if(unmapOutcome.value().anyRevoked) {
+			batch.add(it->address, it->length);
+		}else{
+			unrevokedMappings.push_back(it);
+		}
+	}
 
+	co_await _shootdown(batch);
+	revokeGuards.clear();
+	for(auto mapping : unrevokedMappings)
+		co_await mapping->revokeRcu.barrier();
+
+	for (auto it = start; it != end;) {
+		auto mapping = it->selfPtr.lock();
+		it = MappingTree::successor(it);
+
+		if (inRange(mapping.get())) {
 			_mappings.remove(mapping.get());
 
 			assert(mapping->state.load(std::memory_order_relaxed) == MappingState::zombie);
@@ -1228,6 +1322,45 @@ coroutine<size_t> VirtualSpace::writePartialSpace(uintptr_t address,
 	co_return progress;
 }
 
+coroutine<frg::expected<Error, PinnedPage>>
+VirtualSpace::pinPage(uintptr_t address, FetchFlags fetchFlags) {
+	assert(currentIpl() == ipl::exceptionalWork);
+
+	smarter::shared_ptr<Mapping> mapping;
+	{
+		auto irqLock = frg::guard(&irqMutex());
+		auto spaceGuard = frg::guard(&_snapshotMutex);
+
+		mapping = _findMapping(address);
+	}
+	if(!mapping)
+		co_return Error::fault;
+
+	auto mappingFlags = mapping->flags.load(std::memory_order_relaxed);
+	auto requiredProt = (fetchFlags & fetchRequireMutable)
+			? MappingFlags::protWrite : MappingFlags::protRead;
+	if(!(mappingFlags & requiredProt))
+		co_return Error::fault;
+	if(mappingFlags & MappingFlags::dontRequireBacking)
+		fetchFlags |= fetchDisallowBacking;
+
+	auto viewOffset = mapping->viewOffset + ((address - mapping->address) & ~(kPageSize - 1));
+
+	// After the lock is acquired, the page cannot be evicted once it is present.
+	MemoryViewLockHandle lock{mapping->view, viewOffset, kPageSize};
+	lock.acquire();
+	if(!lock)
+		co_return Error::fault;
+
+	while(true) {
+		auto range = mapping->view->peekRange(viewOffset, fetchFlags);
+		if(range.physical != PhysicalAddr(-1))
+			co_return PinnedPage{std::move(lock), range.physical};
+
+		FRG_CO_TRY(co_await mapping->view->touchRange(viewOffset, kPageSize, fetchFlags));
+	}
+}
+
 // --------------------------------------------------------
 // AddressSpace
 // --------------------------------------------------------
@@ -1,3 +1,4 @@
+#include <string.h>
 #include <thor-internal/arch-generic/asid.hpp>
 #include <thor-internal/arch-generic/ints.hpp>
 #include <thor-internal/arch-generic/paging-consts.hpp>
@@ -11,12 +12,14 @@ THOR_DEFINE_PERCPU(asidData);
 
 namespace {
 
+// If we're invalidating at least this many pages, just invalidate the
+// whole ASID instead.
+constexpr size_t asidFlushThreshold = 64;
+
 void invalidateNode(int asid, ShootNode *node) {
-	// If we're invalidating a lot of pages, just invalidate the
-	// whole ASID instead.
 	// invalidateAsid(globalBindingId) is not allowed, so avoid
 	// the optimization in that case.
-	if(asid != globalBindingId && (node->size >> kPageShift) >= 64) {
+	if(asid != globalBindingId && (node->size >> kPageShift) >= asidFlushThreshold) {
 		invalidateAsid(asid);
 	} else {
 		for(size_t off = 0; off < node->size; off += kPageSize)
@@ -39,23 +42,30 @@ PageBinding::doShootdown_(PageSpace *space) {
 	ShootNode *current = space->shootQueue_.back();
 	if(!current || current->sequence_ <= alreadyShotSequence_)
 		return;
+	size_t numPages = current->size >> kPageShift;
 	while(true) {
 		auto prev = current->queueNode.previous.load(std::memory_order_acquire);
 		if(!prev || prev->sequence_ <= alreadyShotSequence_)
 			break;
 		current = prev;
+		numPages += current->size >> kPageShift;
 	}
 
-	// TODO: If we see too many pages during the backwards traversal above,
-	//       we could simply invalidate the entire space and mark everything as invalidated
-	//       on the forward pass below.
+	// If we see too many pages during the backwards traversal above,
+	// invalidate the entire space once instead of invalidating each node.
+	bool flushedAsid = false;
+	if(id_ != globalBindingId && numPages >= asidFlushThreshold) {
+		invalidateAsid(id_);
+		flushedAsid = true;
+	}
 
 	while(current) {
 		auto next = current->queueNode.next.load(std::memory_order_acquire);
 		auto seq = current->sequence_;
 
 		if(current->initiatorCpu_ != getCpuData()) {
-			invalidateNode(id_, current);
+			if(!flushedAsid)
+				invalidateNode(id_, current);
 
 			if(current->bindingsToShoot_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
 				{
@@ -146,7 +156,7 @@ void PageBinding::rebind(smarter::shared_ptr<PageSpace> space) {
 		auto lock = frg::guard(&space->mutex_);
 
 		targetSeq = space->shootSequence_;
-		space->numBindings_++;
+		space->addBinding_();
 	}
 
 	boundSpace_ = space;
@@ -164,7 +174,7 @@ void PageBinding::rebind(smarter::shared_ptr<PageSpace> space) {
 		{
 			auto lock = frg::guard(&unboundSpace->mutex_);
 			upToSequence = unboundSpace->shootSequence_;
-			unboundSpace->numBindings_--;
+			unboundSpace->removeBinding_();
 			if(!unboundSpace->numBindings_ && unboundSpace->retireNode_) {
 				retireNode = unboundSpace->retireNode_;
 				unboundSpace->retireNode_ = nullptr;
@@ -190,7 +200,7 @@ void PageBinding::initialBind(smarter::shared_ptr<PageSpace> space) {
 		auto lock = frg::guard(&space->mutex_);
 
 		targetSeq = space->shootSequence_;
-		space->numBindings_++;
+		space->addBinding_();
 	}
 
 	boundSpace_ = space;
@@ -219,7 +229,7 @@ void PageBinding::unbind() {
 	{
 		auto lock = frg::guard(&boundSpace_->mutex_);
 		upToSequence = boundSpace_->shootSequence_;
-		boundSpace_->numBindings_--;
+		boundSpace_->removeBinding_();
 		if(!boundSpace_->numBindings_ && boundSpace_->retireNode_) {
 			retireNode = boundSpace_->retireNode_;
 			boundSpace_->retireNode_ = nullptr;
@@ -280,6 +290,23 @@ PageSpace::~PageSpace() {
 	assert(!numBindings_);
 }
 
+void PageSpace::addBinding_() {
+	numBindings_++;
+
+	size_t cpu = getCpuData()->cpuIndex;
+	if(cpu < maxTrackedCpus)
+		boundCpus_[cpu / 64] |= uint64_t{1} << (cpu % 64);
+}
+
+void PageSpace::removeBinding_() {
+	numBindings_--;
+
+	// Each CPU binds a space at most once, see PageSpace::activate().
+	size_t cpu = getCpuData()->cpuIndex;
+	if(cpu < maxTrackedCpus)
+		boundCpus_[cpu / 64] &= ~(uint64_t{1} << (cpu % 64));
+}
+
 
 void PageSpace::retire(RetireNode *node) {
 	bool anyBindings;
@@ -305,6 +332,7 @@ bool PageSpace::submitShootdown(ShootNode *node) {
 	assert(!(node->address & (kPageSize - 1)));
 	assert(!(node->size & (kPageSize - 1)));
 
+	uint64_t targetCpus[maxTrackedCpus / 64];
 	{
 		auto irqLock = frg::guard(&irqMutex());
 		auto lock = frg::guard(&mutex_);
@@ -336,9 +364,26 @@ bool PageSpace::submitShootdown(ShootNode *node) {
 		node->sequence_ = ++shootSequence_;
 		node->bindingsToShoot_ = unshotBindings;
 		shootQueue_.push_back(node);
+
+		// CPUs that bind the space after this point do not need to shoot down the node.
+		memcpy(targetCpus, boundCpus_, sizeof(targetCpus));
 	}
 
-	sendShootdownIpi();
+	// The kernel page space is bound on all CPUs; broadcasts are cheaper in that case.
+	if(this == &KernelPageSpace::global() || getCpuCount() > maxTrackedCpus) {
+		sendShootdownIpi();
+		return false;
+	}
+
+	// Only interrupt CPUs that have a binding to this space.
+	auto self = getCpuData();
+	for(size_t i = 0; i < getCpuCount(); i++) {
+		if(!(targetCpus[i / 64] & (uint64_t{1} << (i % 64))))
+			continue;
+		auto dstData = getCpuData(i);
+		if(dstData != self)
+			sendShootdownIpi(dstData);
+	}
 	return false;
 }
 
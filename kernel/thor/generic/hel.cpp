@@ -245,8 +245,7 @@ HelError helSubmitAsyncNop(HelHandle queueHandle, uintptr_t context) {
 
 	smarter::shared_ptr<IpcQueue> queue;
 	{
-		auto irqLock = frg::guard(&irqMutex());
-		Universe::Guard universeGuard(thisUniverse->lock);
+		Universe::ReadGuard universeGuard;
 
 		auto queueWrapper = thisUniverse->getDescriptor(universeGuard, queueHandle);
 		if(!queueWrapper)
@@ -291,8 +290,7 @@ helTransferDescriptor(HelHandle handle, HelHandle universeHandle, HelTransferDes
 	smarter::shared_ptr<Universe> dstUniverse;
 
 	{
-		auto irqLock = frg::guard(&irqMutex());
-		Universe::Guard lock(thisUniverse->lock);
+		Universe::ReadGuard lock;
 
 		smarter::shared_ptr<Universe> universe;
 		if(universeHandle == kHelThisUniverse) {
@@ -317,8 +315,7 @@ helTransferDescriptor(HelHandle handle, HelHandle universeHandle, HelTransferDes
 	}
 
 	{
-		auto irqLock = frg::guard(&irqMutex());
-		Universe::Guard lock{srcUniverse->lock};
+		Universe::ReadGuard lock;
 
 		auto descriptorIt = srcUniverse->getDescriptor(lock, handle);
 		if (!descriptorIt)
@@ -341,8 +338,7 @@ HelError helDescriptorInfo(HelHandle handle, HelDescriptorInfo *) {
 	auto this_thread = getCurrentThread();
 	auto this_universe = this_thread->getUniverse();
 
-	auto irq_lock = frg::guard(&irqMutex());
-	Universe::Guard universe_guard(this_universe->lock);
+	Universe::ReadGuard universe_guard;
 
 	auto wrapper = this_universe->getDescriptor(universe_guard, handle);
 	if(!wrapper)
@@ -362,8 +358,7 @@ HelError helGetCredentials(HelHandle handle, uint32_t flags, char *credentials)
 
 	std::array<char, 16> creds;
 	{
-		auto irqLock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(thisUniverse->lock);
+		Universe::ReadGuard universe_guard;
 
 		if(handle == kHelThisThread) {
 			creds = thisThread->credentials();
@@ -394,8 +389,7 @@ HelError helCloseDescriptor(HelHandle universeHandle, HelHandle handle) {
 	if(universeHandle == kHelThisUniverse) {
 		universe = thisUniverse.lock();
 	}else{
-		auto irqLock = frg::guard(&irqMutex());
-		Universe::Guard universeLock(thisUniverse->lock);
+		Universe::ReadGuard universeLock;
 
 		auto universeIt = thisUniverse->getDescriptor(universeLock, universeHandle);
 		if(!universeIt)
@@ -420,6 +414,25 @@ HelError helCloseDescriptor(HelHandle universeHandle, HelHandle handle) {
 	return kHelErrNone;
 }
 
+HelError doSubmitCloseDescriptor(HelHandle universeHandle, HelHandle handle,
+		smarter::shared_ptr<IpcQueue> queue, uintptr_t context) {
+	if(!queue->validSize(ipcSourceSize(sizeof(HelSimpleResult))))
+		return kHelErrQueueTooSmall;
+
+	// Closing a descriptor does not block; only the completion is asynchronous.
+	auto error = helCloseDescriptor(universeHandle, handle);
+
+	[](smarter::shared_ptr<IpcQueue> queue, HelError error, uintptr_t context,
+			enable_detached_coroutine) -> void {
+		HelSimpleResult helResult{.error = error, .reserved = {}};
+		QueueSource ipcSource{&helResult, sizeof(HelSimpleResult), nullptr};
+		co_await queue->submit(&ipcSource, context);
+	}(std::move(queue), error, context,
+		enable_detached_coroutine{getCurrentThread()->mainWorkQueue().lock()});
+
+	return kHelErrNone;
+}
+
 HelError helCreateQueue(const HelQueueParameters *paramsPtr, HelHandle *handle) {
 	auto thisThread = getCurrentThread();
 	auto thisUniverse = thisThread->getUniverse();
@@ -454,8 +467,7 @@ HelError helDriveQueue(HelHandle handle, uint32_t flags, uint32_t notifyMask) {
 
 	smarter::shared_ptr<IpcQueue> queue;
 	{
-		auto irqLock = frg::guard(&irqMutex());
-		Universe::Guard universeGuard(thisUniverse->lock);
+		Universe::ReadGuard universeGuard;
 
 		auto queueWrapper = thisUniverse->getDescriptor(universeGuard, handle);
 		if(!queueWrapper)
@@ -495,8 +507,7 @@ HelError helAlertQueue(HelHandle handle) {
 
 	smarter::shared_ptr<IpcQueue> queue;
 	{
-		auto irqLock = frg::guard(&irqMutex());
-		Universe::Guard universeGuard(thisUniverse->lock);
+		Universe::ReadGuard universeGuard;
 
 		auto queueWrapper = thisUniverse->getDescriptor(universeGuard, handle);
 		if(!queueWrapper)
@@ -532,10 +543,18 @@ HelError helAllocateMemory(size_t size, uint32_t flags,
 		if(!readUserMemory(&effective, restrictions, sizeof(HelAllocRestrictions)))
 			return kHelErrFault;
 
+	if((flags & kHelAllocLargePages) && (size & (kLargePageSize - 1)))
+		return kHelErrIllegalArgs;
+
 	smarter::shared_ptr<AllocatedMemory> memory;
 	if(flags & kHelAllocContinuous) {
 		memory = smarter::allocate_shared<AllocatedMemory>(*kernelAlloc, size, effective.addressBits,
 				size, kPageSize);
+	}else if((flags & kHelAllocLargePages)
+			|| (wantTransparentLargePages && !(flags & kHelAllocOnDemand)
+				&& !(size & (kLargePageSize - 1)))) {
+		memory = smarter::allocate_shared<AllocatedMemory>(*kernelAlloc, size, effective.addressBits,
+				kLargePageSize, kLargePageSize, true);
 	}else if(flags & kHelAllocOnDemand) {
 		memory = smarter::allocate_shared<AllocatedMemory>(*kernelAlloc, size, effective.addressBits);
 	}else{
@@ -562,8 +581,7 @@ HelError doSubmitResizeMemory(HelHandle handle, smarter::shared_ptr<IpcQueue> qu
 
 	smarter::shared_ptr<MemoryView> memory;
 	{
-		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
+		Universe::ReadGuard universe_guard;
 
 		auto wrapper = this_universe->getDescriptor(universe_guard, handle);
 		if(!wrapper)
@@ -636,8 +654,7 @@ HelError helCopyOnWrite(HelHandle memoryHandle,
 	}
 
 	{
-		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
+		Universe::ReadGuard universe_guard;
 
 		if(memoryHandle >= 0) {
 			auto wrapper = this_universe->getDescriptor(universe_guard, memoryHandle);
@@ -710,8 +727,7 @@ HelError helAlterMemoryIndirection(HelHandle indirectHandle, size_t slot,
 	smarter::shared_ptr<MemoryView> memoryView;
 	CachingFlags cacheFlags = 0;
 	{
-		auto irqLock = frg::guard(&irqMutex());
-		Universe::Guard universeLock(thisUniverse->lock);
+		Universe::ReadGuard universeLock;
 
 		auto indirectWrapper = thisUniverse->getDescriptor(universeLock, indirectHandle);
 		if(!indirectWrapper)
@@ -761,8 +777,7 @@ HelError helCreateSliceView(HelHandle memoryHandle,
 
 	smarter::shared_ptr<MemoryView> view;
 	{
-		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
+		Universe::ReadGuard universe_guard;
 
 		auto wrapper = this_universe->getDescriptor(universe_guard, memoryHandle);
 		if(!wrapper)
@@ -796,8 +811,7 @@ HelError doSubmitForkMemory(HelHandle handle, smarter::shared_ptr<IpcQueue> queu
 
 	smarter::shared_ptr<MemoryView> view;
 	{
-		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
+		Universe::ReadGuard universe_guard;
 
 		auto viewWrapper = this_universe->getDescriptor(universe_guard, handle);
 		if(!viewWrapper)
@@ -856,8 +870,7 @@ HelError doSubmitWritebackFence(HelHandle handle, smarter::shared_ptr<IpcQueue>
 
 	smarter::shared_ptr<MemoryView> memory;
 	{
-		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
+		Universe::ReadGuard universe_guard;
 
 		auto wrapper = this_universe->getDescriptor(universe_guard, handle);
 		if(!wrapper)
@@ -893,8 +906,7 @@ HelError doSubmitInvalidateMemory(HelHandle handle, smarter::shared_ptr<IpcQueue
 
 	smarter::shared_ptr<MemoryView> memory;
 	{
-		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
+		Universe::ReadGuard universe_guard;
 
 		auto wrapper = this_universe->getDescriptor(universe_guard, handle);
 		if(!wrapper)
@@ -986,8 +998,7 @@ HelError helCreateVirtualizedCpu(HelHandle handle, HelHandle *out) {
 
 	smarter::shared_ptr<VirtualizedPageSpace> vspace;
 	{
-		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
+		Universe::ReadGuard universe_guard;
 
 		auto wrapper = this_universe->getDescriptor(universe_guard, handle);
 		if(!wrapper)
@@ -1029,8 +1040,7 @@ HelError helRunVirtualizedCpu(HelHandle handle, HelVmexitReason *exitInfo) {
 
 	smarter::shared_ptr<VirtualizedCpu> vcpu;
 	{
-		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
+		Universe::ReadGuard universe_guard;
 
 		auto wrapper = this_universe->getDescriptor(universe_guard, handle);
 		if(!wrapper)
@@ -1060,116 +1070,187 @@ HelError helGetRandomBytes(void *buffer, size_t wantedSize, size_t *actualSize)
 	return kHelErrNone;
 }
 
-HelError helMapMemory(HelHandle memory_handle, HelHandle space_handle,
-		void *pointer, uintptr_t offset, size_t length, uint32_t flags, void **actualPointer) {
-	if(length == 0)
-		return kHelErrIllegalArgs;
-	if((uintptr_t)pointer % kPageSize != 0)
-		return kHelErrIllegalArgs;
-	if(offset % kPageSize != 0)
-		return kHelErrIllegalArgs;
-	if(length % kPageSize != 0)
-		return kHelErrIllegalArgs;
-
-	auto this_thread = getCurrentThread();
-	auto this_universe = this_thread->getUniverse();
+namespace {
+	// Memory and space that helMapMemory() and kHelSubmitMapMemory operate on.
+	struct MapTarget {
+		smarter::shared_ptr<MemorySlice> slice;
+		smarter::shared_ptr<AddressSpace, BindableHandle> space;
+		smarter::shared_ptr<VirtualSpace> vspace;
+		bool isVspace = false;
+	};
 
-	uint32_t map_flags = 0;
-	if(flags & kHelMapFixed) {
-		map_flags |= AddressSpace::kMapFixed;
-	}else if(flags & kHelMapFixedNoReplace) {
-		map_flags |= AddressSpace::kMapFixedNoReplace;
-	}else{
-		map_flags |= AddressSpace::kMapPreferTop;
+	HelError checkMapArgs(void *pointer, uintptr_t offset, size_t length) {
+		if(length == 0)
+			return kHelErrIllegalArgs;
+		if((uintptr_t)pointer % kPageSize != 0)
+			return kHelErrIllegalArgs;
+		if(offset % kPageSize != 0)
+			return kHelErrIllegalArgs;
+		if(length % kPageSize != 0)
+			return kHelErrIllegalArgs;
+		return kHelErrNone;
 	}
 
-	if(flags & kHelMapProtRead)
-		map_flags |= AddressSpace::kMapProtRead;
-	if(flags & kHelMapProtWrite)
-		map_flags |= AddressSpace::kMapProtWrite;
-	if(flags & kHelMapProtExecute)
-		map_flags |= AddressSpace::kMapProtExecute;
+	uint32_t translateMapFlags(uint32_t flags) {
+		uint32_t map_flags = 0;
+		if(flags & kHelMapFixed) {
+			map_flags |= AddressSpace::kMapFixed;
+		}else if(flags & kHelMapFixedNoReplace) {
+			map_flags |= AddressSpace::kMapFixedNoReplace;
+		}else{
+			map_flags |= AddressSpace::kMapPreferTop;
+		}
 
-	if(flags & kHelMapDontRequireBacking)
-		map_flags |= AddressSpace::kMapDontRequireBacking;
+		if(flags & kHelMapProtRead)
+			map_flags |= AddressSpace::kMapProtRead;
+		if(flags & kHelMapProtWrite)
+			map_flags |= AddressSpace::kMapProtWrite;
+		if(flags & kHelMapProtExecute)
+			map_flags |= AddressSpace::kMapProtExecute;
 
-	smarter::shared_ptr<MemorySlice> slice;
-	smarter::shared_ptr<AddressSpace, BindableHandle> space;
-	smarter::shared_ptr<VirtualSpace> vspace;
-	bool isVspace = false;
-	{
-		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
+		if(flags & kHelMapDontRequireBacking)
+			map_flags |= AddressSpace::kMapDontRequireBacking;
+		return map_flags;
+	}
+
+	HelError resolveMapTarget(HelHandle memory_handle, HelHandle space_handle,
+			MapTarget &target) {
+		auto this_thread = getCurrentThread();
+		auto this_universe = this_thread->getUniverse();
+
+		Universe::ReadGuard universe_guard;
 
 		auto memory_wrapper = this_universe->getDescriptor(universe_guard, memory_handle);
 		if(!memory_wrapper)
 			return kHelErrNoDescriptor;
 		if(memory_wrapper->is<MemorySliceDescriptor>()) {
-			slice = memory_wrapper->get<MemorySliceDescriptor>().slice;
+			target.slice = memory_wrapper->get<MemorySliceDescriptor>().slice;
 		}else if(memory_wrapper->is<MemoryViewDescriptor>()) {
 			auto memory = memory_wrapper->get<MemoryViewDescriptor>().memory;
 			auto sliceLength = memory->getLength();
-			slice = smarter::allocate_shared<MemorySlice>(*kernelAlloc,
+			target.slice = smarter::allocate_shared<MemorySlice>(*kernelAlloc,
 					std::move(memory), 0, sliceLength);
 		}else if(memory_wrapper->is<QueueDescriptor>()) {
 			auto memory = memory_wrapper->get<QueueDescriptor>().queue->getMemory();
 			auto sliceLength = memory->getLength();
-			slice = smarter::allocate_shared<MemorySlice>(*kernelAlloc,
+			target.slice = smarter::allocate_shared<MemorySlice>(*kernelAlloc,
 					std::move(memory), 0, sliceLength);
 		}else{
 			return kHelErrBadDescriptor;
 		}
 
 		if(space_handle == kHelNullHandle) {
-			space = this_thread->getAddressSpace().lock();
+			target.space = this_thread->getAddressSpace().lock();
 		}else{
 			auto space_wrapper = this_universe->getDescriptor(universe_guard, space_handle);
 			if(!space_wrapper)
 				return kHelErrNoDescriptor;
 			if(space_wrapper->is<AddressSpaceDescriptor>()) {
-				space = space_wrapper->get<AddressSpaceDescriptor>().space;
+				target.space = space_wrapper->get<AddressSpaceDescriptor>().space;
 			} else if(space_wrapper->is<VirtualizedSpaceDescriptor>()) {
-				isVspace = true;
-				vspace = space_wrapper->get<VirtualizedSpaceDescriptor>().space;
+				target.isVspace = true;
+				target.vspace = space_wrapper->get<VirtualizedSpaceDescriptor>().space;
 			} else {
 				return kHelErrBadDescriptor;
 			}
 		}
+
+		return kHelErrNone;
+	}
+
+	HelError translateMapError(Error error) {
+		assert(error == Error::bufferTooSmall || error == Error::alreadyExists || error == Error::noMemory);
+
+		if(error == Error::bufferTooSmall)
+			return kHelErrBufferTooSmall;
+		else if(error == Error::noMemory)
+			return kHelErrNoMemory;
+		else
+			return kHelErrAlreadyExists;
 	}
+}
+
+HelError helMapMemory(HelHandle memory_handle, HelHandle space_handle,
+		void *pointer, uintptr_t offset, size_t length, uint32_t flags, void **actualPointer) {
+	if(auto error = checkMapArgs(pointer, offset, length); error)
+		return error;
+
+	auto map_flags = translateMapFlags(flags);
+
+	MapTarget target;
+	if(auto error = resolveMapTarget(memory_handle, space_handle, target); error)
+		return error;
 
 	// TODO: check proper alignment
 
 	frg::expected<Error, VirtualAddr> mapResult;
-	if(!isVspace) {
+	if(!target.isVspace) {
 		if(map_flags & AddressSpace::kMapFixed && !pointer)
 			return kHelErrIllegalArgs; // Non-vspaces aren't allowed to map at NULL
 
 		mapResult = Thread::asyncBlockCurrent(
-			space->map(slice, (VirtualAddr)pointer, offset, length, map_flags),
+			target.space->map(target.slice, (VirtualAddr)pointer, offset, length, map_flags),
 			getCurrentThread()->pagingWorkQueue().get()
 		);
 	} else {
 		mapResult = Thread::asyncBlockCurrent(
-			vspace->map(slice, (VirtualAddr)pointer, offset, length, map_flags),
+			target.vspace->map(target.slice, (VirtualAddr)pointer, offset, length, map_flags),
 			getCurrentThread()->pagingWorkQueue().get()
 		);
 	}
 
-	if(!mapResult) {
-		assert(mapResult.error() == Error::bufferTooSmall || mapResult.error() == Error::alreadyExists || mapResult.error() == Error::noMemory);
-
-		if(mapResult.error() == Error::bufferTooSmall)
-			return kHelErrBufferTooSmall;
-		else if(mapResult.error() == Error::noMemory)
-			return kHelErrNoMemory;
-		else if(mapResult.error() == Error::alreadyExists)
-			return kHelErrAlreadyExists;
-	}
+	if(!mapResult)
+		return translateMapError(mapResult.error());
 
 	*actualPointer = (void *)mapResult.value();
 	return kHelErrNone;
 }
 
+HelError doSubmitMapMemory(HelHandle memory_handle, HelHandle space_handle,
+		smarter::shared_ptr<IpcQueue> queue, void *pointer, uintptr_t offset,
+		size_t length, uint32_t flags, uintptr_t context) {
+	if(auto error = checkMapArgs(pointer, offset, length); error)
+		return error;
+
+	auto map_flags = translateMapFlags(flags);
+
+	MapTarget target;
+	if(auto error = resolveMapTarget(memory_handle, space_handle, target); error)
+		return error;
+	if(!target.isVspace && map_flags & AddressSpace::kMapFixed && !pointer)
+		return kHelErrIllegalArgs; // Non-vspaces aren't allowed to map at NULL
+
+	if(!queue->validSize(ipcSourceSize(sizeof(HelMapResult))))
+		return kHelErrQueueTooSmall;
+
+	[](MapTarget target, smarter::shared_ptr<IpcQueue> queue,
+			VirtualAddr pointer, uintptr_t offset, size_t length,
+			uint32_t map_flags, uintptr_t context,
+			enable_detached_coroutine) -> void {
+		frg::expected<Error, VirtualAddr> mapResult;
+		if(!target.isVspace) {
+			mapResult = co_await onExceptionalWq(
+					target.space->map(target.slice, pointer, offset, length, map_flags));
+		}else{
+			mapResult = co_await onExceptionalWq(
+					target.vspace->map(target.slice, pointer, offset, length, map_flags));
+		}
+
+		HelMapResult helResult{.error = kHelErrNone, .reserved = {}, .pointer = nullptr};
+		if(mapResult) {
+			helResult.pointer = reinterpret_cast<void *>(mapResult.value());
+		}else{
+			helResult.error = translateMapError(mapResult.error());
+		}
+		QueueSource ipcSource{&helResult, sizeof(HelMapResult), nullptr};
+		co_await queue->submit(&ipcSource, context);
+	}(std::move(target), std::move(queue), reinterpret_cast<VirtualAddr>(pointer),
+			offset, length, map_flags, context,
+			enable_detached_coroutine{getCurrentThread()->mainWorkQueue().lock()});
+
+	return kHelErrNone;
+}
+
 HelError doSubmitProtectMemory(HelHandle space_handle, smarter::shared_ptr<IpcQueue> queue,
 		void *pointer, size_t length, uint32_t flags, uintptr_t context) {
 	auto this_thread = getCurrentThread();
@@ -1185,8 +1266,7 @@ HelError doSubmitProtectMemory(HelHandle space_handle, smarter::shared_ptr<IpcQu
 
 	smarter::shared_ptr<AddressSpace, BindableHandle> space;
 	{
-		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
+		Universe::ReadGuard universe_guard;
 
 		if(space_handle == kHelNullHandle) {
 			space = this_thread->getAddressSpace().lock();
@@ -1229,8 +1309,7 @@ HelError helUnmapMemory(HelHandle space_handle, void *pointer, size_t length) {
 
 	smarter::shared_ptr<AddressSpace, BindableHandle> space;
 	{
-		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
+		Universe::ReadGuard universe_guard;
 
 		if(space_handle == kHelNullHandle) {
 			space = this_thread->getAddressSpace().lock();
@@ -1256,6 +1335,50 @@ HelError helUnmapMemory(HelHandle space_handle, void *pointer, size_t length) {
 	return kHelErrNone;
 }
 
+HelError doSubmitUnmapMemory(HelHandle space_handle, smarter::shared_ptr<IpcQueue> queue,
+		void *pointer, size_t length, uintptr_t context) {
+	auto this_thread = getCurrentThread();
+	auto this_universe = this_thread->getUniverse();
+
+	smarter::shared_ptr<AddressSpace, BindableHandle> space;
+	{
+		Universe::ReadGuard universe_guard;
+
+		if(space_handle == kHelNullHandle) {
+			space = this_thread->getAddressSpace().lock();
+		}else{
+			auto space_wrapper = this_universe->getDescriptor(universe_guard, space_handle);
+			if(!space_wrapper)
+				return kHelErrNoDescriptor;
+			if(!space_wrapper->is<AddressSpaceDescriptor>())
+				return kHelErrBadDescriptor;
+			space = space_wrapper->get<AddressSpaceDescriptor>().space;
+		}
+	}
+
+	if(!queue->validSize(ipcSourceSize(sizeof(HelSimpleResult))))
+		return kHelErrQueueTooSmall;
+
+	[](smarter::shared_ptr<AddressSpace, BindableHandle> space,
+			smarter::shared_ptr<IpcQueue> queue,
+			VirtualAddr pointer, size_t length, uintptr_t context,
+			enable_detached_coroutine) -> void {
+		auto outcome = co_await onExceptionalWq(space->unmap(pointer, length));
+
+		HelSimpleResult helResult{.error = kHelErrNone, .reserved = {}};
+		if(!outcome) {
+			assert(outcome.error() == Error::illegalArgs);
+			helResult.error = kHelErrIllegalArgs;
+		}
+		QueueSource ipcSource{&helResult, sizeof(HelSimpleResult), nullptr};
+		co_await queue->submit(&ipcSource, context);
+	}(std::move(space), std::move(queue), reinterpret_cast<VirtualAddr>(pointer),
+			length, context,
+			enable_detached_coroutine{getCurrentThread()->mainWorkQueue().lock()});
+
+	return kHelErrNone;
+}
+
 HelError doSubmitSynchronizeSpace(HelHandle spaceHandle, smarter::shared_ptr<IpcQueue> queue,
 		void *pointer, size_t length, uintptr_t context) {
 	auto thisThread = getCurrentThread();
@@ -1263,8 +1386,7 @@ HelError doSubmitSynchronizeSpace(HelHandle spaceHandle, smarter::shared_ptr<Ipc
 
 	smarter::shared_ptr<AddressSpace, BindableHandle> space;
 	{
-		auto irqLock = frg::guard(&irqMutex());
-		Universe::Guard universeGuard(thisUniverse->lock);
+		Universe::ReadGuard universeGuard;
 
 		if(spaceHandle == kHelNullHandle) {
 			space = thisThread->getAddressSpace().lock();
@@ -1324,8 +1446,7 @@ HelError doSubmitReadMemory(HelHandle handle, smarter::shared_ptr<IpcQueue> queu
 
 	AnyDescriptor descriptor;
 	{
-		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universeGuard(thisUniverse->lock);
+		Universe::ReadGuard universeGuard;
 
 		auto wrapper = thisUniverse->getDescriptor(universeGuard, handle);
 		if(!wrapper)
@@ -1368,7 +1489,6 @@ HelError doSubmitReadMemory(HelHandle handle, smarter::shared_ptr<IpcQueue> queu
 			}
 		}
 
-		assert(error == Error::success);
 		HelSimpleResult helResult{.error = translateError(error), .reserved = {}};
 		QueueSource ipcSource{&helResult, sizeof(HelSimpleResult), nullptr};
 		co_await queue->submit(&ipcSource, context);
@@ -1450,8 +1570,7 @@ HelError doSubmitWriteMemory(HelHandle handle, smarter::shared_ptr<IpcQueue> que
 
 	AnyDescriptor descriptor;
 	{
-		auto irqLock = frg::guard(&irqMutex());
-		Universe::Guard universeGuard(thisUniverse->lock);
+		Universe::ReadGuard universeGuard;
 
 		auto wrapper = thisUniverse->getDescriptor(universeGuard, handle);
 		if(!wrapper)
@@ -1577,8 +1696,7 @@ HelError helMemoryInfo(HelHandle handle, size_t *size) {
 
 	smarter::shared_ptr<MemoryView> memory;
 	{
-		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
+		Universe::ReadGuard universe_guard;
 
 		auto wrapper = this_universe->getDescriptor(universe_guard, handle);
 		if(!wrapper)
@@ -1598,8 +1716,7 @@ HelError doSubmitManageMemory(HelHandle handle, smarter::shared_ptr<IpcQueue> qu
 
 	smarter::shared_ptr<MemoryView> memory;
 	{
-		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
+		Universe::ReadGuard universe_guard;
 
 		auto memory_wrapper = this_universe->getDescriptor(universe_guard, handle);
 		if(!memory_wrapper)
@@ -1662,8 +1779,7 @@ HelError helUpdateMemory(HelHandle handle, int type,
 
 	smarter::shared_ptr<MemoryView> memory;
 	{
-		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
+		Universe::ReadGuard universe_guard;
 
 		auto memory_wrapper = this_universe->getDescriptor(universe_guard, handle);
 		if(!memory_wrapper)
@@ -1701,8 +1817,7 @@ HelError doSubmitLockMemoryView(HelHandle handle, smarter::shared_ptr<IpcQueue>
 
 	smarter::shared_ptr<MemoryView> memory;
 	{
-		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
+		Universe::ReadGuard universe_guard;
 
 		auto memory_wrapper = this_universe->getDescriptor(universe_guard, handle);
 		if(!memory_wrapper)
@@ -1782,8 +1897,7 @@ HelError helLoadahead(HelHandle handle, uintptr_t offset, size_t length) {
 
 	smarter::shared_ptr<MemoryView> memory;
 	{
-		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
+		Universe::ReadGuard universe_guard;
 
 		auto memory_wrapper = this_universe->getDescriptor(universe_guard, handle);
 		if(!memory_wrapper)
@@ -1805,6 +1919,43 @@ HelError helLoadahead(HelHandle handle, uintptr_t offset, size_t length) {
 
 std::atomic<unsigned int> globalNextCpu = 0;
 
+HelError helQueryMemoryStats(HelHandle spaceHandle, HelMemoryStats *userStats) {
+	auto thisThread = getCurrentThread();
+	auto thisUniverse = thisThread->getUniverse();
+
+	smarter::shared_ptr<AddressSpace, BindableHandle> space;
+	{
+		Universe::ReadGuard universeGuard;
+
+		if(spaceHandle == kHelNullHandle) {
+			space = thisThread->getAddressSpace().lock();
+		}else{
+			auto spaceWrapper = thisUniverse->getDescriptor(universeGuard, spaceHandle);
+			if(!spaceWrapper)
+				return kHelErrNoDescriptor;
+			if(!spaceWrapper->is<AddressSpaceDescriptor>())
+				return kHelErrBadDescriptor;
+			space = spaceWrapper->get<AddressSpaceDescriptor>().space;
+		}
+	}
+
+	auto swapStats = getCompressedSwapStats();
+
+	HelMemoryStats stats;
+	memset(&stats, 0, sizeof(HelMemoryStats));
+	stats.totalMemory = physicalAllocator->numTotalPages() * kPageSize;
+	stats.freeMemory = physicalAllocator->numFreePages() * kPageSize;
+	stats.cachedMemory = getPageCacheSize();
+	stats.compressedStored = swapStats.storedSize;
+	stats.compressedPool = swapStats.poolSize;
+	stats.residentMemory = space->rss();
+
+	if(!writeUserObject(userStats, stats))
+		return kHelErrFault;
+
+	return kHelErrNone;
+}
+
 HelError helCreateThread(HelHandle universe_handle, HelHandle space_handle,
 		int abi, void *ip, void *sp, uint32_t flags, HelHandle *handle) {
 	(void)abi;
@@ -1817,8 +1968,7 @@ HelError helCreateThread(HelHandle universe_handle, HelHandle space_handle,
 	smarter::shared_ptr<Universe> universe;
 	smarter::shared_ptr<AddressSpace, BindableHandle> space;
 	{
-		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
+		Universe::ReadGuard universe_guard;
 
 		if(universe_handle == kHelNullHandle) {
 			universe = this_thread->getUniverse().lock();
@@ -1879,8 +2029,7 @@ HelError helQueryThreadStats(HelHandle handle, HelThreadStats *user_stats) {
 	if(handle == kHelThisThread) {
 		thread = this_thread.lock();
 	}else{
-		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
+		Universe::ReadGuard universe_guard;
 
 		auto thread_wrapper = this_universe->getDescriptor(universe_guard, handle);
 		if(!thread_wrapper)
@@ -1908,8 +2057,7 @@ HelError helSetPriority(HelHandle handle, int priority) {
 	if(handle == kHelThisThread) {
 		thread = this_thread.lock();
 	}else{
-		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
+		Universe::ReadGuard universe_guard;
 
 		auto thread_wrapper = this_universe->getDescriptor(universe_guard, handle);
 		if(!thread_wrapper)
@@ -1937,8 +2085,7 @@ HelError doSubmitObserve(HelHandle handle, smarter::shared_ptr<IpcQueue> queue,
 
 	smarter::shared_ptr<Thread> thread;
 	{
-		auto irqLock = frg::guard(&irqMutex());
-		Universe::Guard universeGuard(thisUniverse->lock);
+		Universe::ReadGuard universeGuard;
 
 		auto threadWrapper = thisUniverse->getDescriptor(universeGuard, handle);
 		if(!threadWrapper)
@@ -1993,8 +2140,7 @@ HelError helKillThread(HelHandle handle) {
 
 	smarter::shared_ptr<Thread> thread;
 	{
-		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
+		Universe::ReadGuard universe_guard;
 
 		auto thread_wrapper = this_universe->getDescriptor(universe_guard, handle);
 		if(!thread_wrapper)
@@ -2015,8 +2161,7 @@ HelError helInterruptThread(HelHandle handle) {
 
 	smarter::shared_ptr<Thread> thread;
 	{
-		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
+		Universe::ReadGuard universe_guard;
 
 		auto thread_wrapper = this_universe->getDescriptor(universe_guard, handle);
 		if(!thread_wrapper)
@@ -2037,8 +2182,7 @@ HelError helResume(HelHandle handle) {
 
 	smarter::shared_ptr<Thread> thread;
 	{
-		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
+		Universe::ReadGuard universe_guard;
 
 		auto thread_wrapper = this_universe->getDescriptor(universe_guard, handle);
 		if(!thread_wrapper)
@@ -2065,8 +2209,7 @@ HelError helLoadRegisters(HelHandle handle, int set, void *image) {
 	smarter::shared_ptr<Thread> thread;
 	VirtualizedCpuDescriptor vcpu;
 	{
-		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
+		Universe::ReadGuard universe_guard;
 
 		auto thread_wrapper = this_universe->getDescriptor(universe_guard, handle);
 		if(!thread_wrapper)
@@ -2199,7 +2342,7 @@ HelError helLoadRegisters(HelHandle handle, int set, void *image) {
 		frg::unique_memory<KernelAlloc> buffer{*kernelAlloc, simdSize};
 		thread->accessRegisters([&](Executor *executor) {
 #if defined(__x86_64__)
-			memcpy(buffer.data(), executor->_fxState(), simdSize);
+			executor->exportSimdState(buffer.data());
 #elif defined(__aarch64__)
 			memcpy(buffer.data(), executor->fp(), simdSize);
 #elif defined(__riscv) && __riscv_xlen == 64
@@ -2302,8 +2445,7 @@ HelError helStoreRegisters(HelHandle handle, int set, const void *image) {
 		// FIXME: Properly handle this below.
 		thread = this_thread.lock();
 	}else{
-		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
+		Universe::ReadGuard universe_guard;
 
 		auto thread_wrapper = this_universe->getDescriptor(universe_guard, handle);
 		if(!thread_wrapper)
@@ -2571,14 +2713,14 @@ HelError helGetClock(uint64_t *counter) {
 }
 
 HelError doSubmitAwaitClock(smarter::shared_ptr<IpcQueue> queue, uint64_t counter,
-		uintptr_t context, CancelGuard cg) {
+		uint64_t slack, uintptr_t context, CancelGuard cg) {
 	if(!queue->validSize(ipcSourceSize(sizeof(HelSimpleResult))))
 		return kHelErrQueueTooSmall;
 
-	[](smarter::shared_ptr<IpcQueue> queue, uint64_t counter, uintptr_t context,
-			CancelGuard cg,
+	[](smarter::shared_ptr<IpcQueue> queue, uint64_t counter, uint64_t slack,
+			uintptr_t context, CancelGuard cg,
 			enable_detached_coroutine) -> void {
-		bool succeeded = co_await generalTimerEngine()->sleep(counter, cg.token());
+		bool succeeded = co_await generalTimerEngine()->sleep(counter, cg.token(), slack);
 
 		queue->unregisterTag(std::move(cg));
 
@@ -2586,7 +2728,7 @@ HelError doSubmitAwaitClock(smarter::shared_ptr<IpcQueue> queue, uint64_t counte
 		HelSimpleResult helResult{.error = error, .reserved = {}};
 		QueueSource ipcSource{&helResult, sizeof(HelSimpleResult), nullptr};
 		co_await queue->submit(&ipcSource, context);
-	}(std::move(queue), counter, context, std::move(cg),
+	}(std::move(queue), counter, slack, context, std::move(cg),
 		enable_detached_coroutine{getCurrentThread()->mainWorkQueue().lock()});
 
 	return kHelErrNone;
@@ -2628,8 +2770,7 @@ HelError doSubmitExchangeMsgs(HelHandle laneHandle, smarter::shared_ptr<IpcQueue
 
 	LaneHandle lane;
 	{
-		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(thisUniverse->lock);
+		Universe::ReadGuard universe_guard;
 
 		auto wrapper = thisUniverse->getDescriptor(universe_guard, laneHandle);
 		if(!wrapper)
@@ -2647,6 +2788,8 @@ HelError doSubmitExchangeMsgs(HelHandle laneHandle, smarter::shared_ptr<IpcQueue
 		StreamNode transmit;
 		QueueSource mainSource;
 		QueueSource dataSource;
+		// Memory object of kHelActionSendFromMemory and kHelActionRecvToMemory.
+		smarter::shared_ptr<MemoryView> memory;
 		union {
 			HelSimpleResult helSimpleResult;
 			HelHandleResult helHandleResult;
@@ -2694,8 +2837,7 @@ HelError doSubmitExchangeMsgs(HelHandle laneHandle, smarter::shared_ptr<IpcQueue
 				if(recipe->handle == kHelThisThread) {
 					creds = thisThread->credentials();
 				} else {
-					auto irq_lock = frg::guard(&irqMutex());
-					Universe::Guard universe_guard(thisUniverse->lock);
+					Universe::ReadGuard universe_guard;
 
 					auto wrapper = thisUniverse->getDescriptor(universe_guard, recipe->handle);
 					if(!wrapper) {
@@ -2774,11 +2916,51 @@ HelError doSubmitExchangeMsgs(HelHandle laneHandle, smarter::shared_ptr<IpcQueue
 				++numFlows;
 				ipcSize += ipcSourceSize(sizeof(HelLengthResult));
 				break;
+			case kHelActionSendFromMemory:
+			case kHelActionRecvToMemory: {
+				uintptr_t limit;
+				if(__builtin_add_overflow(recipe->offset, recipe->length, &limit))
+					return kHelErrIllegalArgs;
+
+				smarter::shared_ptr<MemoryView> memory;
+				{
+					Universe::ReadGuard universe_guard;
+
+					auto wrapper = thisUniverse->getDescriptor(universe_guard, recipe->handle);
+					if(!wrapper)
+						return kHelErrNoDescriptor;
+					if(!wrapper->is<MemoryViewDescriptor>())
+						return kHelErrBadDescriptor;
+					memory = wrapper->get<MemoryViewDescriptor>().memory;
+				}
+				if(limit > memory->getLength())
+					return kHelErrIllegalArgs;
+				items[i].memory = std::move(memory);
+
+				if(recipe->type == kHelActionRecvToMemory) {
+					node->_tag = kTagRecvFlow;
+					node->_maxLength = recipe->length;
+					++numFlows;
+					ipcSize += ipcSourceSize(sizeof(HelLengthResult));
+				}else if(!recipe->length) {
+					// Empty packets do not need the flow protocol.
+					node->_tag = kTagSendKernelBuffer;
+					node->_inBuffer = frg::unique_memory<KernelAlloc>(*kernelAlloc, 0);
+					ipcSize += ipcSourceSize(sizeof(HelSimpleResult));
+				}else{
+					// Unlike kHelActionSendFromBuffer, we always use the flow protocol:
+					// reading the memory object can block, so we cannot copy it here.
+					node->_tag = kTagSendFlow;
+					node->_maxLength = recipe->length;
+					++numFlows;
+					ipcSize += ipcSourceSize(sizeof(HelSimpleResult));
+				}
+				break;
+			}
 			case kHelActionPushDescriptor: {
 				AnyDescriptor operand;
 				{
-					auto irq_lock = frg::guard(&irqMutex());
-					Universe::Guard universe_guard(thisUniverse->lock);
+					Universe::ReadGuard universe_guard;
 
 					auto wrapper = thisUniverse->getDescriptor(universe_guard, recipe->handle);
 					if(!wrapper)
@@ -2856,8 +3038,14 @@ HelError doSubmitExchangeMsgs(HelHandle laneHandle, smarter::shared_ptr<IpcQueue
 			// Below, we need to ensure that we always complete our own nodes
 			// before completing peer nodes.
 
+			// Send flows are transferred with a single copy: we pin the pages of the sender's
+			// buffer and the receiver copies out of them through the physical mapping.
+			// Pages are kept pinned until the receiver acks the corresponding packet.
 			// The size of this array must be a power of two.
-			frg::array<frg::unique_memory<KernelAlloc>, 2> xferBuffers;
+			frg::array<PinnedPage, 8> xferPages;
+			// Send flows of at most one page are bounced through a kernel buffer instead
+			// since pinning costs more than the extra copy for small messages.
+			frg::unique_memory<KernelAlloc> xferBuffer;
 
 			size_t i = 0;
 			size_t seenFlows = 0; // Iterates through flows.
@@ -2900,12 +3088,42 @@ HelError doSubmitExchangeMsgs(HelHandle laneHandle, smarter::shared_ptr<IpcQueue
 					peer->_transmitBuffer = std::move(buffer);
 					peer->complete();
 					node->complete();
-				}else if(recipe->type == kHelActionSendFromBuffer
+				}else if(recipe->type == kHelActionSendFromMemory
+						&& peer->tag() == kTagRecvKernelBuffer) {
+					frg::unique_memory<KernelAlloc> buffer(*kernelAlloc, recipe->length);
+
+					auto outcome = co_await onExceptionalWq(item->memory->copyFrom(recipe->offset,
+							buffer.data(), recipe->length));
+					if(!outcome) {
+						// We complete with the error; the remote with success.
+						peer->_error = Error::success;
+						node->_error = outcome.error();
+						peer->complete();
+						node->complete();
+						continue;
+					}
+
+					// Both nodes complete successfully.
+					peer->_transmitBuffer = std::move(buffer);
+					peer->complete();
+					node->complete();
+				}else if((recipe->type == kHelActionSendFromBuffer
+							|| recipe->type == kHelActionSendFromMemory)
 						&& node->tag() == kTagSendFlow
 						&& peer->tag() == kTagRecvFlow) {
 					// Empty packets are handled by the generic stream code.
 					assert(recipe->length);
 
+					auto space = thread->getAddressSpace().lock();
+
+					// For memory objects, we lock the entire range instead of pinning
+					// individual pages. Once a page is touched, it stays available until
+					// we unlock the range (i.e., after the receiver acked all packets).
+					bool rangeLocked = false;
+					if(recipe->type == kHelActionSendFromMemory)
+						rangeLocked = item->memory->lockRange(recipe->offset, recipe->length)
+								== Error::success;
+
 					size_t progress = 0;
 					size_t numSent = 0;
 					size_t numAcked = 0;
@@ -2916,7 +3134,7 @@ HelError doSubmitExchangeMsgs(HelHandle laneHandle, smarter::shared_ptr<IpcQueue
 						while(numSent != numAcked) {
 							// If there is anything more to send, we only need to wait until
 							// at least one buffer is not in-flight (otherwise, we wait for all).
-							if(!lastTransferSent && numSent - numAcked < xferBuffers.size())
+							if(!lastTransferSent && numSent - numAcked < xferPages.size())
 								break;
 							auto ackPacket = co_await node->flowQueue.async_get();
 							assert(ackPacket);
@@ -2952,18 +3170,52 @@ HelError doSubmitExchangeMsgs(HelHandle laneHandle, smarter::shared_ptr<IpcQueue
 							break;
 						}
 
-						// Prepare a buffer an send it.
-						assert(numSent - numAcked < xferBuffers.size());
-						auto &xb = xferBuffers[numSent & (xferBuffers.size() - 1)];
-						if(!xb.size())
-							xb = frg::unique_memory<KernelAlloc>{*kernelAlloc, 4096};
-
-						auto chunkSize = frg::min(recipe->length - progress, xb.size());
+						// Pin (or copy) the next page and send it.
+						assert(numSent - numAcked < xferPages.size());
+						auto &xp = xferPages[numSent & (xferPages.size() - 1)];
+
+						size_t chunkSize;
+						std::byte *data = nullptr;
+						if(recipe->type == kHelActionSendFromMemory) {
+							auto viewOffset = recipe->offset + progress;
+							auto misalign = viewOffset & (kPageSize - 1);
+							chunkSize = frg::min(recipe->length - progress, kPageSize - misalign);
+
+							if(rangeLocked) {
+								auto touchOutcome = co_await onExceptionalWq(item->memory->touchRange(
+										viewOffset - misalign, kPageSize, fetchNone));
+								if(touchOutcome) {
+									PageAccessor accessor{item->memory->peekRange(viewOffset - misalign,
+											fetchNone).physical};
+									data = reinterpret_cast<std::byte *>(accessor.get()) + misalign;
+								}
+							}
+						}else if(recipe->length <= kPageSize) {
+							// The whole transfer fits into a single packet.
+							if(!xferBuffer.size())
+								xferBuffer = frg::unique_memory<KernelAlloc>{*kernelAlloc, kPageSize};
+
+							chunkSize = recipe->length - progress;
+							if(readUserMemory(xferBuffer.data(),
+									reinterpret_cast<std::byte *>(recipe->buffer) + progress, chunkSize))
+								data = reinterpret_cast<std::byte *>(xferBuffer.data());
+						}else{
+							auto address = reinterpret_cast<uintptr_t>(recipe->buffer) + progress;
+							auto misalign = address & (kPageSize - 1);
+							chunkSize = frg::min(recipe->length - progress, kPageSize - misalign);
+
+							auto pinOutcome = co_await onExceptionalWq(space->pinPage(address, fetchNone));
+							if(pinOutcome) {
+								// This unpins the page that previously occupied the slot
+								// (it was already acked).
+								xp = std::move(pinOutcome.value());
+								PageAccessor accessor{xp.physical};
+								data = reinterpret_cast<std::byte *>(accessor.get()) + misalign;
+							}
+						}
 						assert(chunkSize);
 
-						auto outcome = readUserMemory(xb.data(),
-								reinterpret_cast<std::byte *>(recipe->buffer) + progress, chunkSize);
-						if(!outcome) {
+						if(!data) {
 							// Send the packet (may deallocate the peer!).
 							peer->flowQueue.put({ .terminate = true, .fault = true });
 							++numSent;
@@ -2983,7 +3235,7 @@ HelError doSubmitExchangeMsgs(HelHandle laneHandle, smarter::shared_ptr<IpcQueue
 						lastTransferSent = (progress + chunkSize == recipe->length);
 						// Send the packet (may deallocate the peer!).
 						peer->flowQueue.put({
-							.data = xb.data(),
+							.data = data,
 							.size = chunkSize,
 							.terminate = lastTransferSent
 						});
@@ -2991,11 +3243,20 @@ HelError doSubmitExchangeMsgs(HelHandle laneHandle, smarter::shared_ptr<IpcQueue
 						progress += chunkSize;
 					}
 
+					if(rangeLocked)
+						item->memory->unlockRange(recipe->offset, recipe->length);
 					node->complete();
-				}else if(recipe->type == kHelActionRecvToBuffer
+				}else if((recipe->type == kHelActionRecvToBuffer
+							|| recipe->type == kHelActionRecvToMemory)
 						&& peer->tag() == kTagSendKernelBuffer) {
-					auto outcome = writeUserMemory(recipe->buffer,
-							peer->_inBuffer.data(), peer->_inBuffer.size());
+					bool outcome;
+					if(recipe->type == kHelActionRecvToMemory) {
+						outcome = static_cast<bool>(co_await onExceptionalWq(item->memory->copyTo(
+								recipe->offset, peer->_inBuffer.data(), peer->_inBuffer.size())));
+					}else{
+						outcome = writeUserMemory(recipe->buffer,
+								peer->_inBuffer.data(), peer->_inBuffer.size());
+					}
 					if(!outcome) {
 						// We complete with fault; the remote with success.
 						// TODO: it probably makes sense to introduce a "remote fault" error.
@@ -3011,7 +3272,8 @@ HelError doSubmitExchangeMsgs(HelHandle laneHandle, smarter::shared_ptr<IpcQueue
 					peer->complete();
 					node->complete();
 				}else{
-					assert(recipe->type == kHelActionRecvToBuffer
+					assert((recipe->type == kHelActionRecvToBuffer
+								|| recipe->type == kHelActionRecvToMemory)
 							&& peer->tag() == kTagSendFlow);
 
 					size_t progress = 0;
@@ -3025,9 +3287,16 @@ HelError doSubmitExchangeMsgs(HelHandle laneHandle, smarter::shared_ptr<IpcQueue
 							// Otherwise, there would have been a transmission error.
 							assert(progress + xferPacket->size <= recipe->length);
 
-							auto outcome = writeUserMemory(
-									reinterpret_cast<std::byte *>(recipe->buffer) + progress,
-									xferPacket->data, xferPacket->size);
+							bool outcome;
+							if(recipe->type == kHelActionRecvToMemory) {
+								outcome = static_cast<bool>(co_await onExceptionalWq(
+										item->memory->copyTo(recipe->offset + progress,
+												xferPacket->data, xferPacket->size)));
+							}else{
+								outcome = writeUserMemory(
+										reinterpret_cast<std::byte *>(recipe->buffer) + progress,
+										xferPacket->data, xferPacket->size);
+							}
 							if(outcome) {
 								progress += xferPacket->size;
 							}else{
@@ -3142,7 +3411,8 @@ HelError doSubmitExchangeMsgs(HelHandle laneHandle, smarter::shared_ptr<IpcQueue
 						sizeof(HelCredentialsResult));
 				link(&item->mainSource);
 			}else if(recipe->type == kHelActionSendFromBuffer
-					|| recipe->type == kHelActionSendFromBufferSg) {
+					|| recipe->type == kHelActionSendFromBufferSg
+					|| recipe->type == kHelActionSendFromMemory) {
 				item->helSimpleResult = {translateError(node->error()), 0};
 				item->mainSource.setup(&item->helSimpleResult, sizeof(HelSimpleResult));
 				link(&item->mainSource);
@@ -3154,7 +3424,8 @@ HelError doSubmitExchangeMsgs(HelHandle laneHandle, smarter::shared_ptr<IpcQueue
 						node->_transmitBuffer.size());
 				link(&item->mainSource);
 				link(&item->dataSource);
-			}else if(recipe->type == kHelActionRecvToBuffer) {
+			}else if(recipe->type == kHelActionRecvToBuffer
+					|| recipe->type == kHelActionRecvToMemory) {
 				item->helLengthResult = {translateError(node->error()),
 						0, node->actualLength()};
 				item->mainSource.setup(&item->helLengthResult, sizeof(HelLengthResult));
@@ -3199,8 +3470,7 @@ HelError helShutdownLane(HelHandle handle) {
 
 	LaneHandle lane;
 	{
-		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
+		Universe::ReadGuard universe_guard;
 
 		auto wrapper = this_universe->getDescriptor(universe_guard, handle);
 		if(!wrapper)
@@ -3215,6 +3485,270 @@ HelError helShutdownLane(HelHandle handle) {
 	return kHelErrNone;
 }
 
+namespace {
+	// Waits until all nodes of a packet complete. If the thread is interrupted,
+	// cancel() must cause the remaining nodes to complete soon.
+	// Returns false if the wait was interrupted.
+	template<typename F>
+	bool blockOnStreamPacket(StreamPacket &packet, F cancel) {
+		bool interrupted = false;
+		Thread::asyncBlockCurrentInterruptible(
+			async::lambda([&](async::cancellation_token ct) -> coroutine<void> {
+				async::cancellation_callback cb{ct, [&] {
+					interrupted = true;
+					cancel();
+				}};
+				co_await packet.completion.wait();
+			}),
+			getCurrentThread()->mainWorkQueue().get()
+		);
+		return !interrupted;
+	}
+
+	// Shuts down our side of a conversation such that pending nodes on both sides fail.
+	void abortConversation(LaneHandle &lane) {
+		lane.getStream()->shutdownLane(lane.getLane());
+	}
+} // namespace
+
+HelError helCallLane(HelHandle laneHandle, uint32_t flags, HelLaneMessage *message) {
+	if(flags & ~kHelCallLanePullDescriptor)
+		return kHelErrIllegalArgs;
+
+	auto thisThread = getCurrentThread();
+	auto thisUniverse = thisThread->getUniverse();
+
+	HelLaneMessage msg;
+	if(!readUserObject(message, msg))
+		return kHelErrFault;
+	// Larger buffers would require the flow protocol; use helSubmitAsync() for those.
+	if(msg.sendLength > kPageSize || msg.recvMaxLength > kPageSize)
+		return kHelErrIllegalArgs;
+
+	LaneHandle lane;
+	{
+		Universe::ReadGuard universe_guard;
+
+		auto wrapper = thisUniverse->getDescriptor(universe_guard, laneHandle);
+		if(!wrapper)
+			return kHelErrNoDescriptor;
+		if(!wrapper->is<LaneDescriptor>())
+			return kHelErrBadDescriptor;
+		lane = wrapper->get<LaneDescriptor>().handle;
+	}
+
+	frg::unique_memory<KernelAlloc> buffer(*kernelAlloc, msg.sendLength);
+	if(!readUserMemory(buffer.data(), msg.sendBuffer, msg.sendLength))
+		return kHelErrFault;
+
+	// This builds the same nodes as an offer with ancillary SendFromBuffer,
+	// RecvInline and PullDescriptor actions, such that the server cannot tell the difference.
+	// The offer uses its own packet since interrupts are handled differently
+	// before and after it is accepted.
+	bool pull = flags & kHelCallLanePullDescriptor;
+	StreamPacket offerPacket;
+	StreamPacket packet;
+	StreamNode offerNode;
+	StreamNode sendNode;
+	StreamNode recvNode;
+	StreamNode pullNode;
+	offerPacket.setup(1);
+	packet.setup(pull ? 3 : 2);
+	offerNode.setup(kTagOffer, &offerPacket);
+	sendNode.setup(kTagSendKernelBuffer, &packet);
+	sendNode._inBuffer = std::move(buffer);
+	recvNode.setup(kTagRecvKernelBuffer, &packet);
+	recvNode._maxLength = msg.recvMaxLength;
+	offerNode.ancillaryChain.push_back(&sendNode);
+	offerNode.ancillaryChain.push_back(&recvNode);
+	if(pull) {
+		pullNode.setup(kTagPullDescriptor, &packet);
+		offerNode.ancillaryChain.push_back(&pullNode);
+	}
+
+	StreamList rootChain;
+	rootChain.push_back(&offerNode);
+	Stream::transmit(lane, rootChain);
+
+	// If the offer was not accepted yet, cancelling it also cancels the ancillary nodes.
+	bool interrupted = !blockOnStreamPacket(offerPacket, [&] {
+		Stream::cancelPending(&offerNode);
+	});
+	// A failed offer never submits its ancillary nodes.
+	if(offerNode.error() != Error::success)
+		return translateError(offerNode.error());
+
+	// Otherwise, the server might never reply; shut down the conversation on interrupt.
+	auto conversation = offerNode.lane();
+	if(!blockOnStreamPacket(packet, [&] { abortConversation(conversation); }))
+		interrupted = true;
+
+	if(interrupted && (sendNode.error() != Error::success
+			|| recvNode.error() != Error::success
+			|| (pull && pullNode.error() != Error::success)))
+		return kHelErrCancelled;
+	if(sendNode.error() != Error::success)
+		return translateError(sendNode.error());
+	if(recvNode.error() != Error::success)
+		return translateError(recvNode.error());
+	if(pull && pullNode.error() != Error::success)
+		return translateError(pullNode.error());
+
+	auto reply = recvNode.transmitBuffer();
+	if(!writeUserMemory(msg.recvBuffer, reply.data(), reply.size()))
+		return kHelErrFault;
+	msg.recvLength = reply.size();
+
+	msg.handle = kHelNullHandle;
+	if(pull) {
+		auto irqLock = frg::guard(&irqMutex());
+		Universe::Guard lock(thisUniverse->lock);
+
+		msg.handle = thisUniverse->attachDescriptor(lock, pullNode.descriptor());
+	}
+
+	if(!writeUserObject(message, msg))
+		return kHelErrFault;
+
+	return kHelErrNone;
+}
+
+HelError helReplyAndWait(HelHandle conversation, HelHandle listenLane,
+		uint32_t flags, HelLaneMessage *message) {
+	if(flags & ~kHelReplyPushDescriptor)
+		return kHelErrIllegalArgs;
+
+	auto thisThread = getCurrentThread();
+	auto thisUniverse = thisThread->getUniverse();
+
+	HelLaneMessage msg;
+	if(!readUserObject(message, msg))
+		return kHelErrFault;
+	if(msg.sendLength > kPageSize || msg.recvMaxLength > kPageSize)
+		return kHelErrIllegalArgs;
+
+	LaneHandle listen;
+	if(listenLane != kHelNullHandle) {
+		Universe::ReadGuard universe_guard;
+
+		auto wrapper = thisUniverse->getDescriptor(universe_guard, listenLane);
+		if(!wrapper)
+			return kHelErrNoDescriptor;
+		if(!wrapper->is<LaneDescriptor>())
+			return kHelErrBadDescriptor;
+		listen = wrapper->get<LaneDescriptor>().handle;
+	}
+
+	if(conversation != kHelNullHandle) {
+		frg::unique_memory<KernelAlloc> buffer(*kernelAlloc, msg.sendLength);
+		if(!readUserMemory(buffer.data(), msg.sendBuffer, msg.sendLength))
+			return kHelErrFault;
+
+		bool push = flags & kHelReplyPushDescriptor;
+		AnyDescriptor operand;
+		if(push) {
+			Universe::ReadGuard universe_guard;
+
+			auto wrapper = thisUniverse->getDescriptor(universe_guard, msg.handle);
+			if(!wrapper)
+				return kHelErrNoDescriptor;
+			operand = *wrapper;
+		}
+
+		// The conversation is only used once, hence we close its handle.
+		frg::optional<AnyDescriptor> descriptor;
+		{
+			auto irqLock = frg::guard(&irqMutex());
+			Universe::Guard lock(thisUniverse->lock);
+
+			auto wrapper = thisUniverse->getDescriptor(lock, conversation);
+			if(!wrapper)
+				return kHelErrNoDescriptor;
+			if(!wrapper->is<LaneDescriptor>())
+				return kHelErrBadDescriptor;
+			descriptor = thisUniverse->detachDescriptor(lock, conversation);
+		}
+		auto lane = descriptor->get<LaneDescriptor>().handle;
+
+		StreamPacket packet;
+		StreamNode sendNode;
+		StreamNode pushNode;
+		packet.setup(push ? 2 : 1);
+		sendNode.setup(kTagSendKernelBuffer, &packet);
+		sendNode._inBuffer = std::move(buffer);
+
+		StreamList chain;
+		chain.push_back(&sendNode);
+		if(push) {
+			pushNode.setup(kTagPushDescriptor, &packet);
+			pushNode._inDescriptor = std::move(operand);
+			chain.push_back(&pushNode);
+		}
+		Stream::transmit(lane, chain);
+
+		// Errors are ignored: the caller might already have closed its lane.
+		// A caller that never receives the reply must not block us forever, though.
+		if(!blockOnStreamPacket(packet, [&] { abortConversation(lane); }))
+			return kHelErrCancelled;
+	}
+
+	if(listenLane == kHelNullHandle)
+		return kHelErrNone;
+
+	// As in helCallLane(), the accept uses its own packet.
+	StreamPacket acceptPacket;
+	StreamPacket packet;
+	StreamNode acceptNode;
+	StreamNode recvNode;
+	acceptPacket.setup(1);
+	packet.setup(1);
+	acceptNode.setup(kTagAccept, &acceptPacket);
+	recvNode.setup(kTagRecvKernelBuffer, &packet);
+	recvNode._maxLength = msg.recvMaxLength;
+	acceptNode.ancillaryChain.push_back(&recvNode);
+
+	StreamList rootChain;
+	rootChain.push_back(&acceptNode);
+	Stream::transmit(listen, rootChain);
+
+	bool interrupted = !blockOnStreamPacket(acceptPacket, [&] {
+		Stream::cancelPending(&acceptNode);
+	});
+	if(acceptNode.error() != Error::success)
+		return translateError(acceptNode.error());
+
+	// The client might never send its request; shut down the conversation on interrupt.
+	auto accepted = acceptNode.lane();
+	if(!blockOnStreamPacket(packet, [&] { abortConversation(accepted); }))
+		interrupted = true;
+
+	{
+		auto irqLock = frg::guard(&irqMutex());
+		Universe::Guard lock(thisUniverse->lock);
+
+		msg.handle = thisUniverse->attachDescriptor(lock,
+				LaneDescriptor{std::move(accepted)});
+	}
+
+	// Even if receiving fails, the caller owns the accepted lane and needs to close it.
+	HelError recvError = translateError(recvNode.error());
+	if(interrupted && recvNode.error() != Error::success)
+		recvError = kHelErrCancelled;
+	if(recvNode.error() == Error::success) {
+		auto request = recvNode.transmitBuffer();
+		if(!writeUserMemory(msg.recvBuffer, request.data(), request.size()))
+			recvError = kHelErrFault;
+		msg.recvLength = request.size();
+	}else{
+		msg.recvLength = 0;
+	}
+
+	if(!writeUserObject(message, msg))
+		return kHelErrFault;
+
+	return recvError;
+}
+
 HelError helFutexWait(int *pointer, int expected, int64_t deadline) {
 	auto thisThread = getCurrentThread();
 	auto space = thisThread->getAddressSpace();
@@ -3278,6 +3812,86 @@ HelError helFutexWake(int *pointer, unsigned int count) {
 	return kHelErrNone;
 }
 
+HelError helFutexRequeue(int *pointer, int *target, int expected,
+		unsigned int wakeCount, unsigned int requeueCount) {
+	auto thisThread = getCurrentThread();
+	auto space = thisThread->getAddressSpace();
+	auto address = reinterpret_cast<uintptr_t>(pointer);
+	auto targetAddress = reinterpret_cast<uintptr_t>(target);
+
+	auto result = Thread::asyncBlockCurrent(
+		getGlobalFutexRealm()->requeue(
+			space->globalFutexSpace(), address, targetAddress,
+			expected, wakeCount, requeueCount
+		),
+		thisThread->pagingWorkQueue().get()
+	);
+	if(!result)
+		return translateError(result.error());
+
+	return kHelErrNone;
+}
+
+HelError helFutexWakeOp(int *pointer, unsigned int count,
+		int *target, unsigned int targetCount, uint32_t op) {
+	auto thisThread = getCurrentThread();
+	auto space = thisThread->getAddressSpace();
+	auto address = reinterpret_cast<uintptr_t>(pointer);
+	auto targetAddress = reinterpret_cast<uintptr_t>(target);
+
+	// Decode the operation. The arguments are sign-extended 12-bit integers.
+	unsigned int opType = (op >> 28) & 0xF;
+	unsigned int cmpType = (op >> 24) & 0xF;
+	int opArg = static_cast<int32_t>(op << 8) >> 20;
+	int cmpArg = static_cast<int32_t>(op << 20) >> 20;
+
+	if(opType & kHelFutexOpArgShift) {
+		if(opArg < 0 || opArg > 31)
+			return kHelErrIllegalArgs;
+		opArg = 1 << opArg;
+		opType &= ~kHelFutexOpArgShift;
+	}
+	if(opType > kHelFutexOpXor || cmpType > kHelFutexCmpGe)
+		return kHelErrIllegalArgs;
+
+	auto applyOp = [=] (unsigned int value) -> unsigned int {
+		auto arg = static_cast<unsigned int>(opArg);
+		switch(opType) {
+		case kHelFutexOpSet: return arg;
+		case kHelFutexOpAdd: return value + arg;
+		case kHelFutexOpOr: return value | arg;
+		case kHelFutexOpAndn: return value & ~arg;
+		case kHelFutexOpXor: return value ^ arg;
+		default: __builtin_unreachable();
+		}
+	};
+
+	auto compare = [=] (unsigned int value) -> bool {
+		auto v = static_cast<int>(value);
+		switch(cmpType) {
+		case kHelFutexCmpEq: return v == cmpArg;
+		case kHelFutexCmpNe: return v != cmpArg;
+		case kHelFutexCmpLt: return v < cmpArg;
+		case kHelFutexCmpLe: return v <= cmpArg;
+		case kHelFutexCmpGt: return v > cmpArg;
+		case kHelFutexCmpGe: return v >= cmpArg;
+		default: __builtin_unreachable();
+		}
+	};
+
+	auto result = Thread::asyncBlockCurrent(
+		getGlobalFutexRealm()->wakeOp(
+			space->globalFutexSpace(), address, count,
+			targetAddress, targetCount, applyOp, compare
+		),
+		thisThread->pagingWorkQueue().get()
+	);
+	if(!result)
+		return translateError(result.error());
+
+	return kHelErrNone;
+}
+
 HelError helCreateOneshotEvent(HelHandle *handle) {
 	auto this_thread = getCurrentThread();
 	auto this_universe = this_thread->getUniverse();
@@ -3318,8 +3932,7 @@ HelError helRaiseEvent(HelHandle handle) {
 
 	AnyDescriptor descriptor;
 	{
-		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
+		Universe::ReadGuard universe_guard;
 
 		auto wrapper = this_universe->getDescriptor(universe_guard, handle);
 		if(!wrapper)
@@ -3337,6 +3950,34 @@ HelError helRaiseEvent(HelHandle handle) {
 	return kHelErrNone;
 }
 
+HelError helCreateMemoryPressureEvent(const uint64_t *thresholds, size_t numThresholds,
+		HelHandle *handle) {
+	auto thisThread = getCurrentThread();
+	auto thisUniverse = thisThread->getUniverse();
+
+	if(!numThresholds || numThresholds > maxPressureThresholds)
+		return kHelErrIllegalArgs;
+
+	uint64_t kernelThresholds[maxPressureThresholds];
+	if(!readUserArray(thresholds, kernelThresholds, numThresholds))
+		return kHelErrFault;
+
+	auto event = smarter::allocate_shared<BitsetEvent>(*kernelAlloc);
+	auto error = watchMemoryPressure(event, {kernelThresholds, numThresholds});
+	if(error != Error::success)
+		return translateError(error);
+
+	{
+		auto irqLock = frg::guard(&irqMutex());
+		Universe::Guard universeGuard(thisUniverse->lock);
+
+		*handle = thisUniverse->attachDescriptor(universeGuard,
+				BitsetEventDescriptor(std::move(event)));
+	}
+
+	return kHelErrNone;
+}
+
 HelError helAccessIrq(int number, HelHandle *handle) {
 #ifdef __x86_64__
 	auto this_thread = getCurrentThread();
@@ -3375,8 +4016,7 @@ HelError helAcknowledgeIrq(HelHandle handle, uint32_t flags, uint64_t sequence)
 
 	smarter::shared_ptr<IrqObject> irq;
 	{
-		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
+		Universe::ReadGuard universe_guard;
 
 		auto irq_wrapper = this_universe->getDescriptor(universe_guard, handle);
 		if(!irq_wrapper)
@@ -3412,8 +4052,7 @@ HelError doSubmitAwaitEvent(HelHandle handle, smarter::shared_ptr<IpcQueue> queu
 
 	AnyDescriptor descriptor;
 	{
-		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
+		Universe::ReadGuard universe_guard;
 		auto wrapper = this_universe->getDescriptor(universe_guard, handle);
 		if(!wrapper)
 			return kHelErrNoDescriptor;
@@ -3505,8 +4144,7 @@ HelError helAutomateIrq(HelHandle handle, uint32_t flags, HelHandle kernlet_hand
 	smarter::shared_ptr<IrqObject> irq;
 	smarter::shared_ptr<BoundKernlet> kernlet;
 	{
-		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
+		Universe::ReadGuard universe_guard;
 
 		auto irq_wrapper = this_universe->getDescriptor(universe_guard, handle);
 		if(!irq_wrapper)
@@ -3559,8 +4197,7 @@ HelError helEnableIo(HelHandle handle) {
 
 	smarter::shared_ptr<IoSpace> io_space;
 	{
-		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
+		Universe::ReadGuard universe_guard;
 
 		auto wrapper = this_universe->getDescriptor(universe_guard, handle);
 		if(!wrapper)
@@ -3599,8 +4236,7 @@ HelError helBindKernlet(HelHandle handle, const HelKernletData *data, size_t num
 
 	smarter::shared_ptr<KernletObject> kernlet;
 	{
-		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
+		Universe::ReadGuard universe_guard;
 
 		auto kernlet_wrapper = this_universe->getDescriptor(universe_guard, handle);
 		if(!kernlet_wrapper)
@@ -3628,8 +4264,7 @@ HelError helBindKernlet(HelHandle handle, const HelKernletData *data, size_t num
 		}else if(defn.type == KernletParameterType::memoryView) {
 			smarter::shared_ptr<MemoryView> memory;
 			{
-				auto irq_lock = frg::guard(&irqMutex());
-				Universe::Guard universe_guard(this_universe->lock);
+				Universe::ReadGuard universe_guard;
 
 				auto wrapper = this_universe->getDescriptor(universe_guard, d.handle);
 				if(!wrapper)
@@ -3658,8 +4293,7 @@ HelError helBindKernlet(HelHandle handle, const HelKernletData *data, size_t num
 
 			smarter::shared_ptr<BitsetEvent> event;
 			{
-				auto irq_lock = frg::guard(&irqMutex());
-				Universe::Guard universe_guard(this_universe->lock);
+				Universe::ReadGuard universe_guard;
 
 				auto wrapper = this_universe->getDescriptor(universe_guard, d.handle);
 				if(!wrapper)
@@ -3694,8 +4328,7 @@ HelError helGetAffinity(HelHandle handle, uint8_t *mask, size_t size, size_t *ac
 
 	smarter::borrowed_ptr<Thread> thread;
 	{
-		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
+		Universe::ReadGuard universe_guard;
 
 		auto thread_wrapper = this_universe->getDescriptor(universe_guard, handle);
 		if(!thread_wrapper)
@@ -3749,8 +4382,7 @@ HelError helSetAffinity(HelHandle handle, uint8_t *mask, size_t size) {
 	} else {
 		smarter::borrowed_ptr<Thread> thread;
 		{
-			auto irq_lock = frg::guard(&irqMutex());
-			Universe::Guard universe_guard(this_universe->lock);
+			Universe::ReadGuard universe_guard;
 
 			auto thread_wrapper = this_universe->getDescriptor(universe_guard, handle);
 			if(!thread_wrapper)
@@ -3907,7 +4539,8 @@ void thor::submitFromSq(smarter::shared_ptr<IpcQueue> queue, uint32_t opcode,
 		HelSqAwaitClock sqData;
 		memcpy(&sqData, sqSpan.data(), sizeof(sqData));
 		auto cg = queue->registerTag(sqData.cancellationTag);
-		error = doSubmitAwaitClock(queue, sqData.counter, context, std::move(cg));
+		error = doSubmitAwaitClock(queue, sqData.counter, sqData.slack,
+				context, std::move(cg));
 		break;
 	}
 	case kHelSubmitAwaitEvent: {
@@ -4048,6 +4681,41 @@ void thor::submitFromSq(smarter::shared_ptr<IpcQueue> queue, uint32_t opcode,
 		error = doSubmitInvalidateMemory(sqData.handle, queue, sqData.offset, sqData.size, context);
 		break;
 	}
+	case kHelSubmitMapMemory: {
+		if(sqSpan.size() < sizeof(HelSqMapMemory)) {
+			infoLogger() << "Bad length for kHelSubmitMapMemory" << frg::endlog;
+			error = kHelErrBufferTooSmall;
+			break;
+		}
+		HelSqMapMemory sqData;
+		memcpy(&sqData, sqSpan.data(), sizeof(sqData));
+		error = doSubmitMapMemory(sqData.memoryHandle, sqData.spaceHandle, queue,
+				sqData.pointer, sqData.offset, sqData.size, sqData.flags, context);
+		break;
+	}
+	case kHelSubmitUnmapMemory: {
+		if(sqSpan.size() < sizeof(HelSqUnmapMemory)) {
+			infoLogger() << "Bad length for kHelSubmitUnmapMemory" << frg::endlog;
+			error = kHelErrBufferTooSmall;
+			break;
+		}
+		HelSqUnmapMemory sqData;
+		memcpy(&sqData, sqSpan.data(), sizeof(sqData));
+		error = doSubmitUnmapMemory(sqData.spaceHandle, queue,
+				sqData.pointer, sqData.size, context);
+		break;
+	}
+	case kHelSubmitCloseDescriptor: {
+		if(sqSpan.size() < sizeof(HelSqCloseDescriptor)) {
+			infoLogger() << "Bad length for kHelSubmitCloseDescriptor" << frg::endlog;
+			error = kHelErrBufferTooSmall;
+			break;
+		}
+		HelSqCloseDescriptor sqData;
+		memcpy(&sqData, sqSpan.data(), sizeof(sqData));
+		error = doSubmitCloseDescriptor(sqData.universeHandle, sqData.handle, queue, context);
+		break;
+	}
 	default:
 		error = kHelErrIllegalSyscall;
 		infoLogger() << "thor: Bad opcode " << opcode << " in submission queue" << frg::endlog;
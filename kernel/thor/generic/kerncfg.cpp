@@ -10,6 +10,7 @@
 #include <thor-internal/stream.hpp>
 #include <thor-internal/timer.hpp>
 #include <thor-internal/mbus.hpp>
+#include <thor-internal/memory-view.hpp>
 #include <thor-internal/physical.hpp>
 
 #include <bragi/helpers-frigg.hpp>
@@ -84,6 +85,32 @@ private:
 			resp.set_total_usable_memory(physicalAllocator->numTotalPages());
 			resp.set_available_memory(physicalAllocator->numFreePages());
 			resp.set_memory_unit(kPageSize);
+			auto swapStats = getCompressedSwapStats();
+			resp.set_compressed_stored_size(swapStats.storedSize);
+			resp.set_compressed_pool_size(swapStats.poolSize);
+
+			frg::unique_memory<KernelAlloc> respBuffer{*kernelAlloc, resp.size_of_head()};
+			bragi::write_head_only(resp, respBuffer);
+			auto respError = co_await sendBuffer(lane, std::move(respBuffer));
+			if(respError != Error::success)
+				co_return respError;
+		}else if(preamble.id() == bragi::message_id<managarm::kerncfg::ReadaheadRequest>) {
+			auto req = bragi::parse_head_only<managarm::kerncfg::ReadaheadRequest>(reqBuffer, *kernelAlloc);
+
+			if (!req)
+				co_return Error::protocolViolation;
+
+			if(req->min_size() || req->max_size()) {
+				auto bounds = getReadaheadBounds();
+				setReadaheadBounds(req->min_size() ? req->min_size() : bounds.minSize,
+						req->max_size() ? req->max_size() : bounds.maxSize);
+			}
+
+			auto bounds = getReadaheadBounds();
+			managarm::kerncfg::ReadaheadResponse<KernelAlloc> resp(*kernelAlloc);
+			resp.set_error(managarm::kerncfg::Error::SUCCESS);
+			resp.set_min_size(bounds.minSize);
+			resp.set_max_size(bounds.maxSize);
 
 			frg::unique_memory<KernelAlloc> respBuffer{*kernelAlloc, resp.size_of_head()};
 			bragi::write_head_only(resp, respBuffer);
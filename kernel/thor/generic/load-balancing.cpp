@@ -12,6 +12,10 @@ constexpr bool debugLb = false;
 constexpr bool enableLb = true;
 constexpr uint64_t lbInterval = 100'000'000;
 
+// Threads are only moved across NUMA nodes if the source CPU exceeds the ideal load
+// by more than 1 / lbRemoteImbalance. Such moves lose cache and memory locality.
+constexpr uint64_t lbRemoteImbalance = 4;
+
 // Load decay factor (scale is hardcoded to 8 below) and decay interval.
 constexpr uint64_t lbDecay = 184;
 constexpr uint64_t lbDecayInterval = 1'000'000'000;
@@ -132,11 +136,17 @@ coroutine<void> LoadBalancer::run_(CpuData *cpu) {
 			// Distribute load from other CPUs to this CPU.
 			// TODO: This loop probably does not scale very well since all CPUs try to pull from
 			//       all other CPUs in the same order (and this can cause lock contention).
+			// CPUs on the same NUMA node are considered first.
 			uint64_t newLoad = thisNode->totalLoad;
 			for (size_t i = 0; i < getCpuCount(); ++i) {
 				auto *toCpu = getCpuData(i);
-				if (cpu != toCpu)
-					balanceBetween_(&lbNode.get(toCpu), thisNode, newLoad, idealLoad);
+				if (cpu != toCpu && toCpu->numaNode == cpu->numaNode)
+					balanceBetween_(&lbNode.get(toCpu), thisNode, newLoad, idealLoad, false);
+			}
+			for (size_t i = 0; i < getCpuCount(); ++i) {
+				auto *toCpu = getCpuData(i);
+				if (toCpu->numaNode != cpu->numaNode)
+					balanceBetween_(&lbNode.get(toCpu), thisNode, newLoad, idealLoad, true);
 			}
 		}
 
@@ -149,7 +159,8 @@ coroutine<void> LoadBalancer::run_(CpuData *cpu) {
 	co_return;
 }
 
-void LoadBalancer::balanceBetween_(LbNode *srcNode, LbNode *dstNode, uint64_t &newLoad, uint64_t idealLoad) {
+void LoadBalancer::balanceBetween_(LbNode *srcNode, LbNode *dstNode, uint64_t &newLoad, uint64_t idealLoad,
+		bool remote) {
 	auto improvesBalance = [] (uint64_t srcLoad, uint64_t dstLoad, uint64_t stolenLoad) -> bool {
 		uint64_t srcLoadPostMove = srcLoad - stolenLoad;
 		uint64_t dstLoadPostMove = dstLoad + stolenLoad;
@@ -184,6 +195,10 @@ void LoadBalancer::balanceBetween_(LbNode *srcNode, LbNode *dstNode, uint64_t &n
 			if (srcNode->currentLoad < idealLoad && newLoad < idealLoad)
 				break;
 
+			// Only steal from remote NUMA nodes if they are significantly overloaded.
+			if (remote && srcNode->currentLoad <= idealLoad + idealLoad / lbRemoteImbalance)
+				break;
+
 			// Do not move threads with tiny contributions to the total load.
 			if (!cb->load_)
 				continue;
@@ -106,6 +106,7 @@ extern "C" void thorInitialize() {
 	infoLogger() << "thor: Basic memory management is ready" << frg::endlog;
 
 	runCpuDataInitializers();
+	physicalAllocator->enablePerCpuCaches();
 	initializeAsidContext(getCpuData());
 }
 
@@ -712,6 +713,9 @@ void handleSyscall(SyscallImageAccessor image) {
 		*image.error() = helCreateVirtualizedSpace(&handle);
 		*image.out0() = handle;
 	} break;
+	case kHelCallQueryMemoryStats: {
+		*image.error() = helQueryMemoryStats((HelHandle)arg0, (HelMemoryStats *)arg1);
+	} break;
 	case kHelCallCreateVirtualizedCpu: {
 		HelHandle handle;
 		*image.error() = helCreateVirtualizedCpu((HelHandle)arg0, &handle);
@@ -788,6 +792,13 @@ void handleSyscall(SyscallImageAccessor image) {
 	case kHelCallShutdownLane: {
 		*image.error() = helShutdownLane((HelHandle)arg0);
 	} break;
+	case kHelCallCallLane: {
+		*image.error() = helCallLane((HelHandle)arg0, (uint32_t)arg1, (HelLaneMessage *)arg2);
+	} break;
+	case kHelCallReplyAndWait: {
+		*image.error() = helReplyAndWait((HelHandle)arg0, (HelHandle)arg1,
+				(uint32_t)arg2, (HelLaneMessage *)arg3);
+	} break;
 
 	case kHelCallFutexWait: {
 		*image.error() = helFutexWait((int *)arg0, (int)arg1, (int64_t)arg2);
@@ -795,6 +806,14 @@ void handleSyscall(SyscallImageAccessor image) {
 	case kHelCallFutexWake: {
 		*image.error() = helFutexWake((int *)arg0, (unsigned int)arg1);
 	} break;
+	case kHelCallFutexRequeue: {
+		*image.error() = helFutexRequeue((int *)arg0, (int *)arg1, (int)arg2,
+				(unsigned int)arg3, (unsigned int)arg4);
+	} break;
+	case kHelCallFutexWakeOp: {
+		*image.error() = helFutexWakeOp((int *)arg0, (unsigned int)arg1, (int *)arg2,
+				(unsigned int)arg3, (uint32_t)arg4);
+	} break;
 
 	case kHelCallCreateOneshotEvent: {
 		HelHandle handle;
@@ -809,6 +828,12 @@ void handleSyscall(SyscallImageAccessor image) {
 	case kHelCallRaiseEvent: {
 		*image.error() = helRaiseEvent((HelHandle)arg0);
 	} break;
+	case kHelCallCreateMemoryPressureEvent: {
+		HelHandle handle;
+		*image.error() = helCreateMemoryPressureEvent((const uint64_t *)arg0,
+				(size_t)arg1, &handle);
+		*image.out0() = handle;
+	} break;
 	case kHelCallAccessIrq: {
 		HelHandle handle;
 		*image.error() = helAccessIrq((int)arg0, &handle);
@@ -1,30 +1,66 @@
+#include <frg/cmdline.hpp>
 #include <frg/scope_exit.hpp>
+#include <lz-compress.hpp>
 #include <thor-internal/address-space.hpp>
 #include <thor-internal/arch-generic/asid.hpp>
 #include <thor-internal/coroutine.hpp>
+#include <thor-internal/event.hpp>
 #include <thor-internal/fiber.hpp>
 #include <thor-internal/main.hpp>
 #include <thor-internal/memory-view.hpp>
+#include <thor-internal/ostrace.hpp>
 #include <thor-internal/pfn-db.hpp>
 #include <thor-internal/physical.hpp>
 #include <thor-internal/timer.hpp>
 
 namespace thor {
 
+bool wantTransparentLargePages = false;
+
 namespace {
 	constexpr bool logUsage = false;
 	constexpr bool logReclaim = false;
 	constexpr bool logUncaching = false;
+	constexpr bool logCompressedSwap = false;
 
 	// The following flags are debugging options to debug the correctness of various components.
 	constexpr bool tortureUncaching = false;
 	constexpr bool disableUncaching = false;
+	constexpr bool disableCompressedSwap = false;
+
+	// Pages that do not compress below this size are kept in memory.
+	constexpr size_t maxCompressedSize = kPageSize * 3 / 4;
+
+	// Time that allocations wait for the reclaimer before they retry after OOM.
+	constexpr uint64_t oomRetryNs = 10'000'000;
+
+	// Bounds of the readahead window of ManagedSpaces (in pages).
+	// The window starts at the minimum and doubles on each sequential access.
+	// Set from the command line and at runtime through kerncfg.
+	std::atomic<size_t> readaheadMinPages{4};
+	std::atomic<size_t> readaheadMaxPages{512};
+
+	// Number of pages that are present in ManagedSpaces.
+	std::atomic<size_t> numCachePages{0};
+
+	// Free memory needs to recover by this fraction of a threshold to re-arm it.
+	constexpr unsigned int pressureHysteresisShift = 3;
 }
 
 // --------------------------------------------------------
 // Reclaim implementation.
 // --------------------------------------------------------
 
+struct PressureWatcher {
+	smarter::weak_ptr<BitsetEvent> event;
+	// Thresholds in pages.
+	size_t thresholds[maxPressureThresholds];
+	unsigned int numThresholds = 0;
+	// Bits that fire once free memory drops below their threshold.
+	uint32_t armed = 0;
+	frg::default_list_hook<PressureWatcher> hook;
+};
+
 struct MemoryReclaimer {
 	void registerBundle(CacheBundle *bundle) {
 		auto irqLock = frg::guard(&irqMutex());
@@ -130,6 +166,56 @@ struct MemoryReclaimer {
 		}
 	}
 
+	// Like reclaimPages() but does not hand out the pages in a list.
+	// Instead, fn is called on each page while the bundle's lock is held.
+	// This is useful for bundles that need to pin the owners of the pages.
+	// Pages remain registered until they are claimed by claimPage().
+	template<typename F>
+	void reclaimPagesWith(CacheBundle *bundle, F fn) {
+		auto irqLock = frg::guard(&irqMutex());
+		auto lock = frg::guard(&bundle->reclaimMutex_);
+
+		while(!bundle->_reclaimList.empty()) {
+			auto page = bundle->_reclaimList.pop_front();
+			assert(page->flags & CachePage::reclaimRegistered);
+			assert(page->flags & CachePage::reclaimPosted);
+			assert(!(page->flags & CachePage::reclaimInflight));
+
+			page->flags |= CachePage::reclaimInflight;
+			fn(page);
+		}
+	}
+
+	// Unregisters a page that was handed out by reclaimPagesWith().
+	// Returns false if the page was removed from the reclaimer in the meantime.
+	bool claimPage(CachePage *page) {
+		auto *bundle = page->bundle;
+		auto irqLock = frg::guard(&irqMutex());
+		auto lock = frg::guard(&bundle->reclaimMutex_);
+
+		if(!(page->flags & CachePage::reclaimInflight))
+			return false;
+		assert(page->flags & CachePage::reclaimRegistered);
+		page->flags &= ~(CachePage::reclaimRegistered | CachePage::reclaimPosted
+				| CachePage::reclaimInflight);
+		return true;
+	}
+
+	// Called if an allocation fails. Forces at least one rotation of generations and
+	// gives the bundles some time to free the pages that were posted for reclaim.
+	coroutine<void> awaitMemory() {
+		reclaimRequested_.store(true, std::memory_order_relaxed);
+		rotationEvent_.raise();
+		co_await generalTimerEngine()->sleepFor(oomRetryNs);
+	}
+
+	void watchPressure(PressureWatcher *watcher) {
+		auto irqLock = frg::guard(&irqMutex());
+		auto lock = frg::guard(&mutex_);
+
+		watcherList_.push_back(watcher);
+	}
+
 	void runReclaimFiber() {
 		KernelFiber::run([this] {
 			if (disableUncaching)
@@ -138,6 +224,8 @@ struct MemoryReclaimer {
 				auto totalPages = physicalAllocator->numTotalPages();
 				auto usedPages = physicalAllocator->numUsedPages();
 
+				notifyPressure_();
+
 				if(logReclaim) {
 					infoLogger() << "thor: " << (usedPages * kPageSize / 1024)
 							<< " KiB / " << (totalPages * kPageSize / 1024)
@@ -145,9 +233,11 @@ struct MemoryReclaimer {
 				}
 
 				// On memory pressure: rotate generations until pressure drops.
-				if (checkPressure_()) {
+				// If an allocation failed, rotate at least once.
+				bool forced = reclaimRequested_.exchange(false, std::memory_order_relaxed);
+				if (forced || checkPressure_()) {
 					for(unsigned int i = 1; i <= CacheBundle::numGenerations; i++) {
-						if(!checkPressure_())
+						if(!(forced && i == 1) && !checkPressure_())
 							break;
 
 						auto result = rotateGenerations_();
@@ -178,7 +268,8 @@ struct MemoryReclaimer {
 						[&] (async::cancellation_token ct) {
 							return async::transform(
 								rotationEvent_.async_wait_if([&] -> bool {
-									return !shouldRotate_();
+									return !shouldRotate_()
+											&& !reclaimRequested_.load(std::memory_order_relaxed);
 								}, ct),
 								[] (auto) {}
 							);
@@ -255,6 +346,42 @@ private:
 		return tortureUncaching || physicalAllocator->numUsedPages() >= watermark;
 	}
 
+	void notifyPressure_() {
+		auto freePages = physicalAllocator->numFreePages();
+
+		auto irqLock = frg::guard(&irqMutex());
+		auto lock = frg::guard(&mutex_);
+
+		auto it = watcherList_.begin();
+		while(it != watcherList_.end()) {
+			auto watcher = *it;
+			++it;
+
+			auto event = watcher->event.lock();
+			if(!event) {
+				// The event's last handle was closed.
+				watcherList_.erase(watcherList_.iterator_to(watcher));
+				frg::destruct(*kernelAlloc, watcher);
+				continue;
+			}
+
+			uint32_t bits = 0;
+			for(unsigned int i = 0; i < watcher->numThresholds; i++) {
+				auto threshold = watcher->thresholds[i];
+				if(freePages < threshold) {
+					if(watcher->armed & (UINT32_C(1) << i))
+						bits |= UINT32_C(1) << i;
+				}else if(freePages >= threshold + (threshold >> pressureHysteresisShift)) {
+					watcher->armed |= UINT32_C(1) << i;
+				}
+			}
+			if(bits) {
+				watcher->armed &= ~bits;
+				event->trigger(bits);
+			}
+		}
+	}
+
 	frg::ticket_spinlock mutex_;
 
 	// Protected against modification by mutex_.
@@ -267,19 +394,164 @@ private:
 		>
 	> bundleList_;
 
+	// Protected by mutex_.
+	frg::intrusive_list<
+		PressureWatcher,
+		frg::locate_member<
+			PressureWatcher,
+			frg::default_list_hook<PressureWatcher>,
+			&PressureWatcher::hook
+		>
+	> watcherList_;
+
 	// Number of pages bumped since the last generation rotation.
 	std::atomic<size_t> rotationTurnaround_{0};
 
+	// Set by awaitMemory().
+	std::atomic<bool> reclaimRequested_{false};
+
 	async::recurring_event rotationEvent_;
 };
 
 static frg::manual_box<MemoryReclaimer> globalReclaimer;
 
+// --------------------------------------------------------
+// Compressed swap for anonymous memory.
+// --------------------------------------------------------
+
+// Anonymous memory has no backing store that pages could be written back to.
+// Instead, cold pages of CopyOnWriteMemory objects are compressed into the kernel heap.
+// All such pages belong to a single CacheBundle, such that they age in the same
+// generation-based LRU as pages of ManagedSpaces.
+struct CompressedSwap final : CacheBundle {
+	void incrementUses(CachePage *cachePage) override;
+	void decrementUses(CachePage *cachePage) override;
+	void markDirty(CachePage *cachePage) override;
+
+	void runReclaim();
+
+	// The following functions are called with the owner's mutex held.
+
+	// Sets up a page that was just copied into its owner.
+	PfnDescriptor attachPage(CopyOnWriteMemory *owner, CowPage *page, uintptr_t offset);
+	// Called when a page is moved into a CowChain.
+	void detachPage(CowPage *page);
+	// Puts a page (back) into the reclaimer if it is eligible for compression.
+	void requeuePage(CowPage *page);
+	// Called when the page is locked for the first time.
+	void pinPage(CowPage *page);
+
+	// Decompresses a page into newly allocated memory and releases the compressed data.
+	// The page must be in CowState::inProgress; the caller is responsible for the
+	// transition out of CowState::compressed and back.
+	// Returns PhysicalAddr(-1) (and keeps the compressed data) if no memory is available.
+	PhysicalAddr decompressPage(CowPage *page);
+	// Like decompressPage() but waits for the reclaimer and retries on OOM.
+	coroutine<PhysicalAddr> decompressPageOrReclaim(CowPage *page);
+	void dropCompressed(CowPage *page);
+
+	CompressedSwapStats stats() {
+		return {
+			.storedSize = storedSize_.load(std::memory_order_relaxed),
+			.poolSize = poolSize_.load(std::memory_order_relaxed)
+		};
+	}
+
+private:
+	std::atomic<size_t> storedSize_{0};
+	std::atomic<size_t> poolSize_{0};
+};
+
+static frg::manual_box<CompressedSwap> globalCompressedSwap;
+static bool compressedSwapAvailable = false;
+
+size_t getPageCacheSize() {
+	return numCachePages.load(std::memory_order_relaxed) * kPageSize;
+}
+
+Error watchMemoryPressure(smarter::shared_ptr<BitsetEvent> event,
+		frg::span<const uint64_t> thresholds) {
+	if(thresholds.size() > maxPressureThresholds)
+		return Error::illegalArgs;
+
+	auto watcher = frg::construct<PressureWatcher>(*kernelAlloc);
+	watcher->event = event;
+	for(size_t i = 0; i < thresholds.size(); i++)
+		watcher->thresholds[i] = (thresholds[i] + kPageSize - 1) >> kPageShift;
+	watcher->numThresholds = thresholds.size();
+	// All thresholds start armed, i.e., they fire even if we are already under pressure.
+	watcher->armed = (thresholds.size() == 32) ? ~UINT32_C(0)
+			: (UINT32_C(1) << thresholds.size()) - 1;
+	globalReclaimer->watchPressure(watcher);
+	return Error::success;
+}
+
+CompressedSwapStats getCompressedSwapStats() {
+	if(!compressedSwapAvailable)
+		return {.storedSize = 0, .poolSize = 0};
+	return globalCompressedSwap->stats();
+}
+
 static initgraph::Task initReclaim{&globalInitEngine, "generic.init-reclaim",
 	initgraph::Requires{getFibersAvailableStage()},
 	[] {
 		globalReclaimer.initialize();
 		globalReclaimer->runReclaimFiber();
+
+		if(!disableCompressedSwap) {
+			globalCompressedSwap.initialize();
+			globalReclaimer->registerBundle(globalCompressedSwap.get());
+			globalCompressedSwap->runReclaim();
+			compressedSwapAvailable = true;
+		}
+	}
+};
+
+static initgraph::Task initLargePages{&globalInitEngine, "generic.init-large-pages",
+	initgraph::Entails{getTaskingAvailableStage()},
+	[] {
+		frg::array args = {
+			frg::option{"thp", frg::store_true(wantTransparentLargePages)},
+		};
+		frg::parse_arguments(getKernelCmdline(), args);
+
+		infoLogger() << "thor: Transparent large pages are "
+				<< (wantTransparentLargePages ? "enabled" : "disabled") << frg::endlog;
+	}
+};
+
+ReadaheadBounds getReadaheadBounds() {
+	return {
+		.minSize = readaheadMinPages.load(std::memory_order_relaxed) << kPageShift,
+		.maxSize = readaheadMaxPages.load(std::memory_order_relaxed) << kPageShift
+	};
+}
+
+void setReadaheadBounds(size_t minSize, size_t maxSize) {
+	auto minPages = frg::max(minSize >> kPageShift, size_t{1});
+	auto maxPages = frg::max(maxSize >> kPageShift, minPages);
+	// ManagedSpaces tolerate observing the old value of one bound together with the new other one.
+	readaheadMinPages.store(minPages, std::memory_order_relaxed);
+	readaheadMaxPages.store(maxPages, std::memory_order_relaxed);
+}
+
+static initgraph::Task initReadahead{&globalInitEngine, "generic.init-readahead",
+	initgraph::Entails{getTaskingAvailableStage()},
+	[] {
+		// Both values are given in KiB.
+		auto bounds = getReadaheadBounds();
+		size_t minKib = bounds.minSize / 1024;
+		size_t maxKib = bounds.maxSize / 1024;
+		frg::array args = {
+			frg::option{"readahead.min", frg::as_number(minKib)},
+			frg::option{"readahead.max", frg::as_number(maxKib)},
+		};
+		frg::parse_arguments(getKernelCmdline(), args);
+		setReadaheadBounds(minKib * 1024, maxKib * 1024);
+
+		bounds = getReadaheadBounds();
+		infoLogger() << "thor: Readahead window is between "
+				<< bounds.minSize << " and " << bounds.maxSize << " bytes" << frg::endlog;
 	}
 };
 
@@ -293,6 +565,10 @@ coroutine<frg::expected<Error>> MemoryView::resize(size_t newSize) {
 	co_return Error::illegalObject;
 }
 
+bool MemoryView::isFileBacked() {
+	return false;
+}
+
 coroutine<frg::expected<Error, smarter::shared_ptr<MemoryView>>> MemoryView::fork() {
 	assert(currentIpl() == ipl::exceptionalWork);
 	co_return Error::illegalObject;
@@ -519,13 +795,25 @@ private:
 
 }
 
-smarter::shared_ptr<MemoryView> getZeroMemory() {
+namespace {
+
+frg::eternal<smarter::shared_ptr<ZeroMemory>> &zeroMemorySingleton() {
 	static frg::eternal<smarter::shared_ptr<ZeroMemory>> singleton = [] {
 		auto memory = smarter::allocate_shared<ZeroMemory>(*kernelAlloc);
 		memory->selfPtr = memory;
 		return memory;
 	}();
-	return singleton.get();
+	return singleton;
+}
+
+}
+
+smarter::shared_ptr<MemoryView> getZeroMemory() {
+	return zeroMemorySingleton().get();
+}
+
+bool isZeroMemory(MemoryView *view) {
+	return view == zeroMemorySingleton().get().get();
 }
 
 // --------------------------------------------------------
@@ -724,9 +1012,10 @@ size_t HardwareMemory::getLength() {
 // --------------------------------------------------------
 
 AllocatedMemory::AllocatedMemory(size_t desiredLngth,
-		int addressBits, size_t desiredChunkSize, size_t chunkAlign)
-: _physicalChunks{*kernelAlloc},
-		_addressBits{addressBits}, _chunkAlign{chunkAlign} {
+		int addressBits, size_t desiredChunkSize, size_t chunkAlign, bool fallbackToSmallPages)
+: _physicalChunks{*kernelAlloc}, _splitChunks{*kernelAlloc},
+		_addressBits{addressBits}, _chunkAlign{chunkAlign},
+		_fallbackToSmallPages{fallbackToSmallPages} {
 	static_assert(sizeof(unsigned long) == sizeof(uint64_t), "Fix use of __builtin_clzl");
 	_chunkSize = size_t(1) << (64 - __builtin_clzl(desiredChunkSize - 1));
 	if(_chunkSize != desiredChunkSize)
@@ -743,6 +1032,8 @@ AllocatedMemory::AllocatedMemory(size_t desiredLngth,
 	assert(_chunkAlign % kPageSize == 0);
 	assert(_chunkSize % _chunkAlign == 0);
 	_physicalChunks.resize(length / _chunkSize, PhysicalAddr(-1));
+	if(_fallbackToSmallPages)
+		_splitChunks.resize(length / _chunkSize, nullptr);
 }
 
 AllocatedMemory::~AllocatedMemory() {
@@ -758,6 +1049,18 @@ AllocatedMemory::~AllocatedMemory() {
 			physicalAllocator->free(_physicalChunks[i], _chunkSize);
 		}
 	}
+	for(size_t i = 0; i < _splitChunks.size(); ++i) {
+		if(!_splitChunks[i])
+			continue;
+		for(size_t k = 0; k < _chunkSize / kPageSize; ++k) {
+			auto physical = _splitChunks[i][k];
+			if(physical == PhysicalAddr(-1))
+				continue;
+			globalPfnDb().erase(physical);
+			physicalAllocator->free(physical, kPageSize);
+		}
+		kernelAlloc->free(_splitChunks[i]);
+	}
 	if(logUsage)
 		infoLogger() << "thor:     ("
 				<< (physicalAllocator->numUsedPages() * 4) << " KiB in use)" << frg::endlog;
@@ -774,6 +1077,8 @@ coroutine<frg::expected<Error>> AllocatedMemory::resize(size_t newSize) {
 		size_t num_chunks = newSize / _chunkSize;
 		assert(num_chunks >= _physicalChunks.size());
 		_physicalChunks.resize(num_chunks, PhysicalAddr(-1));
+		if(_fallbackToSmallPages)
+			_splitChunks.resize(num_chunks, nullptr);
 	}
 	co_return {};
 }
@@ -797,9 +1102,19 @@ PhysicalRange AllocatedMemory::peekRange(uintptr_t offset, FetchFlags) {
 	auto disp = offset & (_chunkSize - 1);
 	assert(index < _physicalChunks.size());
 
+	if(_fallbackToSmallPages && _splitChunks[index]) {
+		auto physical = _splitChunks[index][disp / kPageSize];
+		if(physical == PhysicalAddr(-1))
+			return PhysicalRange{.physical = PhysicalAddr(-1), .size = 0, .cachingMode = CachingMode::null};
+		return PhysicalRange{.physical = physical, .size = kPageSize, .cachingMode = CachingMode::null, .isMutable = true};
+	}
+
 	if(_physicalChunks[index] == PhysicalAddr(-1))
 		return PhysicalRange{.physical = PhysicalAddr(-1), .size = 0, .cachingMode = CachingMode::null};
-	return PhysicalRange{.physical = _physicalChunks[index] + disp, .size = kPageSize, .cachingMode = CachingMode::null, .isMutable = true};
+	// For large page backed memory, report the rest of the (physically contiguous) chunk
+	// such that it can be mapped using large pages. Otherwise, keep reporting single pages.
+	size_t size = _fallbackToSmallPages ? _chunkSize - disp : kPageSize;
+	return PhysicalRange{.physical = _physicalChunks[index] + disp, .size = size, .cachingMode = CachingMode::null, .isMutable = true};
 }
 
 coroutine<frg::expected<Error, size_t>>
@@ -813,8 +1128,40 @@ AllocatedMemory::touchRange(uintptr_t offset, size_t, FetchFlags) {
 	auto disp = offset & (_chunkSize - 1);
 	assert(index < _physicalChunks.size());
 
-	if(_physicalChunks[index] == PhysicalAddr(-1)) {
+	if(_fallbackToSmallPages && _splitChunks[index]) {
+		auto &physical = _splitChunks[index][disp / kPageSize];
+		if(physical == PhysicalAddr(-1)) {
+			physical = physicalAllocator->allocateZeroed(_addressBits);
+			assert(physical != PhysicalAddr(-1) && "OOM");
+			globalPfnDb().insert(physical, PfnDescriptor::otherPage());
+		}
+		co_return kPageSize;
+	}
+
+	// Single page chunks can be taken from the pool of pre-zeroed pages.
+	if(_physicalChunks[index] == PhysicalAddr(-1)
+			&& _chunkSize == kPageSize && _chunkAlign <= kPageSize) {
+		auto physical = physicalAllocator->allocateZeroed(_addressBits);
+		assert(physical != PhysicalAddr(-1) && "OOM");
+		globalPfnDb().insert(physical, PfnDescriptor::otherPage());
+		_physicalChunks[index] = physical;
+	}else if(_physicalChunks[index] == PhysicalAddr(-1)) {
 		auto physical = physicalAllocator->allocate(_chunkSize, _addressBits);
+		if(physical == PhysicalAddr(-1) && _fallbackToSmallPages) {
+			// No contiguous chunk is available. Back this chunk by small pages.
+			auto numPages = _chunkSize / kPageSize;
+			auto pages = static_cast<PhysicalAddr *>(
+					kernelAlloc->allocate(numPages * sizeof(PhysicalAddr)));
+			for(size_t k = 0; k < numPages; ++k)
+				pages[k] = PhysicalAddr(-1);
+			_splitChunks[index] = pages;
+
+			auto &physical = pages[disp / kPageSize];
+			physical = physicalAllocator->allocateZeroed(_addressBits);
+			assert(physical != PhysicalAddr(-1) && "OOM");
+			globalPfnDb().insert(physical, PfnDescriptor::otherPage());
+			co_return kPageSize;
+		}
 		assert(physical != PhysicalAddr(-1) && "OOM");
 		assert(!(physical & (_chunkAlign - 1)));
 
@@ -921,6 +1268,7 @@ ManagedSpace::ManagedSpace(size_t length, bool readahead)
 
 				globalPfnDb().erase(physical);
 				physicalAllocator->free(physical, kPageSize);
+				numCachePages.fetch_sub(1, std::memory_order_relaxed);
 				if(invalidateMonitor)
 					invalidateMonitor->event.raise();
 				sizeFreed += kPageSize;
@@ -994,11 +1342,13 @@ ManagedSpace::~ManagedSpace() {
 Error ManagedSpace::lockPages(uintptr_t offset, size_t size) {
 	auto irq_lock = frg::guard(&irqMutex());
 	auto lock = frg::guard(&mutex);
-	if((offset + size) / kPageSize > numPages)
+	// Lock all pages that overlap the range, including a partial last page.
+	size_t firstIndex = offset / kPageSize;
+	size_t endIndex = (offset + size + kPageSize - 1) / kPageSize;
+	if(endIndex > numPages)
 		return Error::bufferTooSmall;
 
-	for(size_t pg = 0; pg < size; pg += kPageSize) {
-		size_t index = (offset + pg) / kPageSize;
+	for(size_t index = firstIndex; index < endIndex; index++) {
 		auto [pit, wasInserted] = pages.find_or_insert(index, this, index);
 		assert(pit);
 		pit->lockCount++;
@@ -1018,10 +1368,11 @@ Error ManagedSpace::lockPages(uintptr_t offset, size_t size) {
 void ManagedSpace::unlockPages(uintptr_t offset, size_t size) {
 	auto irq_lock = frg::guard(&irqMutex());
 	auto lock = frg::guard(&mutex);
-	assert((offset + size) / kPageSize <= numPages);
+	size_t firstIndex = offset / kPageSize;
+	size_t endIndex = (offset + size + kPageSize - 1) / kPageSize;
+	assert(endIndex <= numPages);
 
-	for(size_t pg = 0; pg < size; pg += kPageSize) {
-		size_t index = (offset + pg) / kPageSize;
+	for(size_t index = firstIndex; index < endIndex; index++) {
 		auto pit = pages.find(index);
 		assert(pit);
 		assert(pit->lockCount > 0);
@@ -1108,6 +1459,67 @@ void ManagedSpace::_progressManagement(ManageList &pending) {
 	}
 }
 
+void ManagedSpace::_updateReadahead(size_t index, bool missing) {
+	bool sequential = (index == _raNextIndex);
+	_raNextIndex = index + 1;
+
+	auto minPages = readaheadMinPages.load(std::memory_order_relaxed);
+	auto maxPages = readaheadMaxPages.load(std::memory_order_relaxed);
+
+	auto growWindow = [&] {
+		_raWindow = frg::min(frg::max(_raWindow * 2, minPages), maxPages);
+	};
+
+	if(missing) {
+		// Faulting on the end of the previous window means that the stream
+		// outran our asynchronous readahead.
+		if(sequential || (_raWindow && index == _raEnd)) {
+			growWindow();
+		}else{
+			if(_raWindow > minPages)
+				ostrace::emit(ostEvtManagedReadaheadCollapse,
+						ostAttrOffset(index << kPageShift));
+			_raWindow = minPages;
+		}
+
+		auto count = frg::min(_raWindow, numPages - index);
+		_queueInitialization(index, count);
+		_raEnd = index + count;
+		// Start asynchronous readahead once the stream is halfway through the window.
+		_raMarker = (count > 1) ? index + count / 2 : _raEnd;
+
+		ostrace::emit(ostEvtManagedReadahead,
+				ostAttrOffset(index << kPageShift), ostAttrSize(count << kPageShift));
+	}else if(index == _raMarker) {
+		// The stream is sequential; fetch the next window before it is needed.
+		growWindow();
+		_raMarker = ~size_t(0);
+		if(_raEnd >= numPages)
+			return;
+
+		auto count = frg::min(_raWindow, numPages - _raEnd);
+		_queueInitialization(_raEnd, count);
+		// Continue once the stream enters the new window.
+		_raMarker = _raEnd;
+		_raEnd += count;
+
+		ostrace::emit(ostEvtManagedReadahead,
+				ostAttrOffset(_raMarker << kPageShift), ostAttrSize(count << kPageShift));
+	}
+}
+
+void ManagedSpace::_queueInitialization(size_t index, size_t count) {
+	for(size_t i = 0; i < count; ++i) {
+		auto [pit, wasInserted] = pages.find_or_insert(index + i, this, index + i);
+		assert(pit);
+		if(pit->loadState == LoadState::missing
+				&& pit->transactionState == TxState::none) {
+			pit->transactionState = TxState::wantInitialization;
+			_initializationList.push_back(&pit->cachePage);
+			pit->monitor = frg::allocate_intrusive_shared<TransactionMonitor>(Allocator{});
+		}
+	}
+}
 
 void ManagedSpace::incrementUses(CachePage *cachePage) {
 	auto irqLock = frg::guard(&irqMutex());
@@ -1254,6 +1666,7 @@ BackingMemory::touchRange(uintptr_t offset, size_t, FetchFlags) {
 
 		globalPfnDb().insert(physical, PfnDescriptor::cachePage(&pit->cachePage));
 		pit->physical = physical;
+		numCachePages.fetch_add(1, std::memory_order_relaxed);
 	}
 
 	co_return kPageSize - misalign;
@@ -1489,6 +1902,7 @@ coroutine<frg::expected<Error>> BackingMemory::invalidateRange(uintptr_t offset,
 			if(physical != PhysicalAddr(-1)) {
 				globalPfnDb().erase(physical);
 				physicalAllocator->free(physical, kPageSize);
+				numCachePages.fetch_sub(1, std::memory_order_relaxed);
 			}
 			if(physical != PhysicalAddr(-1))
 				pg += kPageSize;
@@ -1570,43 +1984,30 @@ FrontalMemory::touchRange(uintptr_t offset, size_t, FetchFlags flags) {
 				pit->transactionState = ManagedSpace::TxState::avertReclaim;
 			}
 
-			co_return kPageSize - misalign;
+			// Hitting the readahead marker triggers asynchronous readahead.
+			if(_managed->readahead) {
+				_managed->_updateReadahead(index, false);
+				_managed->_progressManagement(pendingManagement);
+			}
 		}else{
 			assert(pit->loadState == ManagedSpace::LoadState::missing);
-		}
-
-		if(flags & fetchDisallowBacking) {
-			urgentLogger() << "thor: Backing of page is disallowed" << frg::endlog;
-			co_return Error::fault;
-		}
 
-		// We have to take the slow-path, i.e., perform the fetch asynchronously.
-		if(pit->loadState == ManagedSpace::LoadState::missing
-				&& pit->transactionState == ManagedSpace::TxState::none) {
-			pit->transactionState = ManagedSpace::TxState::wantInitialization;
-			_managed->_initializationList.push_back(&pit->cachePage);
-			pit->monitor = frg::allocate_intrusive_shared<ManagedSpace::TransactionMonitor>(Allocator{});
-		}
+			if(flags & fetchDisallowBacking) {
+				urgentLogger() << "thor: Backing of page is disallowed" << frg::endlog;
+				co_return Error::fault;
+			}
 
-		// Perform readahead.
-		if(_managed->readahead)
-			for(size_t i = 1; i < 4; ++i) {
-				if(!(index + i < _managed->numPages))
-					break;
-				auto [pit, wasInserted] = _managed->pages.find_or_insert(
-						index + i, _managed.get(), index + i);
-				assert(pit);
-				if(pit->loadState == ManagedSpace::LoadState::missing
-						&& pit->transactionState == ManagedSpace::TxState::none) {
-					pit->transactionState = ManagedSpace::TxState::wantInitialization;
-					_managed->_initializationList.push_back(&pit->cachePage);
-					pit->monitor = frg::allocate_intrusive_shared<ManagedSpace::TransactionMonitor>(Allocator{});
-				}
+			// We have to take the slow-path, i.e., perform the fetch asynchronously.
+			if(_managed->readahead) {
+				_managed->_updateReadahead(index, true);
+			}else{
+				_managed->_queueInitialization(index, 1);
 			}
 
-		_managed->_progressManagement(pendingManagement);
+			_managed->_progressManagement(pendingManagement);
 
-		fetchMonitor = pit->monitor;
+			fetchMonitor = pit->monitor;
+		}
 	}
 
 	while(!pendingManagement.empty()) {
@@ -1614,7 +2015,8 @@ FrontalMemory::touchRange(uintptr_t offset, size_t, FetchFlags flags) {
 		node->completionEvent.raise();
 	}
 
-	co_await fetchMonitor->event.wait();
+	if(fetchMonitor)
+		co_await fetchMonitor->event.wait();
 
 	co_return kPageSize - misalign;
 }
@@ -1624,6 +2026,11 @@ size_t FrontalMemory::getLength() {
 	return _managed->numPages << kPageShift;
 }
 
+bool FrontalMemory::isFileBacked() {
+	// Managed memory is used by file systems to implement their page caches.
+	return true;
+}
+
 // --------------------------------------------------------
 // IndirectMemory
 // --------------------------------------------------------
@@ -1697,7 +2104,9 @@ PhysicalRange IndirectMemory::peekRange(uintptr_t offset, FetchFlags flags) {
 	if(indirection->flags & cacheWriteCombine)
 		cachingMode = CachingMode::writeCombine;
 
-	return {.physical = physicalRange.physical, .size = physicalRange.size,
+	// Do not report contiguous memory beyond the end of the slot.
+	return {.physical = physicalRange.physical,
+		.size = frg::min(physicalRange.size, indirection->size - inSlotOffset),
 		.cachingMode = determineCachingMode(physicalRange.cachingMode, cachingMode),
 		.isMutable = physicalRange.isMutable};
 }
@@ -1747,13 +2156,320 @@ Error IndirectMemory::setIndirection(size_t slot, smarter::shared_ptr<MemoryView
 	return Error::success;
 }
 
+// --------------------------------------------------------
+// CompressedSwap
+// --------------------------------------------------------
+
+void CompressedSwap::incrementUses(CachePage *cachePage) {
+	auto page = frg::container_of(cachePage, &CowPage::cachePage);
+
+	// Pages that are detached from their owner are not tracked anymore.
+	auto owner = page->owner.lock();
+	if(!owner) {
+		cachePage->useCount.fetch_add(1, std::memory_order_acquire);
+		return;
+	}
+
+	auto irqLock = frg::guard(&irqMutex());
+	auto lock = frg::guard(&owner->_mutex);
+
+	auto cnt = cachePage->useCount.fetch_add(1, std::memory_order_acquire);
+	if(!cnt) {
+		if(page->swapState == CowSwapState::inReclaimer) {
+			globalReclaimer->removePage(cachePage);
+			page->swapState = CowSwapState::none;
+		}else if(page->swapState == CowSwapState::performReclaim) {
+			page->swapState = CowSwapState::avertReclaim;
+		}
+	}
+}
+
+void CompressedSwap::decrementUses(CachePage *cachePage) {
+	auto page = frg::container_of(cachePage, &CowPage::cachePage);
+
+	auto owner = page->owner.lock();
+	if(!owner) {
+		auto cnt = cachePage->useCount.fetch_sub(1, std::memory_order_release);
+		assert(cnt > 0);
+		return;
+	}
+
+	auto irqLock = frg::guard(&irqMutex());
+	auto lock = frg::guard(&owner->_mutex);
+
+	auto cnt = cachePage->useCount.fetch_sub(1, std::memory_order_release);
+	assert(cnt > 0);
+	if(cnt == 1)
+		requeuePage(page);
+}
+
+void CompressedSwap::markDirty(CachePage *cachePage) {
+	auto page = frg::container_of(cachePage, &CowPage::cachePage);
+
+	auto owner = page->owner.lock();
+	if(!owner)
+		return;
+
+	auto irqLock = frg::guard(&irqMutex());
+	auto lock = frg::guard(&owner->_mutex);
+
+	// The contents changed, hence compression might succeed now.
+	page->incompressible = false;
+}
+
+PfnDescriptor CompressedSwap::attachPage(CopyOnWriteMemory *owner, CowPage *page,
+		uintptr_t offset) {
+	page->owner = owner->selfPtr.lock();
+	page->cachePage.bundle = this;
+	page->cachePage.identity = offset >> kPageShift;
+	return PfnDescriptor::cachePage(&page->cachePage);
+}
+
+void CompressedSwap::detachPage(CowPage *page) {
+	assert(page->state == CowState::hasCopy);
+
+	if(page->swapState == CowSwapState::inReclaimer)
+		globalReclaimer->removePage(&page->cachePage);
+	page->swapState = CowSwapState::detached;
+	page->owner = {};
+
+	// PTEs that still refer to the page are revoked by the caller.
+	// Later mappings must not call into the owner anymore.
+	if(page->cachePage.bundle) {
+		globalPfnDb().insertOrExchange(page->physical,
+				[] (frg::optional<PfnDescriptor>) -> PfnDescriptor {
+			return PfnDescriptor::otherPage();
+		});
+	}
+}
+
+void CompressedSwap::requeuePage(CowPage *page) {
+	if(page->state != CowState::hasCopy
+			|| page->swapState != CowSwapState::none
+			|| !page->cachePage.bundle
+			|| page->lockCount
+			|| page->incompressible
+			|| page->cachePage.useCount.load(std::memory_order_relaxed))
+		return;
+	globalReclaimer->addPage(&page->cachePage);
+	page->swapState = CowSwapState::inReclaimer;
+}
+
+void CompressedSwap::pinPage(CowPage *page) {
+	if(page->swapState == CowSwapState::inReclaimer) {
+		globalReclaimer->removePage(&page->cachePage);
+		page->swapState = CowSwapState::none;
+	}else if(page->swapState == CowSwapState::performReclaim) {
+		page->swapState = CowSwapState::avertReclaim;
+	}
+}
+
+PhysicalAddr CompressedSwap::decompressPage(CowPage *page) {
+	assert(page->compressedData);
+
+	auto physical = physicalAllocator->allocate(kPageSize);
+	if(physical == PhysicalAddr(-1))
+		return PhysicalAddr(-1);
+	PageAccessor accessor{physical};
+	if(!common::lzDecompress(page->compressedData, page->compressedSize, accessor.get(), kPageSize))
+		panicLogger() << "thor: Compressed swap data is corrupted" << frg::endlog;
+
+	dropCompressed(page);
+	return physical;
+}
+
+coroutine<PhysicalAddr> CompressedSwap::decompressPageOrReclaim(CowPage *page) {
+	// Each attempt rotates at least one generation, hence this eventually drains all of them.
+	for(unsigned int i = 0; i < CacheBundle::numGenerations; i++) {
+		auto physical = decompressPage(page);
+		if(physical != PhysicalAddr(-1))
+			co_return physical;
+		co_await globalReclaimer->awaitMemory();
+	}
+	co_return decompressPage(page);
+}
+
+void CompressedSwap::dropCompressed(CowPage *page) {
+	assert(page->compressedData);
+
+	storedSize_.fetch_sub(kPageSize, std::memory_order_relaxed);
+	poolSize_.fetch_sub(page->compressedSize, std::memory_order_relaxed);
+	kernelAlloc->free(page->compressedData);
+	page->compressedData = nullptr;
+	page->compressedSize = 0;
+}
+
+void CompressedSwap::runReclaim() {
+	[] (CompressedSwap *self, enable_detached_coroutine) -> void {
+		// Only this coroutine compresses pages, hence the scratch space can be shared.
+		auto workspace = frg::construct<common::LzWorkspace>(*kernelAlloc);
+		auto buffer = kernelAlloc->allocate(maxCompressedSize);
+
+		while(true) {
+			co_await globalReclaimer->awaitReclaim(self);
+
+			// Pages can only be accessed with their owner's mutex held.
+			// Since owners can go away concurrently, we first pin all owners
+			// and look up the pages by their identity afterwards.
+			struct Candidate {
+				smarter::shared_ptr<CopyOnWriteMemory> owner;
+				uint64_t identity;
+			};
+			frg::vector<Candidate, KernelAlloc> candidates{*kernelAlloc};
+			globalReclaimer->reclaimPagesWith(self, [&] (CachePage *cachePage) {
+				auto page = frg::container_of(cachePage, &CowPage::cachePage);
+				// If this fails, the owner is being destructed and it removes the page itself.
+				auto owner = page->owner.lock();
+				if(!owner)
+					return;
+				candidates.push(Candidate{std::move(owner), cachePage->identity});
+			});
+
+			struct Victim {
+				smarter::shared_ptr<CopyOnWriteMemory> owner;
+				smarter::shared_ptr<CowPage> page;
+			};
+			frg::vector<Victim, KernelAlloc> victims{*kernelAlloc};
+			for(auto &candidate : candidates) {
+				auto owner = candidate.owner.get();
+				auto irqLock = frg::guard(&irqMutex());
+				auto lock = frg::guard(&owner->_mutex);
+
+				auto it = owner->_ownedPages.find(candidate.identity);
+				if(!it)
+					continue;
+				auto page = *it;
+				if(page->swapState != CowSwapState::inReclaimer)
+					continue;
+				if(!globalReclaimer->claimPage(&page->cachePage))
+					continue;
+				assert(page->state == CowState::hasCopy);
+				assert(!page->lockCount);
+				page->swapState = CowSwapState::performReclaim;
+				victims.push(Victim{candidate.owner, std::move(page)});
+			}
+			candidates.clear();
+
+			if(victims.empty())
+				continue;
+
+			CopyOnWriteMemory *lastFenced = nullptr;
+			for(auto &victim : victims) {
+				if(victim.owner.get() == lastFenced)
+					continue;
+				co_await victim.owner->_evictQueue.fenceEphemeral();
+				lastFenced = victim.owner.get();
+			}
+
+			size_t numCompressed = 0;
+			for(auto &victim : victims) {
+				auto owner = victim.owner.get();
+				auto page = victim.page.get();
+
+				PhysicalAddr physical;
+				{
+					auto irqLock = frg::guard(&irqMutex());
+					auto lock = frg::guard(&owner->_mutex);
+
+					if(page->swapState != CowSwapState::performReclaim) {
+						assert(page->swapState == CowSwapState::avertReclaim
+								|| page->swapState == CowSwapState::detached);
+						if(page->swapState == CowSwapState::avertReclaim) {
+							page->swapState = CowSwapState::none;
+							self->requeuePage(page);
+						}
+						continue;
+					}
+					physical = page->physical;
+				}
+
+				// The page is neither mapped nor locked. Any attempt to change that
+				// averts reclaim, hence it is safe to compress without holding the lock.
+				size_t size;
+				{
+					PageAccessor accessor{physical};
+					size = common::lzCompress(accessor.get(), kPageSize,
+							buffer, maxCompressedSize, workspace);
+				}
+				void *data = nullptr;
+				if(size) {
+					data = kernelAlloc->allocate(size);
+					memcpy(data, buffer, size);
+				}
+
+				bool committed = false;
+				{
+					auto irqLock = frg::guard(&irqMutex());
+					auto lock = frg::guard(&owner->_mutex);
+
+					if(page->swapState == CowSwapState::performReclaim) {
+						if(data) {
+							page->state = CowState::compressed;
+							page->physical = PhysicalAddr(-1);
+							page->compressedData = data;
+							page->compressedSize = size;
+							committed = true;
+						}else{
+							page->incompressible = true;
+						}
+						page->swapState = CowSwapState::none;
+					}else if(page->swapState == CowSwapState::avertReclaim) {
+						page->swapState = CowSwapState::none;
+						self->requeuePage(page);
+					}else{
+						assert(page->swapState == CowSwapState::detached);
+					}
+				}
+
+				if(!committed) {
+					if(data)
+						kernelAlloc->free(data);
+					continue;
+				}
+
+				self->storedSize_.fetch_add(kPageSize, std::memory_order_relaxed);
+				self->poolSize_.fetch_add(size, std::memory_order_relaxed);
+				globalPfnDb().erase(physical);
+				physicalAllocator->free(physical, kPageSize);
+				numCompressed++;
+			}
+			victims.clear();
+
+			auto stats = self->stats();
+			if(numCompressed)
+				ostrace::emit(ostEvtCompressedSwap,
+						ostAttrSize(stats.storedSize),
+						ostAttrPoolSize(stats.poolSize));
+			if(logCompressedSwap)
+				infoLogger() << frg::fmt(
+					"thor: Compressed 0x{:x} bytes, pool stores 0x{:x} bytes in 0x{:x} bytes",
+					numCompressed * kPageSize,
+					stats.storedSize,
+					stats.poolSize
+				) << frg::endlog;
+		}
+	}(this, enable_detached_coroutine{WorkQueue::generalQueue().lock()});
+}
+
 // --------------------------------------------------------
 // CopyOnWriteMemory
 // --------------------------------------------------------
 
 CowPage::~CowPage() {
+	// Owners are only destructed once they are not mapped anymore.
+	// Hence, we only race with the compressed swap's reclaim coroutine
+	// (which does not touch pages of owners that are being destructed).
+	if(swapState == CowSwapState::inReclaimer)
+		globalReclaimer->removePage(&cachePage);
+	assert(swapState != CowSwapState::performReclaim);
+	assert(swapState != CowSwapState::avertReclaim);
+
 	if(state == CowState::null)
 		return;
+	if(state == CowState::compressed) {
+		globalCompressedSwap->dropCompressed(this);
+		return;
+	}
 	assert(state == CowState::hasCopy);
 	assert(physical != PhysicalAddr(-1));
 	globalPfnDb().erase(physical);
@@ -1778,6 +2494,12 @@ size_t CopyOnWriteMemory::getLength() {
 	return _length;
 }
 
+bool CopyOnWriteMemory::isFileBacked() {
+	// Private file mappings (e.g., of executables) are CoW views of the page cache.
+	// CoW views of anonymous memory are not considered to be file-backed.
+	return _view->isFileBacked();
+}
+
 coroutine<frg::expected<Error, smarter::shared_ptr<MemoryView>>> CopyOnWriteMemory::fork() {
 	assert(currentIpl() == ipl::exceptionalWork);
 
@@ -1787,6 +2509,7 @@ coroutine<frg::expected<Error, smarter::shared_ptr<MemoryView>>> CopyOnWriteMemo
 	smarter::shared_ptr<CopyOnWriteMemory> forked;
 	smarter::shared_ptr<CowChain> newChain;
 	frg::vector<frg::tuple<size_t, smarter::shared_ptr<CowPage>>, KernelAlloc> inProgressPages{*kernelAlloc};
+	frg::vector<frg::tuple<size_t, smarter::shared_ptr<CowPage>>, KernelAlloc> compressedPages{*kernelAlloc};
 
 	auto doCopyOnePage = [&] (size_t pg, smarter::borrowed_ptr<CowPage> page) {
 		// The page is locked. We *need* to keep it in the old address space.
@@ -1811,6 +2534,9 @@ coroutine<frg::expected<Error, smarter::shared_ptr<MemoryView>>> CopyOnWriteMemo
 			auto physical = page->physical;
 			assert(physical != PhysicalAddr(-1));
 
+			if(compressedSwapAvailable)
+				globalCompressedSwap->detachPage(page.get());
+
 			// Update the chains.
 			auto pageOffset = _viewOffset + pg;
 			auto newIt = newChain->_pages.insert(pageOffset >> kPageShift);
@@ -1858,6 +2584,14 @@ coroutine<frg::expected<Error, smarter::shared_ptr<MemoryView>>> CopyOnWriteMemo
 			}
 
 			auto page = *it;
+			if(page->state == CowState::compressed) {
+				// Pages in CowChains are never compressed; thus, decompress the page below.
+				// Decompression may need to wait for memory, so we cannot do it here.
+				page->state = CowState::inProgress;
+				compressedPages.push(frg::make_tuple(pg, page));
+				continue;
+			}
+
 			if(page->state == CowState::null) {
 				continue;
 			}else if(page->state == CowState::inProgress) {
@@ -1874,6 +2608,28 @@ coroutine<frg::expected<Error, smarter::shared_ptr<MemoryView>>> CopyOnWriteMemo
 		}
 	}
 
+	// If decompression fails, the page stays in the original mapping and the fork fails.
+	bool outOfMemory = false;
+	for(auto [pg, page] : compressedPages) {
+		auto physical = co_await globalCompressedSwap->decompressPageOrReclaim(page.get());
+		{
+			auto irqLock = frg::guard(&irqMutex());
+			auto lock = frg::guard(&_mutex);
+
+			assert(page->state == CowState::inProgress);
+			if(physical == PhysicalAddr(-1)) {
+				page->state = CowState::compressed;
+				outOfMemory = true;
+			}else{
+				page->state = CowState::hasCopy;
+				page->physical = physical;
+				globalPfnDb().insert(physical, PfnDescriptor::cachePage(&page->cachePage));
+				inProgressPages.push(frg::make_tuple(pg, page));
+			}
+		}
+		_copyEvent.raise();
+	}
+
 	// Wait for the in progress pages to complete copying.
 	bool stillWaiting = inProgressPages.size() > 0;
 	while (stillWaiting) {
@@ -1895,13 +2651,21 @@ coroutine<frg::expected<Error, smarter::shared_ptr<MemoryView>>> CopyOnWriteMemo
 		auto lock = frg::guard(&_mutex);
 
 		// Copy all the previously in progress pages now that they're done copying.
+		// Pages that went back to the compressed swap could not be decompressed.
 		for (auto [pg, page] : inProgressPages) {
+			if(page->state == CowState::compressed) {
+				outOfMemory = true;
+				continue;
+			}
 			assert(page->state == CowState::hasCopy);
 			doCopyOnePage(pg, page);
 		}
 	}
 
+	// Pages were moved to the new chain even if the fork fails; they must not stay writable.
 	co_await _evictQueue.breakRange(0, _length);
+	if(outOfMemory)
+		co_return Error::noMemory;
 	co_return smarter::shared_ptr<MemoryView>{std::move(forked)};
 }
 
@@ -1909,15 +2673,18 @@ Error CopyOnWriteMemory::lockRange(uintptr_t offset, size_t size) {
 	auto irqLock = frg::guard(&irqMutex());
 	auto lock = frg::guard(&_mutex);
 
-	for(size_t pg = 0; pg < size; pg += kPageSize) {
-		auto it = _ownedPages.find((offset + pg) >> kPageShift);
+	// Lock all pages that overlap the range, including a partial last page.
+	auto endIndex = (offset + size + kPageSize - 1) >> kPageShift;
+	for(auto index = offset >> kPageShift; index < endIndex; index++) {
+		auto it = _ownedPages.find(index);
 		if(it) {
 			auto page = *it;
-			page->lockCount++;
+			if(!page->lockCount++ && compressedSwapAvailable)
+				globalCompressedSwap->pinPage(page.get());
 		}else{
 			auto cowPage = smarter::allocate_shared<CowPage>(*kernelAlloc);
 			cowPage->lockCount = 1;
-			it = _ownedPages.insert((offset + pg) >> kPageShift);
+			it = _ownedPages.insert(index);
 			*it = cowPage;
 		}
 	}
@@ -1929,12 +2696,14 @@ void CopyOnWriteMemory::unlockRange(uintptr_t offset, size_t size) {
 	auto irqLock = frg::guard(&irqMutex());
 	auto lock = frg::guard(&_mutex);
 
-	for(size_t pg = 0; pg < size; pg += kPageSize) {
-		auto it = _ownedPages.find((offset + pg) >> kPageShift);
+	auto endIndex = (offset + size + kPageSize - 1) >> kPageShift;
+	for(auto index = offset >> kPageShift; index < endIndex; index++) {
+		auto it = _ownedPages.find(index);
 		assert(it);
 		auto page = *it;
 		assert(page->lockCount > 0);
-		page->lockCount--;
+		if(!--page->lockCount && compressedSwapAvailable)
+			globalCompressedSwap->requeuePage(page.get());
 	}
 }
 
@@ -1980,6 +2749,8 @@ PhysicalRange CopyOnWriteMemory::peekRange(uintptr_t offset, FetchFlags flags) {
 
 		auto range = view->peekRange(pageOffset, flags);
 		// Note: passthrough caching mode etc. but clamp the size to kPageSize.
+		//       Since copies are made page by page, CoW memory is never mapped
+		//       using large pages, even if the underlying view is large page backed.
 		if(range.physical != PhysicalAddr(-1))
 			return PhysicalRange{.physical = range.physical, .size = kPageSize, .cachingMode = range.cachingMode, .isMutable = false};
 	}
@@ -2002,6 +2773,7 @@ CopyOnWriteMemory::touchRange(uintptr_t offset, size_t sizeHint, FetchFlags flag
 	//       callers expect touchRange() to make the page available to peekRange().
 	bool passthrough = false;
 	bool waitForCopy = false;
+	bool decompress = false;
 	{
 		// If the page is present in our private chain, we just return it.
 		auto irqLock = frg::guard(&irqMutex());
@@ -2015,6 +2787,9 @@ CopyOnWriteMemory::touchRange(uintptr_t offset, size_t sizeHint, FetchFlags flag
 				co_return kPageSize - misalign;
 			}else if(cowPage->state == CowState::inProgress) {
 				waitForCopy = true;
+			}else if(cowPage->state == CowState::compressed) {
+				cowPage->state = CowState::inProgress;
+				decompress = true;
 			}else{
 				assert(cowPage->state == CowState::null);
 				cowPage->state = CowState::inProgress;
@@ -2064,15 +2839,57 @@ CopyOnWriteMemory::touchRange(uintptr_t offset, size_t sizeHint, FetchFlags flag
 
 				if(cowPage->state == CowState::inProgress)
 					return true;
-				assert(cowPage->state == CowState::hasCopy);
 				return false;
 			});
 		} while(stillWaiting);
 
+		// The page goes back to the compressed swap if it cannot be decompressed.
+		bool decompressFailed;
+		{
+			auto irqLock = frg::guard(&irqMutex());
+			auto lock = frg::guard(&_mutex);
+
+			decompressFailed = cowPage->state == CowState::compressed;
+			if(!decompressFailed)
+				assert(cowPage->state == CowState::hasCopy);
+		}
+		if(decompressFailed)
+			co_return Error::noMemory;
+
+		co_return kPageSize - misalign;
+	}
+
+	// The page was compressed while it was not mapped. Hence, there is no need to evict it.
+	if(decompress) {
+		auto physical = co_await globalCompressedSwap->decompressPageOrReclaim(cowPage.get());
+		{
+			auto irqLock = frg::guard(&irqMutex());
+			auto lock = frg::guard(&_mutex);
+
+			assert(cowPage->state == CowState::inProgress);
+			if(physical == PhysicalAddr(-1)) {
+				cowPage->state = CowState::compressed;
+			}else{
+				cowPage->state = CowState::hasCopy;
+				cowPage->physical = physical;
+				globalPfnDb().insert(physical, PfnDescriptor::cachePage(&cowPage->cachePage));
+			}
+		}
+		_copyEvent.raise();
+		if(physical == PhysicalAddr(-1))
+			co_return Error::noMemory;
 		co_return kPageSize - misalign;
 	}
 
-	PhysicalAddr physical = physicalAllocator->allocate(kPageSize);
+	// Copies of the zero memory (i.e., anonymous private mappings) do not need to copy anything.
+	bool copyFromZero = isZeroMemory(view.get());
+
+	PhysicalAddr physical;
+	if(copyFromZero) {
+		physical = physicalAllocator->allocateZeroed();
+	}else{
+		physical = physicalAllocator->allocate(kPageSize);
+	}
 	assert(physical != PhysicalAddr(-1) && "OOM");
 	PageAccessor accessor{physical};
 
@@ -2095,7 +2912,7 @@ CopyOnWriteMemory::touchRange(uintptr_t offset, size_t sizeHint, FetchFlags flag
 	}
 
 	// Copy from the root view.
-	if(!chainHasCopy) {
+	if(!chainHasCopy && !copyFromZero) {
 		FRG_CO_TRY(co_await view->copyFrom(pageOffset & ~(kPageSize - 1),
 				accessor.get(), kPageSize));
 	}
@@ -2110,7 +2927,12 @@ CopyOnWriteMemory::touchRange(uintptr_t offset, size_t sizeHint, FetchFlags flag
 		assert(cowPage->state == CowState::inProgress);
 		cowPage->state = CowState::hasCopy;
 		cowPage->physical = physical;
-		globalPfnDb().insert(physical, PfnDescriptor::otherPage());
+		if(compressedSwapAvailable) {
+			globalPfnDb().insert(physical,
+					globalCompressedSwap->attachPage(this, cowPage.get(), alignedOffset));
+		}else{
+			globalPfnDb().insert(physical, PfnDescriptor::otherPage());
+		}
 	}
 	_copyEvent.raise();
 	co_return kPageSize - misalign;
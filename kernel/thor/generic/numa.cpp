@@ -0,0 +1,173 @@
+#include <frg/manual_box.hpp>
+#include <frg/vector.hpp>
+#include <thor-internal/cpu-data.hpp>
+#include <thor-internal/debug.hpp>
+#include <thor-internal/kernel-heap.hpp>
+#include <thor-internal/main.hpp>
+#include <thor-internal/numa.hpp>
+#include <thor-internal/physical.hpp>
+
+namespace thor {
+
+namespace {
+
+constexpr bool logNuma = false;
+
+struct NumaMemoryRange {
+	PhysicalAddr base;
+	size_t size;
+	int node;
+};
+
+struct NumaCpu {
+	uint64_t hardwareId;
+	int node;
+};
+
+// Maps dense node numbers to firmware proximity domains.
+uint32_t nodeDomains[maxNumaNodes];
+int numNodes = 0;
+
+unsigned int distances[maxNumaNodes][maxNumaNodes];
+bool haveDistances = false;
+
+NumaMemoryRange memoryRanges[maxNumaMemoryRanges];
+int numMemoryRanges = 0;
+
+frg::manual_box<frg::vector<NumaCpu, KernelAlloc>> numaCpus;
+bool haveNumaCpus = false;
+
+int nodeForDomain(uint32_t domain) {
+	for(int i = 0; i < numNodes; ++i) {
+		if(nodeDomains[i] == domain)
+			return i;
+	}
+	if(numNodes == maxNumaNodes) {
+		infoLogger() << "thor: Ignoring NUMA proximity domain " << domain
+				<< " (can only handle " << maxNumaNodes << " nodes)" << frg::endlog;
+		return 0;
+	}
+	nodeDomains[numNodes] = domain;
+	return numNodes++;
+}
+
+uint64_t cpuHardwareId(CpuData *cpu) {
+#if defined(__x86_64__)
+	return cpu->localApicId;
+#elif defined(__aarch64__)
+	return cpu->affinity;
+#elif defined(__riscv)
+	return cpu->hartId;
+#else
+#	error Unknown architecture
+#endif
+}
+
+} // anonymous namespace
+
+initgraph::Stage *getNumaDiscoveredStage() {
+	static initgraph::Stage s{&globalInitEngine, "generic.numa-discovered"};
+	return &s;
+}
+
+void registerNumaMemory(PhysicalAddr base, size_t size, uint32_t domain) {
+	if(numMemoryRanges == maxNumaMemoryRanges) {
+		infoLogger() << "thor: Ignoring NUMA memory range (can only handle "
+				<< maxNumaMemoryRanges << " ranges)" << frg::endlog;
+		return;
+	}
+	memoryRanges[numMemoryRanges++] = {base, size, nodeForDomain(domain)};
+}
+
+void registerNumaCpu(uint64_t hardwareId, uint32_t domain) {
+	if(!haveNumaCpus) {
+		numaCpus.initialize(*kernelAlloc);
+		haveNumaCpus = true;
+	}
+	numaCpus->push_back({hardwareId, nodeForDomain(domain)});
+}
+
+void setNumaDistance(uint32_t fromDomain, uint32_t toDomain, unsigned int distance) {
+	// Distances are only meaningful for domains that own memory or CPUs.
+	// Avoid allocating nodes for domains that we have not seen so far.
+	int from = -1, to = -1;
+	for(int i = 0; i < numNodes; ++i) {
+		if(nodeDomains[i] == fromDomain)
+			from = i;
+		if(nodeDomains[i] == toDomain)
+			to = i;
+	}
+	if(from < 0 || to < 0)
+		return;
+
+	distances[from][to] = distance;
+	haveDistances = true;
+}
+
+int numaNodeCount() {
+	return numNodes ? numNodes : 1;
+}
+
+unsigned int numaDistance(int from, int to) {
+	if(haveDistances && distances[from][to])
+		return distances[from][to];
+	return (from == to) ? numaLocalDistance : numaRemoteDistance;
+}
+
+int numaNodeOfAddress(PhysicalAddr address) {
+	for(int i = 0; i < numMemoryRanges; ++i) {
+		auto &range = memoryRanges[i];
+		if(address >= range.base && address - range.base < range.size)
+			return range.node;
+	}
+	return 0;
+}
+
+PhysicalAddr numaBoundaryAfter(PhysicalAddr address) {
+	auto boundary = static_cast<PhysicalAddr>(-1);
+	for(int i = 0; i < numMemoryRanges; ++i) {
+		auto &range = memoryRanges[i];
+		if(range.base > address && range.base < boundary)
+			boundary = range.base;
+		auto end = range.base + range.size;
+		if(end > address && end < boundary)
+			boundary = end;
+	}
+	return boundary;
+}
+
+int numaNodeOfCpuHardwareId(uint64_t hardwareId) {
+	if(!haveNumaCpus)
+		return 0;
+	for(auto &cpu : *numaCpus) {
+		if(cpu.hardwareId == hardwareId)
+			return cpu.node;
+	}
+	return 0;
+}
+
+// The firmware parsers entail getNumaDiscoveredStage(). Since secondary CPUs are only
+// booted once tasking is available, they can look up their node in bootSecondary().
+static initgraph::Task applyNumaTopologyTask{&globalInitEngine, "generic.apply-numa-topology",
+	initgraph::Requires{getNumaDiscoveredStage()},
+	initgraph::Entails{getTaskingAvailableStage()},
+	[] {
+		auto bsp = getCpuData();
+		bsp->numaNode = numaNodeOfCpuHardwareId(cpuHardwareId(bsp));
+
+		if(numaNodeCount() < 2)
+			return;
+
+		if(logNuma) {
+			infoLogger() << "thor: System has " << numaNodeCount() << " NUMA nodes" << frg::endlog;
+			for(int i = 0; i < numMemoryRanges; ++i)
+				infoLogger() << "thor:     Memory at " << frg::hex_fmt{memoryRanges[i].base}
+						<< ", size: " << frg::hex_fmt{memoryRanges[i].size}
+						<< " is on node " << memoryRanges[i].node << frg::endlog;
+		}
+
+		physicalAllocator->assignNumaNodes();
+	}
+};
+
+} // namespace thor
@@ -284,6 +284,21 @@ void setup() {
 
 	setupTerm(ostEvtArmPreemption);
 	setupTerm(ostEvtArmCpuTimer);
+	setupTerm(ostEvtManagedReadahead);
+	setupTerm(ostEvtManagedReadaheadCollapse);
+	setupTerm(ostEvtShootdown);
+	setupTerm(ostEvtDirectSwitch);
+	setupTerm(ostEvtTimerCoalescing);
+	setupTerm(ostEvtCompressedSwap);
+	setupTerm(ostEvtRcuGracePeriod);
+	setupTerm(ostAttrOffset);
+	setupTerm(ostAttrSize);
+	setupTerm(ostAttrTime);
+	setupTerm(ostAttrAlarms);
+	setupTerm(ostAttrTimers);
+	setupTerm(ostAttrPoolSize);
+	setupTerm(ostAttrExpedited);
+	setupTerm(ostAttrBacklog);
 	available.store(true, std::memory_order_relaxed);
 }
 
@@ -299,5 +314,34 @@ void emitBuffer(frg::span<char> payload) {
 
 ostrace::Event ostEvtArmPreemption{"thor.arm-preemption"};
 ostrace::Event ostEvtArmCpuTimer{"thor.arm-cpu-timer"};
+ostrace::Event ostEvtManagedReadahead{"thor.managed-readahead"};
+ostrace::Event ostEvtManagedReadaheadCollapse{"thor.managed-readahead-collapse"};
+ostrace::Event ostEvtShootdown{"thor.shootdown"};
+ostrace::Event ostEvtDirectSwitch{"thor.direct-switch"};
+// Emitted by each CPU about once per second while timers fire.
+ostrace::Event ostEvtTimerCoalescing{"thor.timer-coalescing"};
+// Emitted after each batch of pages that is compressed by the reclaimer.
+ostrace::Event ostEvtCompressedSwap{"thor.compressed-swap"};
+// Emitted after each RCU grace period.
+ostrace::Event ostEvtRcuGracePeriod{"thor.rcu-grace-period"};
+
+// --------------------------------------------------------------------------------------
+// Kernel ostrace attributes.
+// --------------------------------------------------------------------------------------
+
+ostrace::UintAttribute ostAttrOffset{"offset"};
+ostrace::UintAttribute ostAttrSize{"size"};
+// Duration in nanoseconds.
+ostrace::UintAttribute ostAttrTime{"time"};
+// Number of timer IRQs.
+ostrace::UintAttribute ostAttrAlarms{"alarms"};
+// Number of timers that elapsed.
+ostrace::UintAttribute ostAttrTimers{"timers"};
+// Size of compressed data in bytes.
+ostrace::UintAttribute ostAttrPoolSize{"pool-size"};
+// Whether an operation was expedited (zero or one).
+ostrace::UintAttribute ostAttrExpedited{"expedited"};
+// Number of pending RCU callbacks.
+ostrace::UintAttribute ostAttrBacklog{"backlog"};
 
 } // namespace thor
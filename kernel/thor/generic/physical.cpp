@@ -1,13 +1,52 @@
 #include <assert.h>
+#include <string.h>
 #include <thor-internal/arch-generic/paging.hpp>
 #include <thor-internal/cpu-data.hpp>
 #include <thor-internal/debug.hpp>
+#include <thor-internal/fiber.hpp>
+#include <thor-internal/main.hpp>
+#include <thor-internal/numa.hpp>
 #include <thor-internal/physical.hpp>
+#include <thor-internal/timer.hpp>
 
 namespace thor {
 
 static bool logPhysicalAllocs = false;
 
+extern PerCpu<PhysicalPageCache> physicalPageCache;
+THOR_DEFINE_PERCPU(physicalPageCache);
+
+extern PerCpu<ZeroedPagePool> zeroedPagePool;
+THOR_DEFINE_PERCPU(zeroedPagePool);
+
+namespace {
+	// Priority of the fibers that refill the zeroed page pools.
+	// This is below the priority of all other threads, hence they only run on idle CPUs.
+	constexpr int zeroingPriority = -1000;
+
+	// Interval (in ns) at which the zeroing fibers check whether their pool needs refilling.
+	constexpr uint64_t zeroingInterval = 50'000'000;
+
+	// Zeroes a page without pulling it into the cache.
+	// The page is likely not accessed again until it is handed out.
+	void zeroPageNonTemporal(PhysicalAddr physical) {
+		PageAccessor accessor{physical};
+#if defined(__x86_64__)
+		auto p = reinterpret_cast<uint64_t *>(accessor.get());
+		for(size_t i = 0; i < kPageSize / sizeof(uint64_t); i += 4)
+			asm volatile ("movnti %1, (%0)\n"
+					"\tmovnti %1, 8(%0)\n"
+					"\tmovnti %1, 16(%0)\n"
+					"\tmovnti %1, 24(%0)"
+					: : "r" (p + i), "r" (uint64_t{0}) : "memory");
+		// Non-temporal stores are weakly ordered.
+		asm volatile ("sfence" : : : "memory");
+#else
+		memset(accessor.get(), 0, kPageSize);
+#endif
+	}
+}
+
 THOR_DEFINE_ELF_NOTE(memoryLayoutNote){elf_note_type::memoryLayout, {}};
 
 void poisonPhysicalAccess(PhysicalAddr physical) {
@@ -50,47 +89,227 @@ void PhysicalChunkAllocator::bootstrapRegion(PhysicalAddr address,
 	_freePages.store(currentFree + (numRoots << order), std::memory_order_relaxed);
 }
 
-PhysicalAddr PhysicalChunkAllocator::allocate(size_t size, int addressBits) {
+void PhysicalChunkAllocator::assignNumaNodes() {
 	auto irq_lock = frg::guard(&irqMutex());
 	auto lock = frg::guard(&_mutex);
 
-	auto currentFree = _freePages.load(std::memory_order_relaxed);
-	auto currentUsed = _usedPages.load(std::memory_order_relaxed);
-	assert(currentFree > size / kPageSize);
-	_freePages.store(currentFree - size / kPageSize, std::memory_order_relaxed);
-	_usedPages.store(currentUsed + size / kPageSize, std::memory_order_relaxed);
+	_numNumaSpans = 0;
+	for(int i = 0; i < _numRegions; i++) {
+		auto base = _allRegions[i].physicalBase;
+		auto limit = base + _allRegions[i].regionSize;
+		while(base < limit) {
+			// Memory ranges are usually page aligned; if they are not,
+			// the page that contains the boundary goes to the lower range.
+			auto boundary = numaBoundaryAfter(base);
+			if(boundary < limit)
+				boundary = (boundary + kPageSize - 1) & ~PhysicalAddr(kPageSize - 1);
+			if(boundary > limit)
+				boundary = limit;
 
+			int node = numaNodeOfAddress(base);
+			auto last = _numNumaSpans ? &_numaSpans[_numNumaSpans - 1] : nullptr;
+			if(last && last->region == i && last->node == node) {
+				last->limit = boundary;
+			}else{
+				assert(_numNumaSpans < maxNumaSpans);
+				_numaSpans[_numNumaSpans++] = {i, base, boundary, node};
+			}
+			base = boundary;
+		}
+	}
+	_numaAware.store(numaNodeCount() > 1, std::memory_order_release);
+}
+
+PhysicalAddr PhysicalChunkAllocator::allocate(size_t size, int addressBits) {
 	// TODO: This could be solved better.
 	int target = 0;
 	while(size > (size_t(kPageSize) << target))
 		target++;
 	assert(size == (size_t(kPageSize) << target));
 
+	auto irq_lock = frg::guard(&irqMutex());
+
+	int node = -1;
+	if(_numaAware.load(std::memory_order_acquire))
+		node = getCpuData()->numaNode;
+
+	// Fast path: serve single pages from the per-CPU cache.
+	// We only do this for unconstrained allocations since the cache can contain arbitrary pages.
+	if(!target && addressBits >= 64
+			&& _perCpuCachesEnabled.load(std::memory_order_acquire)) {
+		auto cache = &physicalPageCache.get();
+		auto cacheLock = frg::guard(&cache->mutex);
+
+		if(!cache->numPages)
+			_refillCache(cache, node);
+		if(cache->numPages)
+			return cache->pages[--cache->numPages];
+	}
+
+	auto lock = frg::guard(&_mutex);
+
+	auto physical = _allocateLocked(target, addressBits, node);
+	if(physical != static_cast<PhysicalAddr>(-1))
+		return physical;
+
+	// Pages might still be sitting in the per-CPU caches.
+	if(_perCpuCachesEnabled.load(std::memory_order_acquire)) {
+		lock.unlock();
+		_drainAllCaches();
+		lock.lock();
+		return _allocateLocked(target, addressBits, node);
+	}
+
+	return static_cast<PhysicalAddr>(-1);
+}
+
+void PhysicalChunkAllocator::free(PhysicalAddr address, size_t size) {
+	int target = 0;
+	while(size > (size_t(kPageSize) << target))
+		target++;
+
+	auto irq_lock = frg::guard(&irqMutex());
+
+	// Pages of remote NUMA nodes bypass the cache such that they are not handed out
+	// to local allocations later on.
+	bool cacheable = !target && _perCpuCachesEnabled.load(std::memory_order_acquire);
+	if(cacheable && _numaAware.load(std::memory_order_acquire))
+		cacheable = _numaNodeOf(address) == getCpuData()->numaNode;
+
+	if(cacheable) {
+		auto cache = &physicalPageCache.get();
+		auto cacheLock = frg::guard(&cache->mutex);
+
+		if(cache->numPages >= PhysicalPageCache::highWatermark)
+			_drainCache(cache, PhysicalPageCache::batchSize);
+		assert(cache->numPages < PhysicalPageCache::capacity);
+		cache->pages[cache->numPages++] = address;
+		return;
+	}
+
+	auto lock = frg::guard(&_mutex);
+	_freeLocked(address, target);
+}
+
+PhysicalAddr PhysicalChunkAllocator::allocateZeroed(int addressBits) {
+	// Pages in the pool are not constrained, similar to the per-CPU caches.
+	if(addressBits >= 64 && _perCpuCachesEnabled.load(std::memory_order_acquire)) {
+		auto irqLock = frg::guard(&irqMutex());
+		auto pool = &zeroedPagePool.get();
+		auto poolLock = frg::guard(&pool->mutex);
+
+		if(pool->numPages)
+			return pool->pages[--pool->numPages];
+	}
+
+	auto physical = allocate(kPageSize, addressBits);
+	if(physical == static_cast<PhysicalAddr>(-1))
+		return physical;
+	PageAccessor accessor{physical};
+	memset(accessor.get(), 0, kPageSize);
+	return physical;
+}
+
+bool PhysicalChunkAllocator::refillZeroedPool() {
+	{
+		auto irqLock = frg::guard(&irqMutex());
+		auto pool = &zeroedPagePool.get();
+		auto poolLock = frg::guard(&pool->mutex);
+
+		if(pool->numPages == ZeroedPagePool::capacity)
+			return false;
+	}
+
+	// Do not hold back pages when memory is low.
+	// Since pooled pages count as free, only consider the buddy allocator here.
+	if(_freePages.load(std::memory_order_relaxed) < numTotalPages() / 8)
+		return false;
+
+	auto physical = allocate(kPageSize);
+	if(physical == static_cast<PhysicalAddr>(-1))
+		return false;
+	zeroPageNonTemporal(physical);
+
+	// We might have migrated in the meantime; we can still put the page into this CPU's pool.
+	auto irqLock = frg::guard(&irqMutex());
+	auto pool = &zeroedPagePool.get();
+	auto poolLock = frg::guard(&pool->mutex);
+
+	if(pool->numPages == ZeroedPagePool::capacity) {
+		poolLock.unlock();
+		free(physical, kPageSize);
+		return false;
+	}
+	pool->pages[pool->numPages++] = physical;
+	return true;
+}
+
+PhysicalAddr PhysicalChunkAllocator::_allocateLocked(int target, int addressBits, int node) {
+	auto currentFree = _freePages.load(std::memory_order_relaxed);
+	auto currentUsed = _usedPages.load(std::memory_order_relaxed);
+	if(currentFree <= (size_t(1) << target))
+		return static_cast<PhysicalAddr>(-1);
+
 	if(logPhysicalAllocs)
 		infoLogger() << "thor: Allocating physical memory of order "
 					<< (target + kPageShift) << frg::endlog;
-	for(int i = 0; i < _numRegions; i++) {
+	auto allocateFrom = [&] (int i) -> PhysicalAddr {
 		if(target > _allRegions[i].buddyAccessor.tableOrder())
-			continue;
+			return BuddyAccessor::illegalAddress;
+		return _allRegions[i].buddyAccessor.allocate(target, addressBits);
+	};
 
-		auto physical = _allRegions[i].buddyAccessor.allocate(target, addressBits);
-		if(physical == BuddyAccessor::illegalAddress)
-			continue;
+	PhysicalAddr physical = BuddyAccessor::illegalAddress;
+	if(node < 0) {
+		for(int i = 0; i < _numRegions && physical == BuddyAccessor::illegalAddress; i++)
+			physical = allocateFrom(i);
+	}else{
+		// Try the given node first, then fall back to the remaining nodes
+		// in order of increasing (SLIT) distance.
+		int numNodes = numaNodeCount();
+		bool tried[maxNumaNodes] = {};
+		for(int k = 0; k < numNodes && physical == BuddyAccessor::illegalAddress; k++) {
+			int nearest = -1;
+			for(int candidate = 0; candidate < numNodes; candidate++) {
+				if(tried[candidate])
+					continue;
+				if(nearest < 0 || numaDistance(node, candidate) < numaDistance(node, nearest))
+					nearest = candidate;
+			}
+			tried[nearest] = true;
+
+			for(int j = 0; j < _numNumaSpans && physical == BuddyAccessor::illegalAddress; j++) {
+				auto &span = _numaSpans[j];
+				if(span.node != nearest)
+					continue;
+				auto &accessor = _allRegions[span.region].buddyAccessor;
+				if(target > accessor.tableOrder())
+					continue;
+				auto limit = span.limit;
+				if(addressBits < 64 && limit > (PhysicalAddr(1) << addressBits))
+					limit = PhysicalAddr(1) << addressBits;
+				physical = accessor.allocateInRange(target, span.base, limit);
+			}
+		}
+
+		// Chunks that straddle a node boundary are not part of any span.
+		for(int i = 0; i < _numRegions && physical == BuddyAccessor::illegalAddress; i++)
+			physical = allocateFrom(i);
+	}
+
+	if(physical != BuddyAccessor::illegalAddress) {
 	//	infoLogger() << "Allocate " << (void *)physical << frg::endlog;
 		assert(!(physical % (size_t(kPageSize) << target)));
+		_freePages.store(currentFree - (size_t(1) << target), std::memory_order_relaxed);
+		_usedPages.store(currentUsed + (size_t(1) << target), std::memory_order_relaxed);
 		return physical;
 	}
 
 	return static_cast<PhysicalAddr>(-1);
 }
 
-void PhysicalChunkAllocator::free(PhysicalAddr address, size_t size) {
-	auto irq_lock = frg::guard(&irqMutex());
-	auto lock = frg::guard(&_mutex);
-	
-	int target = 0;
-	while(size > (size_t(kPageSize) << target))
-		target++;
+void PhysicalChunkAllocator::_freeLocked(PhysicalAddr address, int target) {
+	size_t size = size_t(kPageSize) << target;
 
 	for(int i = 0; i < _numRegions; i++) {
 		if(address < _allRegions[i].physicalBase)
@@ -110,6 +329,81 @@ void PhysicalChunkAllocator::free(PhysicalAddr address, size_t size) {
 	assert(!"Physical page is not part of any region");
 }
 
+int PhysicalChunkAllocator::_numaNodeOf(PhysicalAddr address) {
+	// Spans do not change after assignNumaNodes().
+	for(int j = 0; j < _numNumaSpans; j++) {
+		auto &span = _numaSpans[j];
+		if(address >= span.base && address < span.limit)
+			return span.node;
+	}
+	return 0;
+}
+
+void PhysicalChunkAllocator::_refillCache(PhysicalPageCache *cache, int node) {
+	auto lock = frg::guard(&_mutex);
+
+	while(cache->numPages < PhysicalPageCache::batchSize) {
+		auto physical = _allocateLocked(0, 64, node);
+		if(physical == static_cast<PhysicalAddr>(-1))
+			break;
+		cache->pages[cache->numPages++] = physical;
+	}
+}
+
+void PhysicalChunkAllocator::_drainCache(PhysicalPageCache *cache, size_t count) {
+	auto lock = frg::guard(&_mutex);
+
+	while(count && cache->numPages) {
+		_freeLocked(cache->pages[--cache->numPages], 0);
+		--count;
+	}
+}
+
+void PhysicalChunkAllocator::_drainAllCaches() {
+	for(size_t cpu = 0; cpu < getCpuCount(); ++cpu) {
+		auto cache = &physicalPageCache.get(getCpuData(cpu));
+		auto cacheLock = frg::guard(&cache->mutex);
+		_drainCache(cache, cache->numPages);
+	}
+
+	for(size_t cpu = 0; cpu < getCpuCount(); ++cpu) {
+		auto pool = &zeroedPagePool.get(getCpuData(cpu));
+		auto poolLock = frg::guard(&pool->mutex);
+		auto lock = frg::guard(&_mutex);
+		while(pool->numPages)
+			_freeLocked(pool->pages[--pool->numPages], 0);
+	}
+}
+
+size_t PhysicalChunkAllocator::_numCachedPages() {
+	if(!_perCpuCachesEnabled.load(std::memory_order_acquire))
+		return 0;
+
+	size_t count = 0;
+	for(size_t cpu = 0; cpu < getCpuCount(); ++cpu) {
+		auto cache = &physicalPageCache.get(getCpuData(cpu));
+		auto pool = &zeroedPagePool.get(getCpuData(cpu));
+		count += __atomic_load_n(&cache->numPages, __ATOMIC_RELAXED);
+		count += __atomic_load_n(&pool->numPages, __ATOMIC_RELAXED);
+	}
+	return count;
+}
+
+static initgraph::Task initZeroingFibers{&globalInitEngine, "generic.init-zeroing-fibers",
+	initgraph::Requires{getFibersAvailableStage()},
+	[] {
+		for(size_t cpu = 0; cpu < getCpuCount(); ++cpu) {
+			KernelFiber::run([] {
+				Scheduler::setPriority(thisFiber(), zeroingPriority);
+				while(true) {
+					if(!physicalAllocator->refillZeroedPool())
+						KernelFiber::asyncBlockCurrent(generalTimerEngine()->sleepFor(zeroingInterval));
+				}
+			}, &localScheduler.getFor(cpu));
+		}
+	}
+};
+
 PhysicalWindow::PhysicalWindow(PhysicalAddr physical, size_t size, CachingMode caching)
 : size_{size} {
 	uintptr_t lowAddr = physical & ~(kPageSize - 1);
@@ -1,7 +1,12 @@
 #include <async/algorithm.hpp>
+#include <frg/container_of.hpp>
 #include <thor-internal/cpu-data.hpp>
+#include <thor-internal/ostrace.hpp>
 #include <thor-internal/rcu.hpp>
+#include <thor-internal/schedule.hpp>
 #include <thor-internal/work-queue.hpp>
+#include <thor-internal/arch-generic/ints.hpp>
+#include <thor-internal/arch-generic/timer.hpp>
 
 namespace thor {
 
@@ -9,8 +14,16 @@ namespace {
 
 constexpr bool logRcuCalls = false;
 
+// If more callbacks than this are waiting for a grace period, we expedite grace periods.
+constexpr size_t expediteBacklog = 4096;
+// Maximal number of callbacks that are invoked before yielding to other work on the WQ.
+constexpr size_t callBudget = 256;
+
 frg::eternal<RcuEngine> rcuEngine;
 
+// Number of callbacks that are submitted but not invoked yet (summed over all CPUs).
+std::atomic<size_t> rcuBacklog{0};
+
 } // namespace
 
 // barrier() guarantees that we see at least one quiescent state on all CPUs before returning.
@@ -21,7 +34,7 @@ frg::eternal<RcuEngine> rcuEngine;
 //
 // Note that to force a quiescent state, it is enough to force scheduling to a work queue
 // of CPU C followed by an appropriate memory barrier.
-coroutine<void> RcuEngine::barrier() {
+coroutine<void> RcuEngine::barrier(bool expedite) {
 	// We are using states that consist of a sequence number and a busy bit in this
 	// implementation. We guarantee correctness through the following properties,
 	// where s is the sequence number at barrier() entry:
@@ -58,27 +71,28 @@ coroutine<void> RcuEngine::barrier() {
 		);
 	}
 	if (initiate) {
-		transitionWg_.add(getCpuCount());
+		auto before = getClockNanos();
+
+		// Expedited transitions rely on IPIs, hence they require all CPUs to be initialized.
+		bool useIpis = expedite;
 		for (size_t c = 0; c < getCpuCount(); ++c) {
-			auto cpu = &cpuData.getFor(c);
-			// TODO: We can do this without allocation by putting the operations into a member vector.
-			spawnOnWorkQueue(
-				Allocator{},
-				cpu->generalWorkQueue,
-				async::invocable([this] {
-					// Perform an explicit fence here since WorkQueue::schedule() may not be strong enough
-					// (e.g., when scheduling to the current thread's WQ).
-					// It may be possible to weaken the barrier here by specifying
-					// the guarantees that WorkQueue::schedule() should provide.
-					std::atomic_thread_fence(std::memory_order_seq_cst);
-					transitionWg_.done();
-				})
-			);
+			if (!cpuData.getFor(c).cpuInitialized.load(std::memory_order_acquire))
+				useIpis = false;
+		}
+
+		if (useIpis) {
+			co_await transitionExpedited_();
+		} else {
+			co_await transitionNormal_();
 		}
-		co_await transitionWg_.wait();
 
 		state_.store(s + 1, std::memory_order_relaxed);
 		seqEvent_.raise();
+
+		ostrace::emit(ostEvtRcuGracePeriod,
+				ostAttrTime(getClockNanos() - before),
+				ostAttrExpedited(useIpis),
+				ostAttrBacklog(rcuBacklog.load(std::memory_order_relaxed)));
 	} else {
 		assert((current & stateSeq) > s);
 
@@ -93,6 +107,72 @@ coroutine<void> RcuEngine::barrier() {
 	}
 }
 
+coroutine<void> RcuEngine::transitionNormal_() {
+	transitionWg_.add(getCpuCount());
+	for (size_t c = 0; c < getCpuCount(); ++c) {
+		auto cpu = &cpuData.getFor(c);
+		// TODO: We can do this without allocation by putting the operations into a member vector.
+		spawnOnWorkQueue(
+			Allocator{},
+			cpu->generalWorkQueue,
+			async::invocable([this] {
+				// Perform an explicit fence here since WorkQueue::schedule() may not be strong enough
+				// (e.g., when scheduling to the current thread's WQ).
+				// It may be possible to weaken the barrier here by specifying
+				// the guarantees that WorkQueue::schedule() should provide.
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				transitionWg_.done();
+			})
+		);
+	}
+	co_await transitionWg_.wait();
+}
+
+// Instead of waiting until each CPU schedules its work queue (which can take up to
+// a time slice per CPU), we ping all CPUs. Ping IPIs call into Scheduler::checkPreemption()
+// which calls reportQuiescentState() unless scheduling is disabled at the interrupted code.
+// In the latter case, the preemption is deferred and another ping is sent
+// once scheduling is enabled again (see handleIplDeferred()).
+coroutine<void> RcuEngine::transitionExpedited_() {
+	// The Worklet only completes transitionWg_, hence it does not matter which WQ it runs on.
+	expediteWq_ = WorkQueue::generalQueue().get();
+	expediteWorklet_.setup([] (Worklet *) {
+		rcuEngine->transitionWg_.done();
+	});
+	transitionWg_.add(1);
+
+	// All flags need to be set before the first CPU reports, otherwise expeditePending_
+	// could drop to zero prematurely.
+	expeditePending_.store(getCpuCount(), std::memory_order_relaxed);
+	for (size_t c = 0; c < getCpuCount(); ++c)
+		cpuData.getFor(c).rcuExpedite.store(true, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	// Work queues run with scheduling enabled, hence this CPU is in a quiescent state.
+	auto self = getCpuData();
+	reportQuiescentState(self);
+	for (size_t c = 0; c < getCpuCount(); ++c) {
+		auto cpu = &cpuData.getFor(c);
+		if (cpu != self)
+			sendPingIpi(cpu);
+	}
+
+	co_await transitionWg_.wait();
+}
+
+void RcuEngine::reportQuiescentState(CpuData *cpu) {
+	if (!cpu->rcuExpedite.exchange(false, std::memory_order_relaxed))
+		return;
+	// Order all accesses that preceeded the quiescent state before the report.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (expeditePending_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		expediteWq_->post(&expediteWorklet_);
+}
+
+void reportRcuQuiescentState(CpuData *cpu) {
+	rcuEngine->reportQuiescentState(cpu);
+}
+
 coroutine<void> LocalRcuEngine::barrier() {
 	auto current = state_.load(std::memory_order_relaxed);
 	auto s = current & stateSeq;
@@ -164,7 +244,12 @@ coroutine<void> LocalRcuEngine::barrier() {
 // This is per-CPU. The calls run on the CPU's generalWorkQueue.
 struct RcuDispatcher {
 	RcuDispatcher(CpuData *cpu)
-	: cpu_{cpu} { }
+	: cpu_{cpu} {
+		callWorklet_.setup([] (Worklet *base) {
+			auto self = frg::container_of(base, &RcuDispatcher::callWorklet_);
+			self->invokeCalls_();
+		});
+	}
 
 	void run() {
 		runLoop_(enable_detached_coroutine{.wq = cpu_->generalWorkQueue});
@@ -172,6 +257,7 @@ struct RcuDispatcher {
 
 	void submit(RcuCallable *callable, void (*call)(RcuCallable *)) {
 		callable->call_ = call;
+		rcuBacklog.fetch_add(1, std::memory_order_relaxed);
 
 		bool wasEmpty;
 		{
@@ -208,23 +294,43 @@ private:
 			if (collected.empty())
 				continue;
 
-			co_await rcuEngine->barrier();
+			auto expedite = rcuBacklog.load(std::memory_order_relaxed) > expediteBacklog;
+			co_await rcuEngine->barrier(expedite);
 
-			size_t n = 0;
-			while (!collected.empty()) {
-				auto callable = collected.pop_front();
-				callable->call_(callable);
-				++n;
-			}
-			if (logRcuCalls)
-				infoLogger() << "thor: " << n << " RCU calls on CPU " << cpu_->cpuIndex << frg::endlog;
+			// Invoking the calls is decoupled from this loop such that we can already
+			// wait for the next grace period while the calls are running.
+			bool wasEmpty = ready_.empty();
+			ready_.splice(ready_.end(), collected);
+			if (wasEmpty)
+				cpu_->generalWorkQueue->postDeferred(&callWorklet_);
+		}
+	}
+
+	// Runs on the generalWorkQueue, i.e., in the same context as runLoop_().
+	// Invokes at most callBudget calls per pass such that other Worklets are not starved.
+	void invokeCalls_() {
+		size_t n = 0;
+		while (!ready_.empty() && n < callBudget) {
+			auto callable = ready_.pop_front();
+			callable->call_(callable);
+			++n;
 		}
+		rcuBacklog.fetch_sub(n, std::memory_order_relaxed);
+		if (logRcuCalls)
+			infoLogger() << "thor: " << n << " RCU calls on CPU " << cpu_->cpuIndex << frg::endlog;
+
+		if (!ready_.empty())
+			cpu_->generalWorkQueue->postDeferred(&callWorklet_);
 	}
 
 	CpuData *cpu_;
 	IrqSpinlock mutex_;
 	CallableList queue_;
 	async::recurring_event pendingEvent_;
+
+	// Calls whose grace period has elapsed. Only accessed from the generalWorkQueue.
+	CallableList ready_;
+	Worklet callWorklet_;
 };
 
 // TODO: Move to anonymous namespace?
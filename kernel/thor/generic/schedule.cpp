@@ -1,9 +1,11 @@
 #include <assert.h>
 
+#include <frg/cmdline.hpp>
 #include <thor-internal/arch-generic/cpu.hpp>
 #include <thor-internal/arch-generic/ints.hpp>
 #include <thor-internal/cpu-data.hpp>
 #include <thor-internal/debug.hpp>
+#include <thor-internal/main.hpp>
 #include <thor-internal/ostrace.hpp>
 #include <thor-internal/schedule.hpp>
 #include <thor-internal/thread.hpp>
@@ -22,6 +24,74 @@ namespace {
 	// Minimum length of a preemption time slice in ns.
 	constexpr int64_t sliceGranularity = 10'000'000;
 
+	enum class IdlePolicy {
+		// Halt until the next interrupt. Wakeups from other CPUs always need an IPI.
+		halt,
+		// Spin on CpuData::idleState. Other CPUs wake us up without an IPI.
+		poll,
+		// Spin for a short time, then wait on CpuData::idleState using waitOnAddress()
+		// (MONITOR/MWAIT on x86, LDAXR/WFE on ARM and Zawrs on RISC-V).
+		// Other CPUs wake us up without an IPI.
+		mwait
+	};
+
+	IdlePolicy idlePolicy = IdlePolicy::halt;
+
+	// Number of iterations that the idle loop spins before it calls waitOnAddress().
+	constexpr int idleSpinIterations = 1000;
+
+	// Values of CpuData::idleState.
+	constexpr unsigned int idleRunning = 0;
+	constexpr unsigned int idlePolling = 1;
+	constexpr unsigned int idleWoken = 2;
+
+	// Called before the idle task is descheduled.
+	// Afterwards, other CPUs need to send IPIs again to wake us up.
+	// Since this is an atomic RMW, wakeups that were done by storing to idleState
+	// happen before our next Scheduler::update().
+	void leaveIdlePolling() {
+		getCpuData()->idleState.exchange(idleRunning, std::memory_order_seq_cst);
+	}
+
+	// Returns true if the CPU was woken up without an IPI.
+	bool wakeFromIdlePolling(CpuData *cpuData) {
+		if(cpuData->idleState.load(std::memory_order_relaxed) != idlePolling)
+			return false;
+		auto expected = idlePolling;
+		return cpuData->idleState.compare_exchange_strong(expected, idleWoken,
+				std::memory_order_seq_cst, std::memory_order_relaxed);
+	}
+
+	[[noreturn]] void pollIdle() {
+		auto cpuData = getCpuData();
+		auto scheduler = &localScheduler.get();
+		while(true) {
+			assert(!intsAreEnabled());
+			cpuData->idleState.store(idlePolling, std::memory_order_seq_cst);
+
+			// Interrupts that arrive while we poll are handled by IdleTask::handlePreemption().
+			enableInts();
+			for(int i = 0; idlePolicy == IdlePolicy::poll || i < idleSpinIterations; i++) {
+				if(cpuData->idleState.load(std::memory_order_relaxed) != idlePolling)
+					break;
+				pause();
+			}
+			disableInts();
+
+			if(idlePolicy == IdlePolicy::mwait) {
+				waitOnAddress(&cpuData->idleState, idlePolling);
+				disableInts();
+			}
+
+			// Either another CPU woke us up or an interrupt arrived.
+			leaveIdlePolling();
+			scheduler->update();
+			if(scheduler->maybeReschedule())
+				scheduler->commitReschedule();
+			scheduler->renewSchedule();
+		}
+	}
+
 	struct IdleTask final : ScheduleEntity {
 		IdleTask()
 		: ScheduleEntity{ScheduleType::idle} { }
@@ -32,13 +102,19 @@ namespace {
 					infoLogger() << "System is idle" << frg::endlog;
 				// Restore IPL (as in restoreExecutor() for threads/fibers).
 				iplLeaveContext(IplState{.context = ipl::passive, .current = ipl::exceptional});
-				suspendSelf();
+				if(idlePolicy == IdlePolicy::halt) {
+					suspendSelf();
+				}else{
+					pollIdle();
+				}
 				__builtin_trap();
 			}, getCpuData()->idleStack.base());
 			__builtin_trap();
 		}
 
 		void handlePreemption(IrqImageAccessor image) override {
+			leaveIdlePolling();
+
 			auto *scheduler = &localScheduler.get();
 			scheduler->update();
 			if(scheduler->maybeReschedule()) {
@@ -132,6 +208,11 @@ void Scheduler::resume(ScheduleEntity *entity) {
 
 		wasEmpty = self->_pendingList.empty();
 		self->_pendingList.push_back(entity);
+
+		// This needs to happen with IRQs disabled, such that we cannot be
+		// preempted (by the entity itself) before setting _handoff.
+		if(self == &localScheduler.get())
+			self->_handoff = entity;
 	}
 
 	if(wasEmpty) {
@@ -148,7 +229,7 @@ void Scheduler::resume(ScheduleEntity *entity) {
 			// TODO: In the case of kernel threads, it can be necessary to issue a self IPI
 			//       to ensure that a higher priority thread gets to run as soon as possible.
 			self->_mustCallPreemption = true;
-		}else{
+		}else if(!wakeFromIdlePolling(self->_cpuContext)) {
 			sendPingIpi(self->_cpuContext);
 		}
 	}
@@ -310,6 +391,7 @@ void Scheduler::forceReschedule() {
 
 	_current = _scheduled;
 	_scheduled = nullptr;
+	_handoff = nullptr;
 	_sliceClock = _refClock;
 	_mustCallPreemption = false;
 
@@ -334,6 +416,9 @@ ScheduleEntity *Scheduler::currentRunnable() {
 void Scheduler::_unschedule() {
 	assert(_current);
 
+	// Only do a direct switch if _current blocks, not if it is preempted.
+	_handoff = nullptr;
+
 	// Decrease the unfairness at the end of the time slice.
 	_updateEntityStats(_current);
 
@@ -357,8 +442,21 @@ void Scheduler::_schedule() {
 		return;
 	}
 
+	// If the current entity blocks right after resuming another entity on this CPU
+	// (e.g., a server that replies to a client and waits for the next request),
+	// switch directly to that entity. It inherits the remainder of the current time slice
+	// (i.e., the preemption deadline), see commitReschedule().
+	// We never bypass entities of higher priority.
 	auto entity = _waitQueue.top();
-	_waitQueue.pop();
+	if(_handoff && _handoff->state == ScheduleState::active
+			&& ScheduleEntity::orderPriority(_handoff, entity) <= 0) {
+		entity = _handoff;
+		_waitQueue.remove(entity);
+		ostrace::emit(ostEvtDirectSwitch);
+	}else{
+		_waitQueue.pop();
+	}
+	_handoff = nullptr;
 	_numWaiting--;
 
 	// Increase the unfairness at the start of the time slice.
@@ -485,5 +583,29 @@ smarter::borrowed_ptr<Thread> getCurrentThread() {
 	return getCpuData()->activeThread;
 }
 
+static initgraph::Task initIdlePolicy{&globalInitEngine, "generic.init-idle-policy",
+	initgraph::Entails{getTaskingAvailableStage()},
+	[] {
+		frg::string_view policy = "mwait";
+		frg::array args = {
+			frg::option{"idle", frg::as_string_view(policy)},
+		};
+		frg::parse_arguments(getKernelCmdline(), args);
+
+		if(policy == "poll") {
+			idlePolicy = IdlePolicy::poll;
+		}else if(policy == "mwait") {
+			if(haveWaitOnAddress()) {
+				idlePolicy = IdlePolicy::mwait;
+			}else{
+				infoLogger() << "thor: CPU cannot wait on addresses, halting in idle loop"
+						<< frg::endlog;
+			}
+		}else if(policy != "halt") {
+			infoLogger() << "thor: Unknown idle policy " << policy << frg::endlog;
+		}
+	}
+};
+
 } // namespace thor
 
@@ -323,6 +323,31 @@ void Stream::shutdownLane(int lane) {
 	}
 }
 
+bool Stream::cancelPending(StreamNode *node) {
+	auto s = node->_transmitLane.getStream();
+	int p = node->_transmitLane.getLane();
+
+	bool found = false;
+	{
+		auto irq_lock = frg::guard(&irqMutex());
+		auto lock = frg::guard(&s->_mutex);
+
+		auto &queue = s->_processQueue[p];
+		for(auto it = queue.begin(); it != queue.end(); ++it) {
+			if(*it == node) {
+				queue.erase(it);
+				found = true;
+				break;
+			}
+		}
+	}
+
+	if(!found)
+		return false;
+	_cancelItem(node, Error::cancelled);
+	return true;
+}
+
 void Stream::_cancelItem(StreamNode *item, Error error) {
 	StreamList pending;
 	pending.splice(pending.end(), item->ancillaryChain);
@@ -32,6 +32,20 @@ struct GlobalFutex {
 		return __atomic_load_n(accessPtr, __ATOMIC_RELAXED);
 	}
 
+	// Only valid if the page was obtained with fetchRequireMutable.
+	template<typename F>
+	unsigned int update(F fn) {
+		PageAccessor accessor{physical_ & ~(kPageSize - 1)};
+		auto offset = physical_ & (kPageSize - 1);
+		auto accessPtr = reinterpret_cast<unsigned int *>(
+				reinterpret_cast<std::byte *>(accessor.get()) + offset);
+		auto value = __atomic_load_n(accessPtr, __ATOMIC_RELAXED);
+		while(!__atomic_compare_exchange_n(accessPtr, &value, fn(value), true,
+				__ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+			;
+		return value;
+	}
+
 private:
 	FutexIdentity id_;
 	PhysicalAddr physical_;
@@ -84,6 +98,23 @@ frg::expected<Error, PagesAffected> mapPresentPagesByCursor(PageSpace *ps, Virtu
 		auto effectiveFlags = flags;
 		if (!physicalRange.isMutable)
 			effectiveFlags &= ~page_access::write;
+
+		// Map physically contiguous, suitably aligned ranges using large pages.
+		if(!(c.virtualAddress() & (kLargePageSize - 1))
+				&& !(physicalRange.physical & (kLargePageSize - 1))
+				&& physicalRange.size >= kLargePageSize
+				&& c.virtualAddress() + kLargePageSize <= va + size
+				&& c.mapLarge(physicalRange.physical, effectiveFlags,
+					determineCachingMode(physicalRange.cachingMode, mode))) {
+			for(size_t pg = 0; pg < kLargePageSize; pg += kPageSize) {
+				if(auto descriptor = globalPfnDb().find(physicalRange.physical + pg))
+					incrementUses(*descriptor);
+			}
+			affected.rssIncrease += kLargePageSize;
+			c.advanceLarge();
+			continue;
+		}
+
 		if(auto descriptor = globalPfnDb().find(physicalRange.physical))
 			incrementUses(*descriptor);
 		auto [status, oldPhysical] = c.map4k(physicalRange.physical, effectiveFlags,
@@ -103,6 +134,44 @@ frg::expected<Error, PagesAffected> mapPresentPagesByCursor(PageSpace *ps, Virtu
 	return affected;
 }
 
+// Like mapPresentPagesByCursor() but leaves pages that are already mapped alone.
+// This never revokes access to any page.
+template<typename Cursor, typename PageSpace>
+frg::expected<Error, PagesAffected> mapAbsentPagesByCursor(PageSpace *ps, VirtualAddr va,
+		MemoryView *view, uintptr_t offset, size_t size, PageFlags flags, CachingMode mode) {
+	assert(!(va & (kPageSize - 1)));
+	assert(!(offset & (kPageSize - 1)));
+	assert(!(size & (kPageSize - 1)));
+
+	PagesAffected affected{};
+	Cursor c{ps, va};
+	while(c.virtualAddress() < va + size) {
+		auto progress = c.virtualAddress() - va;
+		auto physicalRange = view->peekRange(offset + progress, fetchNone);
+		if(physicalRange.physical == PhysicalAddr(-1)) {
+			c.advance4k();
+			continue;
+		}
+		assert(!(physicalRange.physical & (kPageSize - 1)));
+
+		auto effectiveFlags = flags;
+		if (!physicalRange.isMutable)
+			effectiveFlags &= ~page_access::write;
+
+		auto descriptor = globalPfnDb().find(physicalRange.physical);
+		if(descriptor)
+			incrementUses(*descriptor);
+		if(c.mapAbsent4k(physicalRange.physical, effectiveFlags,
+				determineCachingMode(physicalRange.cachingMode, mode))) {
+			affected.rssIncrease += kPageSize;
+		}else if(descriptor) {
+			decrementUses(*descriptor);
+		}
+		c.advance4k();
+	}
+	return affected;
+}
+
 template<typename Cursor, typename PageSpace>
 frg::expected<Error, PagesAffected> restrictPagesByCursor(PageSpace *ps, VirtualAddr va,
 		size_t size, PageFlags flags, CachingMode mode) {
@@ -185,6 +254,26 @@ frg::expected<Error, PagesAffected> unmapPagesByCursor(PageSpace *ps, VirtualAdd
 	PagesAffected affected{};
 	Cursor c{ps, va};
 	while(c.findPresent(va + size)) {
+		// Large pages that are entirely within the range are unmapped at once.
+		// Otherwise, unmap4k() splits them into small pages.
+		if(c.isLarge() && !(c.virtualAddress() & (kLargePageSize - 1))
+				&& c.virtualAddress() + kLargePageSize <= va + size) {
+			auto [status, physical] = c.unmapLarge();
+			assert(status & page_status::present);
+			for(size_t pg = 0; pg < kLargePageSize; pg += kPageSize) {
+				if(auto descriptor = globalPfnDb().find(physical + pg)) {
+					if(status & page_status::dirty)
+						markDirty(*descriptor);
+					decrementUses(*descriptor);
+				}
+			}
+			affected.rssDecrease += kLargePageSize;
+			affected.anyRevoked = true;
+
+			c.advanceLarge();
+			continue;
+		}
+
 		auto [status, physical] = c.unmap4k();
 		assert(status & page_status::present);
 		if(status & page_status::dirty) {
@@ -209,6 +298,12 @@ frg::expected<Error, PagesAffected> agePagesByCursor(PageSpace *ps, VirtualAddr
 	PagesAffected affected{};
 	Cursor c{ps, va};
 	while(c.findPresent(va + size)) {
+		// Large pages are not subject to aging (they would need to be split first).
+		if(c.isLarge()) {
+			c.advanceLarge();
+			continue;
+		}
+
 		affected.scanned += kPageSize;
 		auto [status, physical, unmapped] = c.age4k(vacate);
 		if(unmapped) {
@@ -234,6 +329,10 @@ struct VirtualOperations {
 	virtual frg::expected<Error, PagesAffected> mapPresentPages(VirtualAddr va, MemoryView *view,
 			uintptr_t offset, size_t size, PageFlags flags, CachingMode mode) = 0;
 
+	// Maps present pages of the view but skips pages that are already mapped.
+	virtual frg::expected<Error, PagesAffected> mapAbsentPages(VirtualAddr va, MemoryView *view,
+			uintptr_t offset, size_t size, PageFlags flags, CachingMode mode) = 0;
+
 	virtual frg::expected<Error, PagesAffected> restrictPages(VirtualAddr va,
 			size_t size, PageFlags flags, CachingMode mode) = 0;
 
@@ -513,12 +612,40 @@ struct MappingLess {
 	}
 };
 
+struct PinnedPage;
+
 using MappingTree = frg::rbtree<
 	Mapping,
 	&Mapping::treeNode,
 	MappingLess
 >;
 
+// Accumulates the ranges that an operation needs to shoot down, such that all of them
+// can be handled by a single round of IPIs. Ranges are merged into their hull;
+// large hulls are handled by invalidating the entire ASID.
+struct ShootdownBatch {
+	void add(VirtualAddr address, size_t size) {
+		begin_ = frg::min(begin_, address);
+		end_ = frg::max(end_, address + size);
+	}
+
+	bool empty() {
+		return begin_ >= end_;
+	}
+
+	VirtualAddr address() {
+		return begin_;
+	}
+
+	size_t size() {
+		return end_ - begin_;
+	}
+
+private:
+	VirtualAddr begin_ = ~VirtualAddr{0};
+	VirtualAddr end_ = 0;
+};
+
 struct VirtualSpace {
 	friend struct Mapping;
 
@@ -606,6 +733,13 @@ public:
 		);
 	}
 
+	// Locks the page that contains address into memory.
+	// This allows other address spaces to access the page through its physical address
+	// (e.g., to copy IPC buffers without going through an intermediate kernel buffer).
+	// Fails with Error::fault if the page is not mapped with the required protection
+	// (protWrite if fetchRequireMutable is passed, protRead otherwise).
+	coroutine<frg::expected<Error, PinnedPage>> pinPage(uintptr_t address, FetchFlags fetchFlags);
+
 	// ----------------------------------------------------------------------------------
 	// GlobalFutex support.
 	// ----------------------------------------------------------------------------------
@@ -613,6 +747,20 @@ public:
 	struct GlobalFutexSpace {
 		template<typename F>
 		coroutine<frg::expected<Error>> withFutex(uintptr_t address, F &&f) {
+			return withFutex_(address, std::forward<F>(f), fetchNone);
+		}
+
+		// Like withFutex() but ensures that the futex can be modified.
+		template<typename F>
+		coroutine<frg::expected<Error>> withMutableFutex(uintptr_t address, F &&f) {
+			return withFutex_(address, std::forward<F>(f), fetchRequireMutable);
+		}
+
+		VirtualSpace *self;
+
+	private:
+		template<typename F>
+		coroutine<frg::expected<Error>> withFutex_(uintptr_t address, F f, FetchFlags fetchFlags) {
 			assert(currentIpl() == ipl::exceptionalWork);
 
 			if (address & (sizeof(int) - 1))
@@ -627,6 +775,9 @@ public:
 				}
 				if(!mapping)
 					co_return Error::fault;
+				if((fetchFlags & fetchRequireMutable)
+						&& !(mapping->flags.load(std::memory_order_relaxed) & MappingFlags::protWrite))
+					co_return Error::fault;
 
 				auto offset = address - mapping->address;
 				auto alignedOffset = offset & ~(kPageSize - 1);
@@ -645,7 +796,7 @@ public:
 					LocalRcuEngine::Guard exposeGuard{mapping->exposeRcu};
 
 					// Complete the operation if the memory page is available.
-					auto physicalRange = mapping->view->peekRange(mapping->viewOffset + alignedOffset, fetchNone);
+					auto physicalRange = mapping->view->peekRange(mapping->viewOffset + alignedOffset, fetchFlags);
 					if(physicalRange.physical != PhysicalAddr(-1)) {
 						f(GlobalFutex{id, physicalRange.physical + offsetMisalign});
 						co_return {};
@@ -654,12 +805,10 @@ public:
 
 				// Otherwise, try to make the page available.
 				FRG_CO_TRY(co_await mapping->view->touchRange(
-					mapping->viewOffset + alignedOffset, kPageSize, fetchNone
+					mapping->viewOffset + alignedOffset, kPageSize, fetchFlags
 				));
 			}
 		}
-
-		VirtualSpace *self;
 	};
 	static_assert(FutexSpace<GlobalFutexSpace>);
 
@@ -694,13 +843,17 @@ private:
 	// Returns true if the aging code should continue scanning accessed bits.
 	bool shouldContinueAging_();
 
+	// Wrapper around VirtualOperations::shootdown() that also traces the shootdown.
+	coroutine<void> _shootdown(VirtualAddr address, size_t size);
+	coroutine<void> _shootdown(ShootdownBatch &batch);
+
 	// Potentially splits mappings into two parts at (address) and (address + size).
 	// Returns the start and end mappings that are within the specified range.
 	coroutine<frg::tuple<Mapping *, Mapping *>> _splitMappings(uintptr_t address, size_t size);
 
 	// Used in conjunction with _splitMappings.
 	// Unmaps and removes all mappings between start and end that fall within the specified range.
-	// Returns whether shootdown needs to be performed (any of the mappings got unmapped).
+	// Performs a single shootdown for all mappings.
 	coroutine<void> _unmapMappings(VirtualAddr address, size_t length, Mapping *start, Mapping *end);
 
 	VirtualOperations *_ops;
@@ -754,6 +907,12 @@ struct AddressSpace final : VirtualSpace, smarter::crtp_counter<AddressSpace, Bi
 					va, view, offset, size, flags, mode);
 		}
 
+		frg::expected<Error, PagesAffected> mapAbsentPages(VirtualAddr va, MemoryView *view,
+				uintptr_t offset, size_t size, PageFlags flags, CachingMode mode) override {
+			return mapAbsentPagesByCursor<ClientPageSpace::Cursor>(&space_->pageSpace_,
+					va, view, offset, size, flags, mode);
+		}
+
 		frg::expected<Error, PagesAffected> restrictPages(VirtualAddr va,
 				size_t size, PageFlags flags, CachingMode mode) override {
 			return restrictPagesByCursor<ClientPageSpace::Cursor>(&space_->pageSpace_,
@@ -810,8 +969,6 @@ public:
 
 	void dispose(BindableHandle);
 
-	FutexRealm localFutexRealm;
-
 	bool updatePageAccess(VirtualAddr address, PageFlags flags) {
 		return pageSpace_.updatePageAccess(address, flags);
 	}
@@ -869,6 +1026,13 @@ private:
 	bool _active = false;
 };
 
+// Result of VirtualSpace::pinPage().
+struct PinnedPage {
+	MemoryViewLockHandle lock;
+	// Physical address of the (page-aligned) page.
+	PhysicalAddr physical = PhysicalAddr(-1);
+};
+
 struct NamedMemoryViewLock {
 	NamedMemoryViewLock(MemoryViewLockHandle handle)
 	: _handle{std::move(handle)} { }
@@ -192,6 +192,14 @@ struct PageSpace {
 	}
 
 private:
+	// Maximal number of CPUs for which we track bindings.
+	// On larger systems, shootdowns fall back to broadcast IPIs.
+	static constexpr size_t maxTrackedCpus = 256;
+
+	// Track bindings on the current CPU. Must be called with mutex_ held.
+	void addBinding_();
+	void removeBinding_();
+
 	PhysicalAddr rootTable_;
 
 	std::atomic<bool> wantToRetire_ = false;
@@ -202,6 +210,10 @@ private:
 
 	unsigned int numBindings_;
 
+	// Bitmap of CPUs that have a binding to this space.
+	// Shootdown IPIs are only sent to these CPUs.
+	uint64_t boundCpus_[maxTrackedCpus / 64] = {};
+
 	uint64_t shootSequence_;
 
 	ShootQueue shootQueue_;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stddef.h>
+#include <string.h>
 #include <concepts>
 #include <tuple>
 #include <utility>
@@ -49,10 +50,26 @@ concept CursorPolicy = requires (uint64_t pte, uint64_t *ptePtr,
 	{ T::pteNewTable() } -> std::same_as<uint64_t>;
 };
 
+// Optional extension of CursorPolicy for policies that support large page leaves
+// (i.e., leaf entries of size kLargePageSize in the second-to-last level).
+template <typename T>
+concept LargePageCursorPolicy = CursorPolicy<T> && requires (uint64_t pte,
+		PhysicalAddr pa, PageFlags flags, CachingMode cachingMode, size_t index) {
+	// Check whether the given (non-last level) PTE is a large page leaf.
+	{ T::pteIsLargePage(pte) } -> std::same_as<bool>;
+	// Construct a new large page leaf from the given parameters.
+	{ T::pteBuildLarge(pa, flags, cachingMode) } -> std::same_as<uint64_t>;
+	// Construct the last level PTE that maps the index-th small page of the given large page.
+	// All other attributes (including status bits) are inherited from the large page.
+	{ T::pteSplitLarge(pte, index) } -> std::same_as<uint64_t>;
+};
+
 template <CursorPolicy Policy>
 struct PageCursor {
 	inline static constexpr uintptr_t levelMask = (uintptr_t{1} << Policy::bitsPerLevel) - 1;
 	inline static constexpr size_t lastLevel = Policy::maxLevels - 1;
+	inline static constexpr size_t largeLevel = Policy::maxLevels - 2;
+	inline static constexpr bool supportsLargePages = LargePageCursorPolicy<Policy>;
 
 	PageCursor(PageSpace *space, uintptr_t va)
 	: space_{space}, va_{}, initialLevel_{Policy::maxLevels - Policy::numLevels()} {
@@ -78,6 +95,30 @@ private:
 		return __atomic_exchange_n(currentPtePtr_(), value, __ATOMIC_RELAXED);
 	}
 
+	// Returns a pointer to the large page leaf that covers va_ (or nullptr if there is none).
+	uint64_t *largePtePtr_() {
+		if constexpr (supportsLargePages) {
+			if(accessors_[lastLevel] || !accessors_[largeLevel])
+				return nullptr;
+			auto ptePtr = reinterpret_cast<uint64_t *>(accessors_[largeLevel].get())
+				+ ((va_ >> levelShift(largeLevel)) & levelMask);
+			if(!Policy::pteIsLargePage(__atomic_load_n(ptePtr, __ATOMIC_RELAXED)))
+				return nullptr;
+			return ptePtr;
+		} else {
+			return nullptr;
+		}
+	}
+
+	// If va_ is covered by a large page, replace it by a last level table that maps
+	// the same physical pages. Returns true if the last level table is available afterwards.
+	bool splitLarge_() {
+		if(!largePtePtr_())
+			return false;
+		realizePts_();
+		return true;
+	}
+
 public:
 	uintptr_t virtualAddress() {
 		return va_;
@@ -101,9 +142,21 @@ public:
 		moveTo(va_ + kPageSize);
 	}
 
+	// Advances to the next kLargePageSize boundary.
+	void advanceLarge() {
+		moveTo((va_ + kLargePageSize) & ~uintptr_t(kLargePageSize - 1));
+	}
+
+	// Whether va_ is currently covered by a large page leaf.
+	bool isLarge() {
+		return largePtePtr_();
+	}
+
 	bool findPresent(uintptr_t limit) {
 		while(va_ < limit) {
 			if(!accessors_[lastLevel]) {
+				if(largePtePtr_())
+					return true;
 				advance4k();
 				continue;
 			}
@@ -121,6 +174,13 @@ public:
 	bool findDirty(uintptr_t limit) {
 		while(va_ < limit) {
 			if(!accessors_[lastLevel]) {
+				if(auto largePtr = largePtePtr_()) {
+					auto largeEnt = __atomic_load_n(largePtr, __ATOMIC_RELAXED);
+					if(Policy::ptePageStatus(largeEnt) & page_status::dirty)
+						return true;
+					advanceLarge();
+					continue;
+				}
 				advance4k();
 				continue;
 			}
@@ -150,6 +210,80 @@ public:
 		return {Policy::ptePageStatus(oldPte), Policy::ptePageAddress(oldPte)};
 	}
 
+	// Installs a PTE at va_ unless a page is already present there.
+	// Returns true if the PTE was installed.
+	bool mapAbsent4k(PhysicalAddr pa, PageFlags flags, CachingMode cachingMode) {
+		if(!accessors_[lastLevel]) {
+			if(largePtePtr_())
+				return false;
+			realizePts_();
+		}
+
+		auto oldPte = readCurrentPte_();
+		if(Policy::ptePagePresent(oldPte))
+			return false;
+
+		if (flags & page_access::execute)
+			Policy::pteSyncICache(pa);
+
+		if(!__atomic_compare_exchange_n(currentPtePtr_(), &oldPte,
+				Policy::pteBuild(pa, flags, cachingMode),
+				false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			return false;
+		Policy::pteWriteBarrier();
+		return true;
+	}
+
+	// Installs a large page leaf at va_ (which must be aligned to kLargePageSize).
+	// This only succeeds if no page table or page is present at va_ yet;
+	// otherwise, callers have to fall back to map4k().
+	bool mapLarge(PhysicalAddr pa, PageFlags flags, CachingMode cachingMode) {
+		assert(!(va_ & (kLargePageSize - 1)));
+		assert(!(pa & (kLargePageSize - 1)));
+		if constexpr (supportsLargePages) {
+			if(accessors_[lastLevel])
+				return false;
+
+			{
+				auto irqLock = frg::guard(&irqMutex());
+				auto lock = frg::guard(&space_->tableMutex());
+				realizeLevel_(largeLevel);
+			}
+
+			if (flags & page_access::execute) {
+				for(size_t i = 0; i < kLargePageSize; i += kPageSize)
+					Policy::pteSyncICache(pa + i);
+			}
+
+			auto ptePtr = reinterpret_cast<uint64_t *>(accessors_[largeLevel].get())
+				+ ((va_ >> levelShift(largeLevel)) & levelMask);
+			uint64_t expected = 0;
+			if(!__atomic_compare_exchange_n(ptePtr, &expected,
+					Policy::pteBuildLarge(pa, flags, cachingMode),
+					false, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+				return false;
+			Policy::pteWriteBarrier();
+			return true;
+		} else {
+			(void)pa;
+			(void)flags;
+			(void)cachingMode;
+			return false;
+		}
+	}
+
+	// Removes the large page leaf at va_ (which must be aligned to kLargePageSize).
+	std::tuple<PageStatus, PhysicalAddr> unmapLarge() {
+		assert(!(va_ & (kLargePageSize - 1)));
+		auto ptePtr = largePtePtr_();
+		assert(ptePtr);
+
+		auto ptEnt = __atomic_exchange_n(ptePtr, 0, __ATOMIC_RELAXED);
+		Policy::pteWriteBarrier();
+		return {Policy::ptePageStatus(ptEnt),
+				Policy::ptePageAddress(ptEnt) & ~PhysicalAddr(kLargePageSize - 1)};
+	}
+
 	std::tuple<PageStatus, PhysicalAddr> remap4k(PhysicalAddr pa, PageFlags flags, CachingMode cachingMode) {
 		if(!accessors_[lastLevel])
 			realizePts_();
@@ -165,7 +299,7 @@ public:
 	}
 
 	std::tuple<PageStatus, PhysicalAddr, bool> restrict4k(PageFlags flags, CachingMode cachingMode) {
-		if(!accessors_[lastLevel])
+		if(!accessors_[lastLevel] && !splitLarge_())
 			return {0, PhysicalAddr(-1), false};
 
 		uint64_t oldPte = readCurrentPte_();
@@ -197,7 +331,7 @@ public:
 	}
 
 	std::tuple<PageStatus, PhysicalAddr> clean4k() {
-		if(!accessors_[lastLevel])
+		if(!accessors_[lastLevel] && !splitLarge_())
 			return {0, PhysicalAddr(-1)};
 
 		auto ptEnt = Policy::pteClean(currentPtePtr_());
@@ -205,7 +339,7 @@ public:
 	}
 
 	std::tuple<PageStatus, PhysicalAddr> unmap4k() {
-		if(!accessors_[lastLevel])
+		if(!accessors_[lastLevel] && !splitLarge_())
 			return {0, 0};
 
 		auto ptEnt = exchangeCurrentPte_(0);
@@ -214,7 +348,7 @@ public:
 	}
 
 	std::tuple<PageStatus, PhysicalAddr, bool> age4k(bool vacate) {
-		if(!accessors_[lastLevel])
+		if(!accessors_[lastLevel] && !splitLarge_())
 			return {0, PhysicalAddr(-1), false};
 		auto [oldPte, unmapped] = Policy::pteAge(currentPtePtr_(), vacate);
 		if(unmapped)
@@ -238,6 +372,10 @@ private:
 
 		if(!Policy::pteTablePresent(ptEnt))
 			return false;
+		if constexpr (supportsLargePages) {
+			if(level == largeLevel && Policy::pteIsLargePage(ptEnt))
+				return false;
+		}
 
 		auto subPtPtr = Policy::pteTableAddress(ptEnt);
 		subPt = PageAccessor{subPtPtr};
@@ -259,6 +397,13 @@ private:
 			+ ((va_ >> levelShift(level)) & levelMask);
 		auto ptEnt = __atomic_load_n(ptPtr, __ATOMIC_ACQUIRE);
 
+		if constexpr (supportsLargePages) {
+			if(level == largeLevel && Policy::pteIsLargePage(ptEnt)) {
+				splitLargeLeaf_(subPt, ptPtr, ptEnt);
+				return;
+			}
+		}
+
 		if(Policy::pteTablePresent(ptEnt)) {
 			auto subPtPtr = Policy::pteTableAddress(ptEnt);
 			subPt = PageAccessor{subPtPtr};
@@ -273,6 +418,41 @@ private:
 		Policy::pteWriteBarrier();
 	}
 
+	// Replaces the large page leaf at *ptPtr by a last level table with equivalent PTEs.
+	// The hardware may concurrently update status bits of the leaf, hence we retry
+	// until the leaf is replaced atomically.
+	void splitLargeLeaf_(PageAccessor &subPt, uint64_t *ptPtr, uint64_t largeEnt) {
+		if constexpr (supportsLargePages) {
+			auto tableEnt = Policy::pteNewTable();
+			auto subPtPtr = Policy::pteTableAddress(tableEnt);
+			subPt = PageAccessor{subPtPtr};
+			auto tbl = reinterpret_cast<uint64_t *>(subPt.get());
+
+			while(true) {
+				if(Policy::pteIsLargePage(largeEnt)) {
+					for(size_t i = 0; i < (size_t{1} << Policy::bitsPerLevel); i++)
+						tbl[i] = Policy::pteSplitLarge(largeEnt, i);
+				}else if(!Policy::pteTablePresent(largeEnt)) {
+					// The large page was unmapped concurrently.
+					memset(tbl, 0, kPageSize);
+				}else{
+					// Somebody else already installed a table.
+					physicalAllocator->free(subPtPtr, kPageSize);
+					subPt = PageAccessor{Policy::pteTableAddress(largeEnt)};
+					return;
+				}
+				if(__atomic_compare_exchange_n(ptPtr, &largeEnt, tableEnt,
+						false, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+					break;
+			}
+			Policy::pteWriteBarrier();
+		} else {
+			(void)subPt;
+			(void)ptPtr;
+			(void)largeEnt;
+		}
+	}
+
 	void realizeLevel_(size_t level) {
 		if(accessors_[level]) /*[[likely]]*/
 			return;
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+
 #include <thor-internal/arch/ints.hpp>
 
 namespace thor {
@@ -7,7 +9,16 @@ namespace thor {
 struct CpuData;
 
 void sendPingIpi(CpuData *dstData);
+// Broadcast a shootdown IPI to all other CPUs.
 void sendShootdownIpi();
+// Send a shootdown IPI to a single CPU.
+void sendShootdownIpi(CpuData *dstData);
 void sendSelfCallIpi();
 
+// Whether waitOnAddress() is supported (e.g., via MONITOR/MWAIT on x86).
+bool haveWaitOnAddress();
+// Waits until *word differs from value or until an interrupt arrives.
+// Must be called with interrupts disabled; interrupts are enabled on return.
+void waitOnAddress(std::atomic<unsigned int> *word, unsigned int value);
+
 } // namespace thor
@@ -9,6 +9,12 @@ enum {
 	kPageShift = 12
 };
 
+// Size of the pages that are mapped by leaf entries in the second-to-last page table level.
+enum {
+	kLargePageSize = 0x20'0000,
+	kLargePageShift = 21
+};
+
 constexpr Word kPfAccess = 1;
 constexpr Word kPfWrite = 2;
 constexpr Word kPfUser = 4;
@@ -93,12 +93,20 @@ struct CpuData : public PlatformCpuData {
 	bool haveVirtualization;
 
 	int cpuIndex;
+	// NUMA node of this CPU. Zero on systems without NUMA information.
+	int numaNode{0};
+
+	// State of the idle loop. While the idle loop polls this word,
+	// other CPUs can wake it up by storing to it instead of sending an IPI.
+	std::atomic<unsigned int> idleState{0};
 
 	ExecutorContext *executorContext{nullptr};
 	smarter::borrowed_ptr<Thread> activeThread;
 	KernelFiber *activeFiber{nullptr};
 	KernelFiber *wqFiber{nullptr};
 	std::atomic<SelfIntCallBase *> selfIntCallPtr{nullptr};
+	// Set while RcuEngine waits for this CPU to report a quiescent state.
+	std::atomic<bool> rcuExpedite{false};
 	smarter::shared_ptr<WorkQueue> generalWorkQueue;
 	std::atomic<uint64_t> heartbeat;
 
@@ -3,7 +3,6 @@
 #include <async/cancellation.hpp>
 #include <async/oneshot-event.hpp>
 #include <frg/functional.hpp>
-#include <frg/hash_map.hpp>
 #include <frg/list.hpp>
 #include <frg/spinlock.hpp>
 
@@ -49,6 +48,13 @@ concept Futex = requires(F f) {
 	f.read();
 };
 
+// Futexes that support atomic read-modify-write operations (required for wakeOp()).
+template<typename F>
+concept MutableFutex = Futex<F> && requires(F f) {
+	// Atomically replaces the value v by fn(v). Returns the old value.
+	{ f.update([] (unsigned int v) -> unsigned int { return v; }) } -> std::same_as<unsigned int>;
+};
+
 template<typename S>
 concept FutexSpace = requires(S s) {
 	// Provides temporary access to a Futex.
@@ -63,31 +69,44 @@ private:
 		cancelled,
 	};
 
+	struct Bucket;
+
 	// Represents a single waiter.
 	struct Node {
+		// Protected by the mutex of the bucket that contains the node.
+		FutexIdentity id;
+		// Bucket that currently contains the node. This only changes on requeue(),
+		// while holding the mutexes of both the old and the new bucket.
+		// May be read without holding a mutex to determine which mutex to take.
+		std::atomic<Bucket *> bucket{nullptr};
 		State st{State::none};
 		frg::default_list_hook<Node> queueHook;
 		async::oneshot_primitive completionEvent;
 	};
 
-	struct Slot {
-		frg::intrusive_list<
+	using NodeList = frg::intrusive_list<
+		Node,
+		frg::locate_member<
 			Node,
-			frg::locate_member<
-				Node,
-				frg::default_list_hook<Node>,
-				&Node::queueHook
-			>
-		> queue;
+			frg::default_list_hook<Node>,
+			&Node::queueHook
+		>
+	>;
+
+	using Mutex = frg::ticket_spinlock;
+
+	// Waiters of all futexes that hash to the same bucket share a single list.
+	// Buckets are aligned to cache lines to avoid false sharing between their mutexes.
+	struct alignas(64) Bucket {
+		Mutex mutex;
+		NodeList queue;
 	};
 
-public:
-	FutexRealm()
-	: _slots{FutexIdentity::Hash{}, *kernelAlloc} { }
+	static constexpr size_t numBuckets = 256;
+	static_assert(!(numBuckets & (numBuckets - 1)));
 
-	bool empty() {
-		return _slots.empty();
-	}
+public:
+	FutexRealm() = default;
 
 	// ----------------------------------------------------------------------------------
 	// wait().
@@ -97,27 +116,22 @@ public:
 	coroutine<Error> wait(S space, uintptr_t address, unsigned int expected,
 			async::cancellation_token ct = {}) {
 		Node node{};
-		FutexIdentity id;
 
 		bool futexRace = false;
 		auto result = co_await space.withFutex(address, [&](auto futex) {
-			id = futex.getIdentity();
+			node.id = futex.getIdentity();
+			auto bucket = _bucketFor(node.id);
 
 			auto irqLock = frg::guard(&irqMutex());
-			auto lock = frg::guard(&_mutex);
+			auto lock = frg::guard(&bucket->mutex);
 
 			if(futex.read() != expected) {
 				futexRace = true;
 				return;
 			}
 
-			auto sit = _slots.get(id);
-			if(!sit) {
-				_slots.insert(id, Slot());
-				sit = _slots.get(id);
-			}
-
-			sit->queue.push_back(&node);
+			node.bucket.store(bucket, std::memory_order_relaxed);
+			bucket->queue.push_back(&node);
 		});
 		if(!result)
 			co_return result.error();
@@ -130,24 +144,23 @@ public:
 				// Remove the node from the futex's wait list.
 				{
 					auto irqLock = frg::guard(&irqMutex());
-					auto lock = frg::guard(&_mutex);
-
-					if (node.st == State::done)
-						return;
-					assert(node.st == State::none);
-
-					auto sit = _slots.get(id);
-					assert(sit);
-
-					// Invariant: If the slot exists then its queue is not empty.
-					assert(!sit->queue.empty());
 
-					auto nit = sit->queue.iterator_to(&node);
-					sit->queue.erase(nit);
-					node.st = State::cancelled;
-
-					if(sit->queue.empty())
-						_slots.remove(id);
+					// The node can be requeued while we wait for the bucket's mutex.
+					while(true) {
+						auto bucket = node.bucket.load(std::memory_order_relaxed);
+						auto lock = frg::guard(&bucket->mutex);
+						if(node.bucket.load(std::memory_order_relaxed) != bucket)
+							continue;
+
+						if (node.st == State::done)
+							return;
+						assert(node.st == State::none);
+
+						auto nit = bucket->queue.iterator_to(&node);
+						bucket->queue.erase(nit);
+						node.st = State::cancelled;
+						break;
+					}
 				}
 
 				node.completionEvent.raise();
@@ -177,60 +190,184 @@ public:
 		if(!result)
 			co_return result.error();
 
-		frg::intrusive_list<
-			Node,
-			frg::locate_member<
-				Node,
-				frg::default_list_hook<Node>,
-				&Node::queueHook
-			>
-		> pending;
+		NodeList pending;
 		{
+			auto bucket = _bucketFor(id);
+
 			auto irqLock = frg::guard(&irqMutex());
-			auto lock = frg::guard(&_mutex);
+			auto lock = frg::guard(&bucket->mutex);
 
-			auto sit = _slots.get(id);
-			if(!sit)
-				co_return {};
-			// Invariant: If the slot exists then its queue is not empty.
-			assert(!sit->queue.empty());
+			_wakeLocked(bucket, id, count, pending);
+		}
 
-			while(!sit->queue.empty() && count) {
-				auto node = sit->queue.front();
+		_complete(pending);
+		co_return {};
+	}
+
+	// ----------------------------------------------------------------------------------
+	// requeue().
+	// ----------------------------------------------------------------------------------
+
+	// Wakes up to wakeCount waiters of the futex at address and moves up to requeueCount
+	// of the remaining waiters to the futex at target. Fails with Error::futexRace
+	// if the futex at address does not contain the expected value.
+	// This avoids a thundering herd on condition variable broadcasts.
+	template<FutexSpace S>
+	coroutine<frg::expected<Error>> requeue(S space, uintptr_t address, uintptr_t target,
+			unsigned int expected, uint32_t wakeCount, uint32_t requeueCount) {
+		FutexIdentity targetId;
+
+		auto targetResult = co_await space.withFutex(target, [&](auto futex) {
+			targetId = futex.getIdentity();
+		});
+		if(!targetResult)
+			co_return targetResult.error();
+
+		bool futexRace = false;
+		NodeList pending;
+		auto result = co_await space.withFutex(address, [&](auto futex) {
+			auto id = futex.getIdentity();
+			auto bucket = _bucketFor(id);
+			auto targetBucket = _bucketFor(targetId);
+
+			auto irqLock = frg::guard(&irqMutex());
+			_lockPair(bucket, targetBucket);
+
+			if(futex.read() != expected) {
+				futexRace = true;
+				_unlockPair(bucket, targetBucket);
+				return;
+			}
+
+			_wakeLocked(bucket, id, wakeCount, pending);
+
+			auto it = bucket->queue.begin();
+			while(it != bucket->queue.end() && requeueCount) {
+				auto currentIt = it;
+				auto node = *currentIt;
+				++it;
+
+				if(node->id != id)
+					continue;
 				assert(node->st == State::none);
-				sit->queue.pop_front();
 
-				node->st = State::done;
-				pending.push_back(node);
+				node->id = targetId;
+				if(targetBucket != bucket) {
+					bucket->queue.erase(currentIt);
+					node->bucket.store(targetBucket, std::memory_order_relaxed);
+					targetBucket->queue.push_back(node);
+				}
 
-				count--;
+				requeueCount--;
 			}
 
-			if(sit->queue.empty())
-				_slots.remove(id);
-		}
+			_unlockPair(bucket, targetBucket);
+		});
+		if(!result)
+			co_return result.error();
+		if(futexRace)
+			co_return Error::futexRace;
 
-		while(!pending.empty()) {
-			auto node = pending.pop_front();
-			node->completionEvent.raise();
-		}
+		_complete(pending);
+		co_return {};
+	}
+
+	// ----------------------------------------------------------------------------------
+	// wakeOp().
+	// ----------------------------------------------------------------------------------
+
+	// Atomically replaces the value v of the futex at target by op(v).
+	// Then wakes up to count waiters of the futex at address and, if cmp(v) is true,
+	// up to targetCount waiters of the futex at target.
+	// The space needs to provide withMutableFutex() for this operation.
+	template<FutexSpace S, typename Op, typename Cmp>
+	coroutine<frg::expected<Error>> wakeOp(S space, uintptr_t address, uint32_t count,
+			uintptr_t target, uint32_t targetCount, Op op, Cmp cmp) {
+		FutexIdentity id;
+
+		auto idResult = co_await space.withFutex(address, [&](auto futex) {
+			id = futex.getIdentity();
+		});
+		if(!idResult)
+			co_return idResult.error();
+
+		NodeList pending;
+		auto result = co_await space.withMutableFutex(target, [&](MutableFutex auto futex) {
+			auto targetId = futex.getIdentity();
+			auto bucket = _bucketFor(id);
+			auto targetBucket = _bucketFor(targetId);
+
+			auto irqLock = frg::guard(&irqMutex());
+			_lockPair(bucket, targetBucket);
+
+			auto oldValue = futex.update(op);
+			_wakeLocked(bucket, id, count, pending);
+			if(cmp(oldValue))
+				_wakeLocked(targetBucket, targetId, targetCount, pending);
 
+			_unlockPair(bucket, targetBucket);
+		});
+		if(!result)
+			co_return result.error();
+
+		_complete(pending);
 		co_return {};
 	}
 
 private:
-	using Mutex = frg::ticket_spinlock;
+	Bucket *_bucketFor(FutexIdentity id) {
+		return &_buckets[FutexIdentity::Hash{}(id) & (numBuckets - 1)];
+	}
+
+	// Locks two buckets in a consistent order to avoid deadlocks.
+	void _lockPair(Bucket *a, Bucket *b) {
+		if(a == b) {
+			a->mutex.lock();
+		}else if(a < b) {
+			a->mutex.lock();
+			b->mutex.lock();
+		}else{
+			b->mutex.lock();
+			a->mutex.lock();
+		}
+	}
+
+	void _unlockPair(Bucket *a, Bucket *b) {
+		a->mutex.unlock();
+		if(a != b)
+			b->mutex.unlock();
+	}
 
-	// TODO: use a scalable hash table with fine-grained locks to
-	// improve the scalability of the futex algorithm.
-	Mutex _mutex;
+	// Moves up to count waiters of the futex id to the pending list.
+	// The bucket's mutex must be held.
+	void _wakeLocked(Bucket *bucket, FutexIdentity id, uint32_t count, NodeList &pending) {
+		auto it = bucket->queue.begin();
+		while(it != bucket->queue.end() && count) {
+			auto currentIt = it;
+			auto node = *currentIt;
+			++it;
+
+			if(node->id != id)
+				continue;
+			assert(node->st == State::none);
+
+			bucket->queue.erase(currentIt);
+			node->st = State::done;
+			pending.push_back(node);
+
+			count--;
+		}
+	}
+
+	// Must be called without holding any bucket mutex.
+	void _complete(NodeList &pending) {
+		while(!pending.empty()) {
+			auto node = pending.pop_front();
+			node->completionEvent.raise();
+		}
+	}
 
-	frg::hash_map<
-		FutexIdentity,
-		Slot,
-		FutexIdentity::Hash,
-		KernelAlloc
-	> _slots;
+	Bucket _buckets[numBuckets];
 };
 
 } // namespace thor
@@ -130,7 +130,9 @@ private:
 
 	// Move tasks from srcNode to dstNode to balance load.
 	// newLoad: newLoad at dstNode after balancing.
-	void balanceBetween_(LbNode *srcNode, LbNode *dstNode, uint64_t &newLoad, uint64_t idealLoad);
+	// remote: whether srcNode is on a different NUMA node than dstNode.
+	void balanceBetween_(LbNode *srcNode, LbNode *dstNode, uint64_t &newLoad, uint64_t idealLoad,
+			bool remote);
 
 	async::barrier barrier_;
 };
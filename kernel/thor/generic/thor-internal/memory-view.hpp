@@ -10,6 +10,7 @@
 #include <frg/list.hpp>
 #include <frg/rcu_radixtree.hpp>
 #include <frg/shared_ptr.hpp>
+#include <frg/span.hpp>
 #include <frg/vector.hpp>
 #include <frg/expected.hpp>
 #include <thor-internal/arch-generic/paging.hpp>
@@ -29,6 +30,7 @@ enum class ManageRequest {
 
 struct Mapping;
 struct AddressSpace;
+struct BitsetEvent;
 struct AddressSpaceLockHandle;
 struct FaultNode;
 struct MemoryReclaimer;
@@ -334,6 +336,10 @@ public:
 
 	virtual coroutine<frg::expected<Error>> resize(size_t newLength);
 
+	// Returns true if the pages of this view come from the page cache of a file.
+	// Used to decide whether it pays off to map neighbouring pages on faults.
+	virtual bool isFileBacked();
+
 	virtual coroutine<frg::expected<Error, smarter::shared_ptr<MemoryView>>> fork();
 
 	virtual coroutine<frg::expected<Error>> copyTo(uintptr_t offset,
@@ -433,6 +439,7 @@ coroutine<frg::expected<Error>> copyBetweenViews(
 struct ImmediateMemory;
 
 smarter::shared_ptr<MemoryView> getZeroMemory();
+bool isZeroMemory(MemoryView *view);
 
 // Memory that is allocated by the kernel and never swapped out.
 // In contrast to most other memory objects, it can be accessed synchronously.
@@ -564,9 +571,16 @@ private:
 	CachingMode _cacheMode;
 };
 
+// Whether anonymous memory of suitable size is transparently backed by large pages.
+extern bool wantTransparentLargePages;
+
 struct AllocatedMemory final : MemoryView {
+	// If fallbackToSmallPages is true, chunks that cannot be allocated contiguously
+	// are backed by individual pages instead (this is used for large page backing).
+	// Only in this case, peekRange() reports ranges larger than a single page.
 	AllocatedMemory(size_t length, int addressBits = 64,
-			size_t chunkSize = kPageSize, size_t chunkAlign = kPageSize);
+			size_t chunkSize = kPageSize, size_t chunkAlign = kPageSize,
+			bool fallbackToSmallPages = false);
 	AllocatedMemory(const AllocatedMemory &) = delete;
 	~AllocatedMemory();
 
@@ -587,8 +601,12 @@ private:
 	frg::ticket_spinlock _mutex;
 
 	frg::vector<PhysicalAddr, KernelAlloc> _physicalChunks;
+	// For chunks that fell back to small pages, points to an array of
+	// (_chunkSize / kPageSize) pages. Only used if _fallbackToSmallPages is true.
+	frg::vector<PhysicalAddr *, KernelAlloc> _splitChunks;
 	int _addressBits;
 	size_t _chunkSize, _chunkAlign;
+	bool _fallbackToSmallPages;
 };
 
 struct ManagedSpace : CacheBundle {
@@ -688,6 +706,13 @@ struct ManagedSpace : CacheBundle {
 	void submitManagement(ManageNode *node);
 	void _progressManagement(ManageList &pending);
 
+	// Updates the readahead state on an access to the given page.
+	// If necessary, this queues additional pages for initialization.
+	// Must be called with the mutex held.
+	void _updateReadahead(size_t index, bool missing);
+	// Queues all missing pages in [index, index + count) for initialization.
+	void _queueInitialization(size_t index, size_t count);
+
 	smarter::borrowed_ptr<ManagedSpace> selfPtr;
 
 	frg::ticket_spinlock mutex;
@@ -697,6 +722,16 @@ struct ManagedSpace : CacheBundle {
 	size_t numPages;
 	bool readahead;
 
+	// Readahead state. We only track a single sequential stream per ManagedSpace.
+	// Page that a sequential stream is expected to access next.
+	size_t _raNextIndex{0};
+	// End of the most recent readahead window.
+	size_t _raEnd{0};
+	// Size of the most recent readahead window (in pages).
+	size_t _raWindow{0};
+	// Accessing this page triggers asynchronous readahead of the next window.
+	size_t _raMarker{~size_t(0)};
+
 	EvictionQueue _evictQueue;
 
 	frg::intrusive_list<
@@ -766,6 +801,7 @@ public:
 	FrontalMemory &operator= (const FrontalMemory &) = delete;
 
 	size_t getLength() override;
+	bool isFileBacked() override;
 	Error lockRange(uintptr_t offset, size_t size) override;
 	void unlockRange(uintptr_t offset, size_t size) override;
 	PhysicalRange peekRange(uintptr_t offset, FetchFlags flags) override;
@@ -820,15 +856,42 @@ private:
 enum class CowState {
 	null,
 	inProgress,
-	hasCopy
+	hasCopy,
+	// The page's contents are stored in the compressed swap pool.
+	compressed
+};
+
+// Tracks pages that are owned by the compressed swap's reclaim mechanism.
+enum class CowSwapState {
+	none,
+	inReclaimer,
+	performReclaim,
+	avertReclaim,
+	// The page was moved into a CowChain and is no longer subject to compression.
+	detached
 };
 
+struct CopyOnWriteMemory;
+struct CompressedSwap;
+
 struct CowPage {
 	~CowPage();
 
 	PhysicalAddr physical = -1;
 	CowState state = CowState::null;
 	unsigned int lockCount = 0;
+
+	// The following fields are only used while the page is owned by a CopyOnWriteMemory
+	// (i.e., it is not shared through a CowChain). They are protected by the owner's mutex.
+	smarter::weak_ptr<CopyOnWriteMemory> owner;
+	CowSwapState swapState = CowSwapState::none;
+	// Set if compression failed; cleared once the page is dirtied again.
+	bool incompressible = false;
+	CachePage cachePage;
+
+	// Only valid in CowState::compressed.
+	void *compressedData = nullptr;
+	size_t compressedSize = 0;
 };
 
 struct CowChain {
@@ -843,6 +906,8 @@ struct CowChain {
 };
 
 struct CopyOnWriteMemory final : MemoryView /*, MemoryObserver */ {
+	friend struct CompressedSwap;
+
 public:
 	CopyOnWriteMemory(smarter::shared_ptr<MemoryView> view,
 			uintptr_t offset, size_t length,
@@ -854,6 +919,7 @@ public:
 	CopyOnWriteMemory &operator= (const CopyOnWriteMemory &) = delete;
 
 	size_t getLength() override;
+	bool isFileBacked() override;
 	coroutine<frg::expected<Error, smarter::shared_ptr<MemoryView>>> fork() override;
 	Error lockRange(uintptr_t offset, size_t size) override;
 	void unlockRange(uintptr_t offset, size_t size) override;
@@ -876,6 +942,38 @@ private:
 	EvictionQueue _evictQueue;
 };
 
+// Number of bytes that are present in ManagedSpaces.
+size_t getPageCacheSize();
+
+// Maximal number of thresholds per watchMemoryPressure() call.
+inline constexpr size_t maxPressureThresholds = 32;
+
+// Raises bit i of the event once the amount of free memory drops below thresholds[i] bytes.
+// The bit fires again only after free memory has recovered above the threshold.
+// The event is checked by the reclaimer; it is dropped once its last reference goes away.
+Error watchMemoryPressure(smarter::shared_ptr<BitsetEvent> event,
+		frg::span<const uint64_t> thresholds);
+
+struct CompressedSwapStats {
+	// Number of bytes that are stored in compressed form.
+	size_t storedSize;
+	// Number of bytes that the compressed data occupies.
+	size_t poolSize;
+};
+
+CompressedSwapStats getCompressedSwapStats();
+
+struct ReadaheadBounds {
+	// Initial size of the readahead window of ManagedSpaces (in bytes).
+	size_t minSize;
+	// The window doubles on sequential accesses until it reaches this size (in bytes).
+	size_t maxSize;
+};
+
+ReadaheadBounds getReadaheadBounds();
+// Sizes are rounded down to pages; the minimum is at least one page and at most the maximum.
+void setReadaheadBounds(size_t minSize, size_t maxSize);
+
 FutexRealm *getGlobalFutexRealm();
 
 } // namespace thor
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdint.h>
+#include <initgraph.hpp>
+#include <thor-internal/types.hpp>
+
+namespace thor {
+
+struct CpuData;
+
+// Maximal number of NUMA nodes that we keep track of.
+// Proximity domains beyond this limit are folded into node 0.
+inline constexpr int maxNumaNodes = 16;
+
+// Maximal number of memory ranges (e.g., SRAT memory affinity entries) that we keep track of.
+inline constexpr int maxNumaMemoryRanges = 64;
+
+// Distances follow the ACPI SLIT convention: 10 means local access.
+inline constexpr unsigned int numaLocalDistance = 10;
+inline constexpr unsigned int numaRemoteDistance = 20;
+
+// Reached once firmware (ACPI SRAT/SLIT or the DT) has described the NUMA topology.
+// After this stage, the functions below return stable results.
+initgraph::Stage *getNumaDiscoveredStage();
+
+// The following functions are called by the firmware parsers.
+// Proximity domains are firmware-defined and may be sparse;
+// they are mapped to dense node numbers internally.
+void registerNumaMemory(PhysicalAddr base, size_t size, uint32_t domain);
+void registerNumaCpu(uint64_t hardwareId, uint32_t domain);
+void setNumaDistance(uint32_t fromDomain, uint32_t toDomain, unsigned int distance);
+
+int numaNodeCount();
+unsigned int numaDistance(int from, int to);
+
+int numaNodeOfAddress(PhysicalAddr address);
+// Returns the lowest address above the given one at which a memory range begins or ends,
+// i.e., numaNodeOfAddress() is constant between address and the returned boundary.
+// Returns -1 if there is no such address.
+PhysicalAddr numaBoundaryAfter(PhysicalAddr address);
+// The hardware ID is the local APIC ID on x86, the MPIDR affinity on ARM and the hart ID on RISC-V.
+int numaNodeOfCpuHardwareId(uint64_t hardwareId);
+
+} // namespace thor
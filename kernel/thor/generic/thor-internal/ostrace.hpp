@@ -126,5 +126,21 @@ void emit(const Event &event, Args... args) {
 
 extern ostrace::Event ostEvtArmPreemption;
 extern ostrace::Event ostEvtArmCpuTimer;
+extern ostrace::Event ostEvtManagedReadahead;
+extern ostrace::Event ostEvtManagedReadaheadCollapse;
+extern ostrace::Event ostEvtShootdown;
+extern ostrace::Event ostEvtDirectSwitch;
+extern ostrace::Event ostEvtTimerCoalescing;
+extern ostrace::Event ostEvtCompressedSwap;
+extern ostrace::Event ostEvtRcuGracePeriod;
+
+extern ostrace::UintAttribute ostAttrOffset;
+extern ostrace::UintAttribute ostAttrSize;
+extern ostrace::UintAttribute ostAttrTime;
+extern ostrace::UintAttribute ostAttrAlarms;
+extern ostrace::UintAttribute ostAttrTimers;
+extern ostrace::UintAttribute ostAttrPoolSize;
+extern ostrace::UintAttribute ostAttrExpedited;
+extern ostrace::UintAttribute ostAttrBacklog;
 
 } // namespace thor
@@ -8,6 +8,7 @@
 #include <physical-buddy.hpp>
 #include <thor-internal/arch-generic/paging-consts.hpp>
 #include <thor-internal/elf-notes.hpp>
+#include <thor-internal/numa.hpp>
 #include <thor-internal/types.hpp>
 
 namespace thor {
@@ -114,6 +115,35 @@ void poisonPhysicalAccess(PhysicalAddr physical);
 void poisonPhysicalWriteAccess(PhysicalAddr physical);
 
 
+// Per-CPU cache of order-0 pages that sits in front of the buddy allocator.
+// Single page allocations and frees are served from this cache without taking the
+// global allocator lock; the cache is refilled and drained in batches.
+struct PhysicalPageCache {
+	// Maximal number of pages that are kept in the cache.
+	static constexpr size_t capacity = 64;
+	// Number of pages that are moved from/to the buddy allocator at once.
+	static constexpr size_t batchSize = 16;
+	// If the cache grows above this watermark, we drain a batch to the buddy allocator.
+	static constexpr size_t highWatermark = capacity - batchSize;
+
+	// Only contended if another CPU drains this cache on OOM.
+	frg::ticket_spinlock mutex;
+	size_t numPages = 0;
+	PhysicalAddr pages[capacity];
+};
+
+// Per-CPU pool of pages that were zeroed ahead of time.
+// The pool is refilled by a low-priority fiber on each CPU, i.e., pages are only
+// zeroed while the CPU would otherwise be idle.
+struct ZeroedPagePool {
+	// Maximal number of pages that are kept in the pool.
+	static constexpr size_t capacity = 256;
+
+	frg::ticket_spinlock mutex;
+	size_t numPages = 0;
+	PhysicalAddr pages[capacity];
+};
+
 class PhysicalChunkAllocator {
 	typedef frg::ticket_spinlock Mutex;
 public:
@@ -122,31 +152,92 @@ public:
 	void bootstrapRegion(PhysicalAddr address,
 			int order, size_t numRoots, int8_t *buddyTree);
 
+	// Enables the per-CPU page caches. Must be called after the per-CPU
+	// variables of all CPUs have been initialized.
+	void enablePerCpuCaches() {
+		_perCpuCachesEnabled.store(true, std::memory_order_release);
+	}
+
+	// Splits the regions into spans that belong to a single NUMA node. Afterwards, allocations prefer
+	// memory on the NUMA node of the current CPU.
+	// Must be called after the NUMA topology has been discovered.
+	void assignNumaNodes();
+
 	PhysicalAddr allocate(size_t size, int addressBits = 64);
 	void free(PhysicalAddr address, size_t size);
 
+	// Allocates a single page that is filled with zeros.
+	// Takes a page from the current CPU's pool of pre-zeroed pages if possible.
+	PhysicalAddr allocateZeroed(int addressBits = 64);
+
+	// Zeroes a page and adds it to the current CPU's pool.
+	// Returns false if the pool is already full or if memory is low.
+	bool refillZeroedPool();
+
+	// Pages that reside in per-CPU caches or zeroed page pools count as free,
+	// since they are returned to the buddy allocator before an allocation fails.
 	size_t numTotalPages() {
 		return _totalPages.load(std::memory_order_relaxed);
 	}
 	size_t numUsedPages() {
-		return _usedPages.load(std::memory_order_relaxed);
+		auto used = _usedPages.load(std::memory_order_relaxed);
+		auto cached = _numCachedPages();
+		// The counters are not read atomically; do not underflow.
+		return used > cached ? used - cached : 0;
 	}
 	size_t numFreePages() {
-		return _freePages.load(std::memory_order_relaxed);
+		return _freePages.load(std::memory_order_relaxed) + _numCachedPages();
 	}
 
 private:
+	// The following functions require _mutex to be held.
+	// If node is non-negative, regions on that NUMA node are tried first.
+	PhysicalAddr _allocateLocked(int target, int addressBits, int node = -1);
+	void _freeLocked(PhysicalAddr address, int target);
+
+	// Returns the NUMA node of the span that contains address.
+	int _numaNodeOf(PhysicalAddr address);
+
+	// Moves pages from the buddy allocator into the cache (and vice versa).
+	// The cache's mutex must be held.
+	void _refillCache(PhysicalPageCache *cache, int node);
+	void _drainCache(PhysicalPageCache *cache, size_t count);
+
+	// Returns all pages of all per-CPU caches (and zeroed page pools) to the buddy allocator.
+	void _drainAllCaches();
+
+	// Number of pages in all per-CPU caches and zeroed page pools.
+	// This is only a snapshot since the caches are not locked.
+	size_t _numCachedPages();
+
 	Mutex _mutex;
 
+	std::atomic<bool> _perCpuCachesEnabled{false};
+	std::atomic<bool> _numaAware{false};
+
 	struct Region {
 		PhysicalAddr physicalBase;
 		PhysicalAddr regionSize;
 		BuddyAccessor buddyAccessor;
 	};
 
+	// Part of a region that resides on a single NUMA node.
+	struct NumaSpan {
+		int region;
+		PhysicalAddr base;
+		PhysicalAddr limit;
+		int node;
+	};
+
+	// Each boundary of a NUMA memory range splits at most one region.
+	static constexpr int maxNumaSpans = eirMaxMemoryRegions + 2 * maxNumaMemoryRanges;
+
 	Region _allRegions[eirMaxMemoryRegions];
 	int _numRegions = 0;
 
+	NumaSpan _numaSpans[maxNumaSpans];
+	int _numNumaSpans = 0;
+
 	std::atomic<size_t> _totalPages{0};
 	std::atomic<size_t> _usedPages{0};
 	std::atomic<size_t> _freePages{0};
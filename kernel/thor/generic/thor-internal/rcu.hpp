@@ -1,20 +1,30 @@
 #pragma once
 
 #include <optional>
+#include <utility>
 
 #include <async/recurring-event.hpp>
 #include <async/wait-group.hpp>
 #include <frg/list.hpp>
 #include <thor-internal/coroutine.hpp>
 #include <thor-internal/cpu-data.hpp>
+#include <thor-internal/work-queue.hpp>
 
 namespace thor {
 
 // RcuEngine implements an RCU mechanism where disabling scheduling acts as an RCU read-side lock.
 struct RcuEngine {
-	coroutine<void> barrier();
+	// If expedite is true, quiescent states are forced by IPIs instead of waiting
+	// until the work queues of all CPUs get scheduled.
+	coroutine<void> barrier(bool expedite = false);
+
+	// Called on CPU cpu at a point where scheduling is enabled.
+	void reportQuiescentState(CpuData *cpu);
 
 private:
+	coroutine<void> transitionNormal_();
+	coroutine<void> transitionExpedited_();
+
 	// Sequence number of the RCU state transition.
 	static constexpr uint64_t stateSeq = (UINT64_C(1) << 63) - 1;
 	// This bit is set when there is an ongoing state transition.
@@ -26,6 +36,12 @@ private:
 
 	// Used to wait until the transition is done on all CPUs.
 	async::wait_group transitionWg_{0};
+
+	// Number of CPUs that did not report a quiescent state during an expedited transition.
+	std::atomic<size_t> expeditePending_{0};
+	// Posted to expediteWq_ by the CPU that reports the last quiescent state.
+	Worklet expediteWorklet_;
+	WorkQueue *expediteWq_{nullptr};
 };
 
 struct LocalRcuEngine {
@@ -51,7 +67,14 @@ struct LocalRcuEngine {
 			}
 		}
 
+		// Transfers the critical section; this allows callers to keep multiple guards alive.
+		Guard(Guard &&other)
+		: engine_{std::exchange(other.engine_, nullptr)}, c_{other.c_} { }
+
 		~Guard() {
+			if (!engine_)
+				return;
+
 			// Decrease in cs_ the number of active critical sections.
 			// Raise gpEvent_ if the cycle that we are in became non-active and hit a count of zero.
 			auto cs = engine_->cs_.load(std::memory_order_relaxed);
@@ -12,6 +12,9 @@
 
 namespace thor {
 
+// Defined in rcu.cpp.
+void reportRcuQuiescentState(CpuData *cpu);
+
 template<typename ImageAccessor>
 inline bool deferPreemption(ImageAccessor image) {
 	if (image.iplState()->current < ipl::schedule)
@@ -161,6 +164,9 @@ public:
 			return;
 		if (deferPreemption(image))
 			return;
+		// Scheduling is enabled at the interrupted code, hence it is an RCU quiescent state.
+		if (_cpuContext->rcuExpedite.load(std::memory_order_relaxed)) [[unlikely]]
+			reportRcuQuiescentState(_cpuContext);
 		currentRunnable()->handlePreemption(image);
 	}
 
@@ -193,6 +199,11 @@ private:
 	ScheduleEntity *_current;
 	ScheduleEntity *_scheduled = nullptr;
 
+	// Entity that was most recently resumed on this CPU while _current was running.
+	// If _current blocks, we switch directly to this entity (see _schedule()).
+	// Reset whenever _current changes, hence the entity cannot be unassociated in the meantime.
+	ScheduleEntity *_handoff = nullptr;
+
 	frg::pairing_heap<
 		ScheduleEntity,
 		frg::locate_member<
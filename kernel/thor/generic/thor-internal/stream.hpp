@@ -217,6 +217,10 @@ struct Stream final {
 
 	void shutdownLane(int lane);
 
+	// Cancels a node that was transmitted but that is still waiting for its peer.
+	// Returns false if the node was already matched; it completes normally in that case.
+	static bool cancelPending(StreamNode *node);
+
 	Credentials &credentials() {
 		assert(_withCredentials);
 		assert(_creds.has_value());
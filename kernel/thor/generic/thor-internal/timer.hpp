@@ -61,6 +61,12 @@ struct PrecisionTimerNode {
 		_elapsed = elapsed;
 	}
 
+	// The timer may fire up to slack nanoseconds after its deadline.
+	// This allows the engine to coalesce timers into fewer IRQs.
+	void setSlack(uint64_t slack) {
+		_slack = slack;
+	}
+
 	bool wasCancelled() {
 		return _wasCancelled;
 	}
@@ -68,7 +74,16 @@ struct PrecisionTimerNode {
 	frg::pairing_heap_hook<PrecisionTimerNode> hook;
 
 private:
+	// Latest point in time at which the timer should fire.
+	uint64_t _latestDeadline() const {
+		uint64_t latest;
+		if(__builtin_add_overflow(_deadline, _slack, &latest))
+			return UINT64_MAX;
+		return latest;
+	}
+
 	uint64_t _deadline;
+	uint64_t _slack = 0;
 	async::cancellation_token _cancelToken;
 	WorkQueue *_wq;
 	Worklet *_elapsed;
@@ -83,7 +98,7 @@ private:
 
 struct CompareTimer {
 	bool operator() (const PrecisionTimerNode *a, const PrecisionTimerNode *b) const {
-		return a->_deadline > b->_deadline;
+		return a->_latestDeadline() > b->_latestDeadline();
 	}
 };
 
@@ -119,14 +134,17 @@ public:
 		PrecisionTimerEngine *self;
 		uint64_t deadline;
 		async::cancellation_token cancellation;
+		uint64_t slack;
 	};
 
-	SleepSender sleep(uint64_t deadline, async::cancellation_token cancellation = {}) {
-		return {this, deadline, cancellation};
+	SleepSender sleep(uint64_t deadline, async::cancellation_token cancellation = {},
+			uint64_t slack = 0) {
+		return {this, deadline, cancellation, slack};
 	}
 
-	SleepSender sleepFor(uint64_t nanos, async::cancellation_token cancellation = {}) {
-		return {this, getClockNanos() + nanos, cancellation};
+	SleepSender sleepFor(uint64_t nanos, async::cancellation_token cancellation = {},
+			uint64_t slack = 0) {
+		return {this, getClockNanos() + nanos, cancellation, slack};
 	}
 
 	template<typename R>
@@ -144,6 +162,7 @@ public:
 				async::execution::set_value(op->receiver_, !op->node_.wasCancelled());
 			});
 			node_.setup(s_.deadline, s_.cancellation, WorkQueue::generalQueue().get(), &worklet_);
+			node_.setSlack(s_.slack);
 			s_.self->installTimer(&node_);
 		}
 
@@ -168,7 +187,8 @@ public:
 	void firedAlarm();
 
 private:
-	void _progress();
+	// Returns the number of timers that elapsed.
+	size_t _progress();
 
 	CpuData *_ourCpu;
 
@@ -185,6 +205,11 @@ private:
 	> _timerQueue;
 
 	size_t _activeTimers;
+
+	// Statistics about coalescing; reported via ostrace once per statsInterval.
+	uint64_t _statsStart = 0;
+	uint64_t _statsAlarms = 0;
+	uint64_t _statsElapsed = 0;
 };
 
 inline void PrecisionTimerNode::CancelFunctor::operator() () {
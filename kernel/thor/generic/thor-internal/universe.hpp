@@ -1,9 +1,12 @@
 #pragma once
 
+#include <frg/rcu_radixtree.hpp>
 #include <frg/variant.hpp>
 #include <assert.h>
 #include <smarter.hpp>
+#include <thor-internal/ipl.hpp>
 #include <thor-internal/mm-rc.hpp>
+#include <thor-internal/rcu.hpp>
 #include <thor-internal/virtualization.hpp>
 
 namespace thor {
@@ -257,11 +260,59 @@ typedef frg::variant<
 // Universe.
 // --------------------------------------------------------
 
+// Descriptors are stored out-of-line such that lock-free readers can still access them
+// while they are being detached. Cells are only freed after an RCU grace period.
+struct DescriptorCell final : RcuCallable {
+	DescriptorCell(AnyDescriptor descriptor)
+	: descriptor{std::move(descriptor)} { }
+
+	AnyDescriptor descriptor;
+	// Number of lock-free readers that may currently copy from the descriptor.
+	// detachDescriptor() waits for this to drop to zero before it moves the descriptor out.
+	std::atomic<unsigned int> pins{0};
+};
+
+struct DescriptorSlot {
+	DescriptorSlot() = default;
+
+	DescriptorSlot(const DescriptorSlot &) = delete;
+
+	~DescriptorSlot();
+
+	DescriptorSlot &operator= (const DescriptorSlot &) = delete;
+
+	std::atomic<DescriptorCell *> cell{nullptr};
+};
+
 struct Universe {
 public:
 	typedef frg::ticket_spinlock Lock;
 	typedef frg::unique_lock<frg::ticket_spinlock> Guard;
 
+	// RCU read-side critical section for lock-free descriptor lookup.
+	// Pointers returned by getDescriptor(ReadGuard &, ...) are valid until the guard
+	// is destructed. Callers must not modify the descriptor through such pointers.
+	// Since detachDescriptor() waits for readers, callers must not take
+	// Universe::lock while the guard is alive.
+	struct ReadGuard : IplGuard<ipl::schedule> {
+		friend struct Universe;
+
+		ReadGuard() = default;
+
+		ReadGuard(const ReadGuard &) = delete;
+
+		~ReadGuard();
+
+		ReadGuard &operator= (const ReadGuard &) = delete;
+
+	private:
+		// Read-side sections only resolve a few handles.
+		static constexpr int maxPins = 4;
+
+		DescriptorCell *_pins[maxPins];
+		int _numPins = 0;
+	};
+
 	Universe();
 	~Universe();
 
@@ -269,17 +320,17 @@ public:
 
 	AnyDescriptor *getDescriptor(Guard &guard, Handle handle);
 
+	// Lock-free but protected by RCU.
+	AnyDescriptor *getDescriptor(ReadGuard &guard, Handle handle);
+
 	frg::optional<AnyDescriptor> detachDescriptor(Guard &guard, Handle handle);
 
+	// Protects modifications of the descriptor table.
 	Lock lock;
 
 private:
-	frg::hash_map<
-		Handle,
-		AnyDescriptor,
-		frg::hash<Handle>,
-		KernelAlloc
-	> _descriptorMap;
+	// Keyed by handle. Protected by lock for writers, RCU for readers.
+	frg::rcu_radixtree<DescriptorSlot, KernelAlloc, RcuPolicy> _descriptorTree;
 
 	Handle _nextHandle;
 };
@@ -29,6 +29,10 @@ struct WorkQueue {
 
 	void post(Worklet *worklet);
 
+	// Like post() but the Worklet only runs after all Worklets that are already posted.
+	// This allows long-running Worklets to yield to other work on the same queue.
+	void postDeferred(Worklet *worklet);
+
 	// Returns true if a Worklet posted using post() would run immediately.
 	bool immediatelyDispatchable();
 
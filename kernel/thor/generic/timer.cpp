@@ -1,5 +1,6 @@
 #include <thor-internal/cpu-data.hpp>
 #include <thor-internal/debug.hpp>
+#include <thor-internal/ostrace.hpp>
 #include <thor-internal/timer.hpp>
 #include <thor-internal/schedule.hpp>
 
@@ -8,6 +9,9 @@ namespace thor {
 static constexpr bool logTimers = false;
 static constexpr bool logProgress = false;
 
+// Interval (in nanoseconds) at which coalescing statistics are emitted.
+static constexpr uint64_t statsInterval = 1'000'000'000;
+
 
 namespace {
 
@@ -112,7 +116,8 @@ void PrecisionTimerEngine::installTimer(PrecisionTimerNode *timer) {
 	if(logTimers) {
 		auto current = getClockNanos();
 		infoLogger() << "thor: Setting timer at " << timer->_deadline
-				<< " (counter is " << current << ")" << frg::endlog;
+				<< " (slack " << timer->_slack << ", counter is " << current << ")"
+				<< frg::endlog;
 	}
 
 //	infoLogger() << "thor: Active timers: " << _activeTimers << frg::endlog;
@@ -151,17 +156,43 @@ void PrecisionTimerEngine::firedAlarm() {
 	assert(getCpuData() == _ourCpu);
 
 	auto irq_lock = frg::guard(&irqMutex());
-	auto lock = frg::guard(&_mutex);
 
-	_progress();
+	uint64_t alarms = 0;
+	uint64_t elapsed = 0;
+	{
+		auto lock = frg::guard(&_mutex);
+
+		auto n = _progress();
+
+		// The ratio of elapsed timers to alarms is the mean coalescing factor.
+		_statsAlarms++;
+		_statsElapsed += n;
+		auto now = getClockNanos();
+		if(now - _statsStart >= statsInterval) {
+			alarms = _statsAlarms;
+			elapsed = _statsElapsed;
+			_statsStart = now;
+			_statsAlarms = 0;
+			_statsElapsed = 0;
+		}
+	}
+
+	if(alarms)
+		ostrace::emit(ostEvtTimerCoalescing,
+				ostAttrAlarms(alarms), ostAttrTimers(elapsed));
 }
 
 // This function unconditionally calls into setTimerEngineDeadline().
 // This is necessary since we assume that timer IRQs are one shot
 // and not necessarily perfectly accurate.
-void PrecisionTimerEngine::_progress() {
+// Timers are ordered by their latest deadline (i.e., deadline plus slack) and the
+// hardware is programmed for the earliest latest deadline. When the IRQ fires,
+// all timers at the front of the queue whose deadline has passed are completed,
+// even if their slack would allow them to fire later.
+size_t PrecisionTimerEngine::_progress() {
 	assert(getCpuData() == _ourCpu);
 
+	size_t numElapsed = 0;
 	auto current = getClockNanos();
 	do {
 		// Process all timers that elapsed in the past.
@@ -170,7 +201,7 @@ void PrecisionTimerEngine::_progress() {
 		while(true) {
 			if(_timerQueue.empty()) {
 				setTimerEngineDeadline(frg::null_opt);
-				return;
+				return numElapsed;
 			}
 
 			if(_timerQueue.top()->_deadline > current)
@@ -180,6 +211,7 @@ void PrecisionTimerEngine::_progress() {
 			assert(timer->_state == TimerState::queued);
 			_timerQueue.pop();
 			_activeTimers--;
+			numElapsed++;
 			if(logProgress)
 				infoLogger() << "thor: Timer completed" << frg::endlog;
 			if(timer->_cancelCb.try_reset()) {
@@ -193,12 +225,14 @@ void PrecisionTimerEngine::_progress() {
 
 		// Setup the interrupt.
 		assert(!_timerQueue.empty());
-		setTimerEngineDeadline(_timerQueue.top()->_deadline);
+		setTimerEngineDeadline(_timerQueue.top()->_latestDeadline());
 
 		// We iterate if there was a race.
 		// Technically, this is optional but it may help to avoid unnecessary IRQs.
 		current = getClockNanos();
 	} while(_timerQueue.top()->_deadline <= current);
+
+	return numElapsed;
 }
 
 PrecisionTimerEngine *generalTimerEngine() {
@@ -1,13 +1,32 @@
+#include <thor-internal/arch-generic/cpu.hpp>
+#include <thor-internal/arch-generic/ints.hpp>
 #include <thor-internal/universe.hpp>
 
 namespace thor {
 
 namespace {
 	constexpr bool logCleanup = false;
+
+	void retireCell(DescriptorCell *cell) {
+		submitRcu(cell, [] (RcuCallable *base) {
+			frg::destruct(*kernelAlloc, static_cast<DescriptorCell *>(base));
+		});
+	}
+}
+
+DescriptorSlot::~DescriptorSlot() {
+	auto current = cell.exchange(nullptr, std::memory_order_relaxed);
+	if(current)
+		retireCell(current);
+}
+
+Universe::ReadGuard::~ReadGuard() {
+	for(int i = 0; i < _numPins; i++)
+		_pins[i]->pins.fetch_sub(1, std::memory_order_release);
 }
 
 Universe::Universe()
-: _descriptorMap{frg::hash<Handle>{}, *kernelAlloc}, _nextHandle{1} { }
+: _descriptorTree{*kernelAlloc}, _nextHandle{1} { }
 
 Universe::~Universe() {
 	if(logCleanup)
@@ -18,20 +37,73 @@ Handle Universe::attachDescriptor(Guard &guard, AnyDescriptor descriptor) {
 	assert(guard.protects(&lock));
 
 	Handle handle = _nextHandle++;
-	_descriptorMap.insert(handle, std::move(descriptor));
+	auto cell = frg::construct<DescriptorCell>(*kernelAlloc, std::move(descriptor));
+	auto [slot, wasInserted] = _descriptorTree.find_or_insert(handle);
+	assert(wasInserted);
+	// Publish the fully constructed cell to lock-free readers.
+	slot->cell.store(cell, std::memory_order_release);
 	return handle;
 }
 
 AnyDescriptor *Universe::getDescriptor(Guard &guard, Handle handle) {
 	assert(guard.protects(&lock));
 
-	return _descriptorMap.get(handle);
+	if(handle < 0)
+		return nullptr;
+	auto slot = _descriptorTree.find(handle);
+	if(!slot)
+		return nullptr;
+	auto cell = slot->cell.load(std::memory_order_relaxed);
+	assert(cell);
+	return &cell->descriptor;
+}
+
+AnyDescriptor *Universe::getDescriptor(ReadGuard &guard, Handle handle) {
+	if(handle < 0)
+		return nullptr;
+	auto slot = _descriptorTree.find(handle);
+	if(!slot)
+		return nullptr;
+	// The cell is null if we race with attachDescriptor() or detachDescriptor().
+	auto cell = slot->cell.load(std::memory_order_acquire);
+	if(!cell)
+		return nullptr;
+
+	// Pin the cell, then check that it is still attached. Together with the seq_cst
+	// exchange() in detachDescriptor(), either we observe the detach or the detaching
+	// CPU observes our pin and waits until the guard is destructed.
+	cell->pins.fetch_add(1, std::memory_order_seq_cst);
+	if(slot->cell.load(std::memory_order_seq_cst) != cell) {
+		cell->pins.fetch_sub(1, std::memory_order_release);
+		return nullptr;
+	}
+	assert(guard._numPins < ReadGuard::maxPins);
+	guard._pins[guard._numPins++] = cell;
+	return &cell->descriptor;
 }
 
 frg::optional<AnyDescriptor> Universe::detachDescriptor(Guard &guard, Handle handle) {
 	assert(guard.protects(&lock));
 
-	return _descriptorMap.remove(handle);
+	if(handle < 0)
+		return frg::null_opt;
+	auto slot = _descriptorTree.find(handle);
+	if(!slot)
+		return frg::null_opt;
+
+	// Lookups that happen after this point fail.
+	auto cell = slot->cell.exchange(nullptr, std::memory_order_seq_cst);
+	assert(cell);
+	_descriptorTree.erase(handle);
+
+	// Wait for readers that might still copy from the cell. Read-side sections are short
+	// and cannot be preempted. Afterwards, the reference is moved out; only the cell's
+	// memory is freed after the grace period (since late readers still touch pins).
+	while(cell->pins.load(std::memory_order_acquire))
+		pause();
+	frg::optional<AnyDescriptor> descriptor{std::move(cell->descriptor)};
+	retireCell(cell);
+	return descriptor;
 }
 
 } // namespace thor
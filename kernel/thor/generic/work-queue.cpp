@@ -51,6 +51,23 @@ void WorkQueue::post(Worklet *worklet) {
 		wakeup();
 }
 
+void WorkQueue::postDeferred(Worklet *worklet) {
+	// Unlike the fast paths of post(), _lockedQueue is only drained when run() is entered,
+	// hence this is also correct if we are called from within run().
+	bool invokeWakeup;
+	{
+		auto irqLock = frg::guard(&irqMutex());
+		auto lock = frg::guard(&_mutex);
+
+		invokeWakeup = _lockedQueue.empty();
+		_lockedQueue.push_back(worklet);
+		_lockedPosted.store(true, std::memory_order_relaxed);
+	}
+
+	if(invokeWakeup)
+		wakeup();
+}
+
 // immediatelyDispatchable() only returns true if we are already in run();
 // otherwise, WQ entry and exit logic in run() would be skipped.
 // However, immediatelyDispatchable() is more strict than the _inRun code path in post().
@@ -0,0 +1,164 @@
+#include <frg/scope_exit.hpp>
+#include <thor-internal/acpi/acpi.hpp>
+#include <thor-internal/debug.hpp>
+#include <thor-internal/main.hpp>
+#include <thor-internal/numa.hpp>
+
+#include <uacpi/acpi.h>
+#include <uacpi/tables.h>
+
+namespace thor::acpi {
+
+// Similar to the MADT, we mark all SRAT and SLIT structs as [[gnu::packed]].
+
+struct [[gnu::packed]] SratHeader {
+	uint32_t reserved1;
+	uint64_t reserved2;
+};
+
+struct [[gnu::packed]] SratGenericEntry {
+	uint8_t type;
+	uint8_t length;
+};
+
+namespace srat_type {
+static constexpr uint8_t localApicAffinity = 0;
+static constexpr uint8_t memoryAffinity = 1;
+static constexpr uint8_t localX2ApicAffinity = 2;
+static constexpr uint8_t giccAffinity = 3;
+}; // namespace srat_type
+
+namespace srat_flags {
+static constexpr uint32_t enabled = 1;
+}; // namespace srat_flags
+
+struct [[gnu::packed]] SratLocalApicEntry {
+	SratGenericEntry generic;
+	uint8_t proximityDomainLow;
+	uint8_t localApicId;
+	uint32_t flags;
+	uint8_t localSapicEid;
+	uint8_t proximityDomainHigh[3];
+	uint32_t clockDomain;
+};
+
+struct [[gnu::packed]] SratMemoryEntry {
+	SratGenericEntry generic;
+	uint32_t proximityDomain;
+	uint16_t reserved1;
+	uint64_t base;
+	uint64_t length;
+	uint32_t reserved2;
+	uint32_t flags;
+	uint64_t reserved3;
+};
+
+struct [[gnu::packed]] SratLocalX2ApicEntry {
+	SratGenericEntry generic;
+	uint16_t reserved1;
+	uint32_t proximityDomain;
+	uint32_t localX2ApicId;
+	uint32_t flags;
+	uint32_t clockDomain;
+	uint32_t reserved2;
+};
+
+struct [[gnu::packed]] SlitHeader {
+	uint64_t numLocalities;
+};
+
+namespace {
+
+void parseSrat() {
+	uacpi_table sratTbl;
+
+	if (uacpi_table_find_by_signature("SRAT", &sratTbl) != UACPI_STATUS_OK)
+		return;
+	frg::scope_exit finish{[&] { uacpi_table_unref(&sratTbl); }};
+	auto *srat = sratTbl.hdr;
+
+	size_t offset = sizeof(acpi_sdt_hdr) + sizeof(SratHeader);
+	while (offset + sizeof(SratGenericEntry) <= srat->length) {
+		SratGenericEntry generic;
+		auto genericPtr = (void *)(sratTbl.virt_addr + offset);
+		memcpy(&generic, genericPtr, sizeof(generic));
+		if (!generic.length)
+			break;
+
+		switch (generic.type) {
+			case srat_type::localApicAffinity: {
+				SratLocalApicEntry entry;
+				memcpy(&entry, genericPtr, sizeof(SratLocalApicEntry));
+				if (!(entry.flags & srat_flags::enabled))
+					break;
+				uint32_t domain = entry.proximityDomainLow
+						| (entry.proximityDomainHigh[0] << 8)
+						| (entry.proximityDomainHigh[1] << 16)
+						| (entry.proximityDomainHigh[2] << 24);
+				registerNumaCpu(entry.localApicId, domain);
+			} break;
+			case srat_type::memoryAffinity: {
+				SratMemoryEntry entry;
+				memcpy(&entry, genericPtr, sizeof(SratMemoryEntry));
+				if (!(entry.flags & srat_flags::enabled) || !entry.length)
+					break;
+				registerNumaMemory(entry.base, entry.length, entry.proximityDomain);
+			} break;
+			case srat_type::localX2ApicAffinity: {
+				SratLocalX2ApicEntry entry;
+				memcpy(&entry, genericPtr, sizeof(SratLocalX2ApicEntry));
+				if (!(entry.flags & srat_flags::enabled))
+					break;
+				registerNumaCpu(entry.localX2ApicId, entry.proximityDomain);
+			} break;
+			case srat_type::giccAffinity:
+				// Thor only parses ACPI tables on x86 and RISC-V (see want_acpi).
+				// On ARM, the CPU affinity is taken from the numa-node-id properties of the DT.
+				break;
+			default:
+				break;
+		}
+		offset += generic.length;
+	}
+}
+
+void parseSlit() {
+	uacpi_table slitTbl;
+
+	if (uacpi_table_find_by_signature("SLIT", &slitTbl) != UACPI_STATUS_OK)
+		return;
+	frg::scope_exit finish{[&] { uacpi_table_unref(&slitTbl); }};
+	auto *slit = slitTbl.hdr;
+
+	SlitHeader header;
+	memcpy(&header, (void *)(slitTbl.virt_addr + sizeof(acpi_sdt_hdr)), sizeof(SlitHeader));
+
+	size_t offset = sizeof(acpi_sdt_hdr) + sizeof(SlitHeader);
+	auto n = header.numLocalities;
+	if (offset + n * n > slit->length) {
+		infoLogger() << "thor: SLIT is truncated, ignoring it" << frg::endlog;
+		return;
+	}
+
+	auto matrix = reinterpret_cast<const uint8_t *>(slitTbl.virt_addr + offset);
+	for (uint64_t i = 0; i < n; ++i) {
+		for (uint64_t j = 0; j < n; ++j)
+			setNumaDistance(i, j, matrix[i * n + j]);
+	}
+}
+
+} // anonymous namespace
+
+static initgraph::Task parseSratTask{
+    &globalInitEngine,
+    "acpi.parse-srat",
+    initgraph::Requires{getTablesDiscoveredStage()},
+    initgraph::Entails{getNumaDiscoveredStage()},
+    [] {
+	    parseSrat();
+	    // The SLIT refers to proximity domains, hence it needs to be parsed after the SRAT.
+	    parseSlit();
+    }
+};
+
+} // namespace thor::acpi
@@ -0,0 +1,63 @@
+#include <thor-internal/debug.hpp>
+#include <thor-internal/dtb/dtb.hpp>
+#include <thor-internal/main.hpp>
+#include <thor-internal/numa.hpp>
+
+namespace thor {
+
+namespace {
+
+// See the Linux kernel's Documentation/devicetree/bindings/numa.txt.
+void parseDistanceMap(DeviceTreeNode *node) {
+	auto prop = node->dtNode().findProperty("distance-matrix");
+	if (!prop) {
+		infoLogger() << "thor: " << node->path()
+				<< " has no distance-matrix" << frg::endlog;
+		return;
+	}
+
+	// The matrix consists of (from, to, distance) triples of single cells.
+	constexpr size_t entrySize = 3 * sizeof(uint32_t);
+	for (size_t offset = 0; offset + entrySize <= prop->size(); offset += entrySize)
+		setNumaDistance(prop->asU32(offset), prop->asU32(offset + 4), prop->asU32(offset + 8));
+}
+
+} // anonymous namespace
+
+static initgraph::Task parseDtNumaTask{&globalInitEngine, "dt.parse-numa",
+	initgraph::Requires{getDeviceTreeParsedStage()},
+	initgraph::Entails{getNumaDiscoveredStage()},
+	[] {
+		auto root = getDeviceTreeRoot();
+		if (!root)
+			return;
+
+		DeviceTreeNode *distanceMap = nullptr;
+		root->forEach([&](DeviceTreeNode *node) -> bool {
+			if (node->isCompatible<1>({"numa-distance-map-v1"})) {
+				distanceMap = node;
+				return false;
+			}
+
+			auto prop = node->dtNode().findProperty("numa-node-id");
+			if (!prop)
+				return false;
+			auto domain = prop->asU32();
+
+			if (node->name().starts_with("memory@")) {
+				for (auto &reg : node->reg())
+					registerNumaMemory(reg.addr, reg.size, domain);
+			} else if (node->name().starts_with("cpu@")) {
+				if (node->reg().size())
+					registerNumaCpu(node->reg()[0].addr, domain);
+			}
+			return false;
+		});
+
+		// Distances refer to nodes, hence they need to be parsed after all nodes are known.
+		if (distanceMap)
+			parseDistanceMap(distanceMap);
+	}
+};
+
+} // namespace thor
@@ -1,10 +1,14 @@
 #include <async/cancellation.hpp>
 #include <sys/epoll.h>
+#include <algorithm>
+#include <list>
 #include <map>
+#include <optional>
 
 #include <bragi/helpers-std.hpp>
 #include <frg/std_compat.hpp>
 #include <protocols/fs/client.hpp>
+#include <protocols/fs/defs.hpp>
 #include "common.hpp"
 #include "extern_fs.hpp"
 #include "process.hpp"
@@ -16,6 +20,9 @@ namespace extern_fs {
 
 namespace {
 
+// Upper bound on the number of cached directory entries per superblock.
+constexpr size_t maxNameCache = 4096;
+
 struct Node;
 struct DirectoryNode;
 
@@ -45,17 +52,55 @@ struct Superblock final : FsSuperblock {
 	std::shared_ptr<FsLink> internalizePeripheralLink(Node *parent, std::string name,
 			std::shared_ptr<Node> target);
 
+	// Lookups and attributes are cached while the server's change generation matches
+	// the generation up to which we have applied its change notifications.
+	// Returns the current generation or std::nullopt if the caches must not be used.
+	std::optional<uint64_t> cacheGeneration();
+
+	// Returns std::nullopt on cache misses and a null link for cached negative entries.
+	std::optional<std::shared_ptr<FsLink>> lookupName(uint64_t directory, const std::string &name);
+	// Data obtained at generation is only cached if the file system did not change since.
+	void cacheName(std::optional<uint64_t> generation, uint64_t directory, std::string name,
+			std::shared_ptr<FsLink> link);
+
+	async::detached watchChanges();
+
 private:
+	using NameKey = std::pair<uint64_t, std::string>;
+
+	struct NameEntry {
+		std::shared_ptr<FsLink> link;
+		std::list<NameKey>::iterator lruIt;
+	};
+
+	void invalidateInode(uint64_t id);
+	void flushCaches();
+
 	helix::UniqueLane _lane;
 	std::map<uint64_t, std::weak_ptr<DirectoryNode>> _activeStructural;
 	std::map<uint64_t, std::weak_ptr<Node>> _activePeripheralNodes;
 	std::map<std::tuple<uint64_t, std::string, uint64_t>, std::weak_ptr<FsLink>> _activePeripheralLinks;
 
+	helix::Mapping _changePage;
+	uint64_t _appliedGeneration = 0;
+	std::map<NameKey, NameEntry> _nameCache;
+	// Most recently used entries are at the front.
+	std::list<NameKey> _nameLru;
+
 	std::shared_ptr<UnixDevice> device_;
 };
 
 struct Node : FsNode {
+	void invalidateStats() {
+		_cachedStats.reset();
+	}
+
 	async::result<frg::expected<Error, FileStats>> getStats() override {
+		auto sb = static_cast<Superblock *>(superblock());
+		if(_cachedStats && sb->cacheGeneration())
+			co_return *_cachedStats;
+		auto generation = sb->cacheGeneration();
+
 		managarm::fs::CntRequest req;
 		req.set_req_type(managarm::fs::CntReqType::NODE_GET_STATS);
 
@@ -90,6 +135,8 @@ struct Node : FsNode {
 		stats.ctimeSecs = resp.ctime_secs();
 		stats.ctimeNanos = resp.ctime_nanos();
 
+		if(generation && sb->cacheGeneration() == generation)
+			_cachedStats = stats;
 		co_return stats;
 	}
 
@@ -213,6 +260,7 @@ private:
 	std::weak_ptr<Node> _self;
 	uint64_t _inode;
 	helix::UniqueLane _lane;
+	std::optional<FileStats> _cachedStats;
 };
 
 struct OpenFile final : File {
@@ -242,6 +290,12 @@ private:
 		co_return res.transform_error(toPosixError);
 	}
 
+	async::result<std::expected<size_t, Error>>
+	pread(Process *, int64_t offset, void *data, size_t length) override {
+		auto res = co_await _file.pread(offset, data, length);
+		co_return res.transform_error(toPosixError);
+	}
+
 	async::result<frg::expected<Error, PollWaitResult>>
 	pollWait(Process *, uint64_t sequence, int mask,
 			async::cancellation_token cancellation) override {
@@ -561,6 +615,15 @@ private:
 
 	async::result<frg::expected<Error, std::pair<std::shared_ptr<FsLink>, size_t>>>
 	traverseLinks(std::deque<std::string> path) override {
+		if(path.front() != "." && path.front() != "..") {
+			if(auto cached = _sb->lookupName(getInode(), path.front()); cached) {
+				if(!*cached)
+					co_return Error::noSuchFile;
+				co_return std::make_pair(*cached, size_t{1});
+			}
+		}
+		auto generation = _sb->cacheGeneration();
+
 		managarm::fs::NodeTraverseLinksRequest req;
 		for (auto &i : path)
 			req.add_path_segments(i);
@@ -601,8 +664,13 @@ private:
 		auto resp = *bragi::parse_head_tail<managarm::fs::NodeTraverseLinksResponse>(recv_resp, tail);
 		recv_resp.reset();
 
-		if(resp.error() != managarm::fs::Errors::SUCCESS)
+		if(resp.error() != managarm::fs::Errors::SUCCESS) {
+			// We do not know which component is missing if the path has more than one.
+			if(resp.error() == managarm::fs::Errors::FILE_NOT_FOUND && path.size() == 1
+					&& path.front() != "." && path.front() != "..")
+				_sb->cacheName(generation, getInode(), path.front(), nullptr);
 			co_return resp.error() | toPosixError;
+		}
 
 		HEL_CHECK(pull_desc.error());
 		helix::UniqueLane pull_lane = pull_desc.descriptor();
@@ -610,6 +678,12 @@ private:
 		assert(resp.links_traversed());
 		assert(resp.links_traversed() <= path.size());
 
+		// The server resolves dot-dot, hence ids only line up with path without it.
+		bool cacheable = std::none_of(path.begin(), path.begin() + resp.links_traversed(),
+				[] (const std::string &segment) {
+			return segment == "." || segment == "..";
+		});
+
 		std::shared_ptr<Node> parentNode{weakNode()};
 		for (size_t i = 0; i < resp.ids().size(); i++) {
 			auto [pull_node] = co_await helix_ng::exchangeMsgs(
@@ -623,6 +697,8 @@ private:
 					|| resp.file_type() == managarm::fs::FileType::DIRECTORY) {
 				auto child = _sb->internalizeStructural(parentNode.get(), path[i],
 						resp.ids()[i], pull_node.descriptor());
+				if (cacheable)
+					_sb->cacheName(generation, parentNode->getInode(), path[i], child->treeLink());
 				if (i != resp.ids().size() - 1)
 					parentNode = child;
 				else
@@ -631,6 +707,8 @@ private:
 				auto child = _sb->internalizePeripheralNode(resp.file_type(), resp.ids()[i],
 						pull_node.descriptor());
 				link = _sb->internalizePeripheralLink(parentNode.get(), path[i], std::move(child));
+				if (cacheable)
+					_sb->cacheName(generation, parentNode->getInode(), path[i], link);
 			}
 		}
 
@@ -717,6 +795,17 @@ private:
 
 	async::result<frg::expected<Error, std::shared_ptr<FsLink>>>
 			getLink(std::string name) override {
+		// Dot entries of directories change on rename without notifying the directory.
+		bool cacheable = name != "." && name != "..";
+		if(cacheable) {
+			if(auto cached = _sb->lookupName(getInode(), name); cached) {
+				if(!*cached)
+					co_return Error::noSuchFile;
+				co_return *cached;
+			}
+		}
+		auto generation = _sb->cacheGeneration();
+
 		managarm::fs::GetLinkRequest req;
 		req.set_path(name);
 
@@ -739,16 +828,22 @@ private:
 		if(resp.error() == managarm::fs::Errors::SUCCESS) {
 			HEL_CHECK(pull_node.error());
 
+			std::shared_ptr<FsLink> link;
 			if(resp.file_type() == managarm::fs::FileType::DIRECTORY) {
 				auto child = _sb->internalizeStructural(this, name,
 						resp.id(), pull_node.descriptor());
-				co_return child->treeLink();
+				link = child->treeLink();
 			}else{
 				auto child = _sb->internalizePeripheralNode(resp.file_type(), resp.id(),
 						pull_node.descriptor());
-				co_return _sb->internalizePeripheralLink(this, name, std::move(child));
+				link = _sb->internalizePeripheralLink(this, name, std::move(child));
 			}
+			if(cacheable)
+				_sb->cacheName(generation, getInode(), std::move(name), link);
+			co_return link;
 		}else{
+			if(cacheable && resp.error() == managarm::fs::Errors::FILE_NOT_FOUND)
+				_sb->cacheName(generation, getInode(), std::move(name), nullptr);
 			co_return resp.error() | toPosixError;
 		}
 	}
@@ -1045,6 +1140,156 @@ std::shared_ptr<FsLink> Superblock::internalizePeripheralLink(Node *parent, std:
 	return link;
 }
 
+std::optional<uint64_t> Superblock::cacheGeneration() {
+	if(!_changePage)
+		return std::nullopt;
+	auto page = reinterpret_cast<protocols::fs::ChangePage *>(_changePage.get());
+	auto generation = __atomic_load_n(&page->generation, __ATOMIC_ACQUIRE);
+	if(generation != _appliedGeneration)
+		return std::nullopt;
+	return generation;
+}
+
+std::optional<std::shared_ptr<FsLink>> Superblock::lookupName(uint64_t directory,
+		const std::string &name) {
+	if(!cacheGeneration())
+		return std::nullopt;
+	auto it = _nameCache.find({directory, name});
+	if(it == _nameCache.end())
+		return std::nullopt;
+	_nameLru.splice(_nameLru.begin(), _nameLru, it->second.lruIt);
+	return it->second.link;
+}
+
+void Superblock::cacheName(std::optional<uint64_t> generation, uint64_t directory,
+		std::string name, std::shared_ptr<FsLink> link) {
+	if(!generation || cacheGeneration() != generation)
+		return;
+
+	auto [it, inserted] = _nameCache.try_emplace({directory, std::move(name)});
+	if(inserted) {
+		_nameLru.push_front(it->first);
+		it->second.lruIt = _nameLru.begin();
+	}else{
+		_nameLru.splice(_nameLru.begin(), _nameLru, it->second.lruIt);
+	}
+	it->second.link = std::move(link);
+
+	while(_nameCache.size() > maxNameCache) {
+		_nameCache.erase(_nameLru.back());
+		_nameLru.pop_back();
+	}
+}
+
+void Superblock::invalidateInode(uint64_t id) {
+	// Drop all entries of the directory (if the inode is one).
+	auto it = _nameCache.lower_bound({id, std::string{}});
+	while(it != _nameCache.end() && it->first.first == id) {
+		_nameLru.erase(it->second.lruIt);
+		it = _nameCache.erase(it);
+	}
+
+	if(auto structural = _activeStructural.find(id); structural != _activeStructural.end()) {
+		if(auto node = structural->second.lock())
+			node->invalidateStats();
+	}
+	if(auto peripheral = _activePeripheralNodes.find(id); peripheral != _activePeripheralNodes.end()) {
+		if(auto node = peripheral->second.lock())
+			node->invalidateStats();
+	}
+}
+
+void Superblock::flushCaches() {
+	_nameCache.clear();
+	_nameLru.clear();
+
+	for(auto &[id, weak] : _activeStructural) {
+		if(auto node = weak.lock())
+			node->invalidateStats();
+	}
+	for(auto &[id, weak] : _activePeripheralNodes) {
+		if(auto node = weak.lock())
+			node->invalidateStats();
+	}
+}
+
+async::detached Superblock::watchChanges() {
+	managarm::fs::CntRequest req;
+	req.set_req_type(managarm::fs::CntReqType::SB_MAP_CHANGES);
+
+	auto [offer, send_req, recv_resp, pull_page] = co_await helix_ng::exchangeMsgs(
+		_lane,
+		helix_ng::offer(
+			helix_ng::sendBragiHeadOnly(req, frg::stl_allocator{}),
+			helix_ng::recvInline(),
+			helix_ng::pullDescriptor()
+		)
+	);
+	HEL_CHECK(offer.error());
+	HEL_CHECK(send_req.error());
+	HEL_CHECK(recv_resp.error());
+
+	managarm::fs::SvrResponse resp;
+	resp.ParseFromArray(recv_resp.data(), recv_resp.length());
+	recv_resp.reset();
+	// Without change notifications, we cannot cache anything.
+	if(resp.error() != managarm::fs::Errors::SUCCESS)
+		co_return;
+	HEL_CHECK(pull_page.error());
+
+	auto page = helix::Mapping{pull_page.descriptor(), 0, 0x1000, kHelMapProtRead};
+	_appliedGeneration = __atomic_load_n(
+			&reinterpret_cast<protocols::fs::ChangePage *>(page.get())->generation,
+			__ATOMIC_ACQUIRE);
+	_changePage = std::move(page);
+
+	while(true) {
+		managarm::fs::WatchChangesRequest watch_req;
+		watch_req.set_sequence(_appliedGeneration);
+
+		auto [offer, send_req, recv_resp] = co_await helix_ng::exchangeMsgs(
+			_lane,
+			helix_ng::offer(
+				helix_ng::want_lane,
+				helix_ng::sendBragiHeadOnly(watch_req, frg::stl_allocator{}),
+				helix_ng::recvInline()
+			)
+		);
+		HEL_CHECK(offer.error());
+		auto conversation = offer.descriptor();
+		HEL_CHECK(send_req.error());
+		HEL_CHECK(recv_resp.error());
+
+		auto preamble = bragi::read_preamble(recv_resp);
+		assert(!preamble.error());
+
+		std::vector<uint8_t> tail(preamble.tail_size());
+		auto [recv_tail] = co_await helix_ng::exchangeMsgs(
+			conversation,
+			helix_ng::recvBuffer(tail.data(), tail.size())
+		);
+		HEL_CHECK(recv_tail.error());
+
+		auto watch_resp = *bragi::parse_head_tail<managarm::fs::WatchChangesResponse>(
+				recv_resp, tail);
+		recv_resp.reset();
+		if(watch_resp.error() != managarm::fs::Errors::SUCCESS) {
+			std::cout << "posix: Failed to watch extern_fs changes, disabling caches" << std::endl;
+			_changePage = helix::Mapping{};
+			flushCaches();
+			co_return;
+		}
+
+		if(watch_resp.overflow()) {
+			flushCaches();
+		}else{
+			for(auto inode : watch_resp.inodes())
+				invalidateInode(inode);
+		}
+		_appliedGeneration = watch_resp.sequence();
+	}
+}
+
 async::result<frg::expected<Error, FsStats>> Superblock::getFsStats() {
 	managarm::fs::GetFsStatsRequest req;
 
@@ -1091,6 +1336,7 @@ std::shared_ptr<FsLink> createRoot(helix::UniqueLane sb_lane, helix::UniqueLane
 	auto sb = new Superblock{std::move(sb_lane), device};
 	// FIXME: 2 is the ext2fs root inode.
 	auto node = sb->internalizeStructural(2, std::move(lane));
+	sb->watchChanges();
 	return node->treeLink();
 }
 
@@ -22,7 +22,8 @@ async::detached IntervalTimer::arm(std::shared_ptr<IntervalTimer> timer) {
 	timer->nextExpiration_ = timer->initial_;
 
 	if(timer->initial_) {
-		bool awaited = co_await helix::sleepUntil(timer->nextExpiration_, timer->cancelEvt_);
+		bool awaited = co_await helix::sleepUntil(timer->nextExpiration_,
+				timer->cancelEvt_, timer->slack_);
 
 		timer->raise(awaited);
 		if(!awaited)
@@ -34,7 +35,8 @@ async::detached IntervalTimer::arm(std::shared_ptr<IntervalTimer> timer) {
 
 	while(true) {
 		timer->nextExpiration_ = add_sat(timer->nextExpiration_, timer->interval_);
-		auto awaited = co_await helix::sleepUntil(timer->nextExpiration_, timer->cancelEvt_);
+		auto awaited = co_await helix::sleepUntil(timer->nextExpiration_,
+				timer->cancelEvt_, timer->slack_);
 
 		timer->raise(awaited);
 		if(!awaited)
@@ -7,6 +7,10 @@
 
 namespace posix {
 
+// Like Linux' default timer_slack_ns, this allows the kernel to coalesce
+// the expirations of timers from different processes into fewer IRQs.
+inline constexpr uint64_t defaultTimerSlack = 50'000;
+
 struct IntervalTimer {
 	IntervalTimer(uint64_t initial, uint64_t interval)
 		: initial_(initial), interval_(interval) {
@@ -34,6 +38,7 @@ protected:
 	uint64_t initial_ = 0;
 	uint64_t interval_ = 0;
 	uint64_t nextExpiration_ = 0;
+	uint64_t slack_ = defaultTimerSlack;
 
 private:
 	async::cancellation_event cancelEvt_;
@@ -234,5 +234,7 @@ int main() {
 
 	runInit();
 
+	// This does not use multiple helix::Executor workers: process, VFS and file table
+	// state is not synchronized, and requests of different threads access it concurrently.
 	async::run_forever(helix::currentDispatcher);
 }
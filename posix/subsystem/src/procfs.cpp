@@ -19,6 +19,20 @@ namespace procfs {
 
 SuperBlock procfsSuperblock;
 
+namespace {
+
+// Returns the number of bytes that are mapped into the process' address space.
+size_t residentMemory(Process *process) {
+	auto vmContext = process->vmContext();
+	if(!vmContext)
+		return 0;
+	HelMemoryStats stats;
+	HEL_CHECK(helQueryMemoryStats(vmContext->getSpace().getHandle(), &stats));
+	return stats.residentMemory;
+}
+
+} // anonymous namespace
+
 // ----------------------------------------------------------------------------
 // LinkCompare implementation.
 // ----------------------------------------------------------------------------
@@ -860,13 +874,16 @@ async::result<frg::expected<Error, FileStats>> StatNode::getStats() {
 StatmNode::StatmNode(Process *process) : _process(process->weak_from_this()) {}
 
 async::result<std::expected<std::string, Error>> StatmNode::show(Process *) {
-	(void)_process;
-	// All hardcoded to 0.
+	auto p = _process.lock();
+	if (!p)
+		co_return std::unexpected{Error::noSuchProcess};
+
+	// Everything except for the resident set is hardcoded to 0.
 	// See man 5 proc for more details.
 	// Based on the man page from Linux man-pages 6.01, updated on 2022-10-09.
 	std::stringstream stream;
 	stream << "0 "; // size
-	stream << "0 "; // resident
+	stream << residentMemory(p.get()) / 0x1000 << " "; // resident
 	stream << "0 "; // shared
 	stream << "0 "; // text
 	stream << "0 "; // lib
@@ -1033,7 +1050,7 @@ async::result<std::expected<std::string, Error>> StatusNode::show(Process *) {
 	stream << "VmLck: 0 kB\n"; // We don't lock memory.
 	stream << "VmPin: 0 kB\n"; // We don't pin memory.
 	stream << "VmHWM: N/A kB\n";
-	stream << "VmRSS: N/A kB\n";
+	stream << "VmRSS: " << residentMemory(p.get()) / 1024 << " kB\n";
 	stream << "RssAnon: N/A kB\n";
 	stream << "RssFile: N/A kB\n";
 	stream << "RssShmem: N/A kB\n";
@@ -37,6 +37,11 @@ async::result<void> serveRequests(std::shared_ptr<Process> self,
 		HEL_CHECK(helShutdownLane(self->posixLane().getHandle()));
 	}};
 
+	// Each thread has its own posix lane and its own instance of this loop (see
+	// Process::clone()), and a thread only sends its next request after the reply to
+	// the previous one. Serving the requests of a lane in order thus keeps them ordered
+	// without stalling other threads: blocking requests such as WaitId or Accept only
+	// suspend this coroutine.
 	while(true) {
 		auto [accept, recv_head] = co_await helix_ng::exchangeMsgs(
 				self->posixLane(),
@@ -8,6 +8,7 @@
 #include <async/cancellation.hpp>
 #include <frg/expected.hpp>
 #include <helix/ipc.hpp>
+#include <helix/memory.hpp>
 #include <protocols/fs/common.hpp>
 
 namespace protocols {
@@ -29,6 +30,10 @@ struct File {
 	async::result<ReadResult> readSome(void *data, size_t max_length, async::cancellation_token);
 	async::result<size_t> writeSome(const void *data, size_t max_length);
 
+	// Copies data directly from the page cache if the server supports PT_MAP_CACHE.
+	// Falls back to PT_PREAD if the file is resized concurrently.
+	async::result<ReadResult> pread(int64_t offset, void *data, size_t length);
+
 	async::result<frg::expected<Error, PollWaitResult>>
 	pollWait(uint64_t sequence, int mask, async::cancellation_token cancellation = {});
 
@@ -49,9 +54,17 @@ struct File {
 	recvfrom(void *buf, size_t len, int flags, struct sockaddr *addr_ptr, socklen_t addr_length);
 
 private:
+	async::result<void> _mapCache();
+
 	helix::UniqueDescriptor _lane;
 	HelHandle credsToken_;
 	uint64_t cancellationId_ = 1;
+
+	// Set by the first call to pread().
+	bool _cacheRequested = false;
+	// Page cache and CacheStatusPage; null if the server does not support PT_MAP_CACHE.
+	helix::UniqueDescriptor _cacheMemory;
+	helix::Mapping _cacheStatus;
 };
 
 } // namespace _detail
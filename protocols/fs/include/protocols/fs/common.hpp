@@ -52,6 +52,7 @@ enum class Error {
 	noFileDescriptorsAvailable = 34,
 	notSupported = 35,
 	badFileDescriptor = 36,
+	fault = 37,
 };
 
 struct ToFsError {
@@ -98,6 +99,7 @@ inline managarm::fs::Errors operator|(Error e, ToFsError) {
 		case Error::noFileDescriptorsAvailable: return managarm::fs::Errors::NO_FILE_DESCRIPTORS_AVAILABLE;
 		case Error::notSupported: return managarm::fs::Errors::NOT_SUPPORTED;
 		case Error::badFileDescriptor: return managarm::fs::Errors::BAD_FILE_DESCRIPTOR;
+		case Error::fault: return managarm::fs::Errors::FAULT;
 	}
 }
 
@@ -145,6 +147,7 @@ inline Error operator|(managarm::fs::Errors e, ToFsProtoError) {
 		case managarm::fs::Errors::NO_FILE_DESCRIPTORS_AVAILABLE: return Error::noFileDescriptorsAvailable;
 		case managarm::fs::Errors::NOT_SUPPORTED: return Error::notSupported;
 		case managarm::fs::Errors::BAD_FILE_DESCRIPTOR: return Error::badFileDescriptor;
+		case managarm::fs::Errors::FAULT: return Error::fault;
 	}
 }
 
@@ -11,4 +11,18 @@ struct StatusPage {
 	int status;
 };
 
+// Published by servers that allow clients to read file data directly from the page cache.
+// The seqlock is odd while the file is resized. Clients discard data that they copied
+// while the seqlock was odd or while it changed.
+struct CacheStatusPage {
+	uint64_t seqlock;
+	uint64_t fileSize;
+};
+
+// Published by file system servers that report changes to clients (see WatchChangesRequest).
+struct ChangePage {
+	// Incremented on each change before the request that causes it completes.
+	uint64_t generation;
+};
+
 } // namespace protocols::fs
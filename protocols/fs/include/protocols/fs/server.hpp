@@ -7,6 +7,7 @@
 #include <time.h>
 
 #include <async/cancellation.hpp>
+#include <async/recurring-event.hpp>
 #include <async/result.hpp>
 #include <frg/expected.hpp>
 #include <helix/ipc.hpp>
@@ -18,6 +19,7 @@
 
 #include <deque>
 #include <memory>
+#include <optional>
 
 namespace managarm::fs {
 	struct CntRequest;
@@ -76,6 +78,25 @@ using AcceptResult = std::pair<helix::UniqueLane, helix::UniqueLane>;
 using MkdirResult = std::pair<std::shared_ptr<void>, int64_t>;
 using SymlinkResult = std::pair<std::shared_ptr<void>, int64_t>;
 
+// Range of a memory object (e.g., of a page cache) that holds file data.
+struct MemoryRange {
+	helix::BorrowedDescriptor memory;
+	uintptr_t offset;
+	size_t length;
+	// Kept until the data is transferred; e.g., to prevent concurrent truncation.
+	std::shared_ptr<void> hold = {};
+};
+
+using MemoryRangeResult = std::expected<MemoryRange, Error>;
+
+// Returned by PT_MAP_CACHE.
+struct CacheAccess {
+	// Page cache of the file.
+	helix::BorrowedDescriptor memory;
+	// Memory of a CacheStatusProvider.
+	helix::BorrowedDescriptor statusPage;
+};
+
 using TraverseLinksResult = frg::expected<Error, std::tuple<std::vector<std::pair<std::shared_ptr<void>, int64_t>>, FileType, size_t>>;
 
 struct FileOperations {
@@ -178,8 +199,21 @@ struct FileOperations {
 			const void *buffer, size_t length) = nullptr;
 	async::result<frg::expected<protocols::fs::Error, size_t>> (*pwrite)(void *object, int64_t offset, helix_ng::CredentialsView credentials,
 			const void *buffer, size_t length) = nullptr;
+	// If set, READ and PT_PREAD use this instead of read and pread: the data is sent directly
+	// from the returned range, avoiding a copy through an intermediate buffer.
+	// offset is empty for READ; in this case, the file offset is advanced.
+	async::result<MemoryRangeResult> (*readMemoryRange)(void *object, std::optional<int64_t> offset,
+			helix_ng::CredentialsView credentials, size_t length,
+			async::cancellation_token cancellation) = nullptr;
+	// If set, WRITE and PT_PWRITE use this instead of write and pwrite: the data is received
+	// directly into the returned range. The file must already cover the range on return.
+	async::result<MemoryRangeResult> (*writeMemoryRange)(void *object, std::optional<int64_t> offset,
+			helix_ng::CredentialsView credentials, size_t length) = nullptr;
 	async::result<std::expected<protocols::fs::ReadEntriesResult, managarm::fs::Errors>> (*readEntries)(void *object) = nullptr;
 	async::result<helix::BorrowedDescriptor>(*accessMemory)(void *object) = nullptr;
+	// If set, PT_MAP_CACHE allows clients to read data directly from the page cache.
+	// The server must keep the status page up to date (see CacheStatusProvider).
+	async::result<std::expected<CacheAccess, Error>> (*accessCache)(void *object) = nullptr;
 	async::result<frg::expected<protocols::fs::Error>> (*truncate)(void *object, size_t size) = nullptr;
 	async::result<frg::expected<protocols::fs::Error>> (*fallocate)(void *object, int64_t offset, size_t size) = nullptr;
 	async::result<void> (*ioctl)(void *object, uint32_t id, helix_ng::RecvInlineResult req,
@@ -231,6 +265,54 @@ private:
 	helix::Mapping _mapping;
 };
 
+// Maintains a CacheStatusPage. The server never waits for clients: clients detect
+// concurrent resizes through the seqlock and discard the data that they copied.
+struct CacheStatusProvider {
+	CacheStatusProvider(uint64_t fileSize);
+
+	helix::BorrowedDescriptor getMemory() {
+		return _memory;
+	}
+
+	// Must be called before the file is resized. Calls may be nested.
+	void beginResize();
+
+	// Publishes the new file size. Must be called once for each call to beginResize().
+	void endResize(uint64_t fileSize);
+
+private:
+	helix::UniqueDescriptor _memory;
+	helix::Mapping _mapping;
+	// Number of pending resizes. The seqlock is odd while this is non-zero.
+	int _resizes = 0;
+};
+
+// Records changes of directories and inode attributes. This allows clients to cache
+// lookups and attributes: the generation in the ChangePage is incremented before
+// the request that causes a change completes, and clients learn which inodes changed
+// by sending WatchChangesRequests.
+struct ChangeTracker {
+	ChangeTracker();
+
+	helix::BorrowedDescriptor getMemory() {
+		return _memory;
+	}
+
+	// Must be called after the change is visible to other requests.
+	void notify(uint64_t inode);
+
+	// Serves a WatchChangesRequest.
+	async::detached serveWatch(helix::UniqueLane conversation, uint64_t sequence);
+
+private:
+	helix::UniqueDescriptor _memory;
+	helix::Mapping _mapping;
+	uint64_t _generation = 0;
+	// Changes as (generation, inode) pairs, oldest first.
+	std::deque<std::pair<uint64_t, uint64_t>> _log;
+	async::recurring_event _changeEvent;
+};
+
 struct NodeOperations {
 	async::result<FileStats> (*getStats)(std::shared_ptr<void> object);
 
@@ -4,6 +4,7 @@
 
 #include "fs.bragi.hpp"
 #include "protocols/fs/client.hpp"
+#include "protocols/fs/defs.hpp"
 
 namespace protocols {
 namespace fs {
@@ -191,6 +192,100 @@ async::result<size_t> File::writeSome(const void *data, size_t maxLength) {
 	co_return resp.size();
 }
 
+async::result<ReadResult> File::pread(int64_t offset, void *data, size_t length) {
+	if(!_cacheRequested) {
+		_cacheRequested = true;
+		co_await _mapCache();
+	}
+
+	if(_cacheMemory && offset >= 0 && length) {
+		auto page = reinterpret_cast<CacheStatusPage *>(_cacheStatus.get());
+		auto seqlock = __atomic_load_n(&page->seqlock, __ATOMIC_ACQUIRE);
+		auto fileSize = __atomic_load_n(&page->fileSize, __ATOMIC_RELAXED);
+		if(!(seqlock & 1)) {
+			if(static_cast<uint64_t>(offset) >= fileSize)
+				co_return std::unexpected{Error::endOfFile};
+
+			// The kernel copies the data; this does not block the calling thread if
+			// the pages first need to be read from disk. The copy fails if the
+			// file is truncated concurrently.
+			auto chunkSize = std::min(static_cast<uint64_t>(length), fileSize - offset);
+			auto readMemory = co_await helix_ng::readMemory(_cacheMemory,
+					offset, chunkSize, data);
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+			if(!readMemory.error()
+					&& __atomic_load_n(&page->seqlock, __ATOMIC_RELAXED) == seqlock)
+				co_return chunkSize;
+		}
+	}
+
+	managarm::fs::CntRequest req;
+	req.set_req_type(managarm::fs::CntReqType::PT_PREAD);
+	req.set_offset(offset);
+	req.set_size(length);
+
+	auto ser = req.SerializeAsString();
+
+	auto [offer, send_req, imbue_creds, recv_resp, recv_data] =
+		co_await helix_ng::exchangeMsgs(
+			_lane,
+			helix_ng::offer(
+				helix_ng::sendBuffer(ser.data(), ser.size()),
+				helix_ng::imbueCredentials(credsToken_),
+				helix_ng::recvInline(),
+				helix_ng::recvBuffer(data, length)
+			)
+		);
+
+	HEL_CHECK(offer.error());
+	HEL_CHECK(send_req.error());
+	HEL_CHECK(imbue_creds.error());
+	HEL_CHECK(recv_resp.error());
+
+	auto resp = *bragi::parse_head_only<managarm::fs::SvrResponse>(recv_resp);
+	if(resp.error() != managarm::fs::Errors::SUCCESS)
+		co_return std::unexpected{resp.error() | toFsProtoError};
+	// The server fails to send the data if the file is truncated concurrently.
+	if(recv_data.error())
+		co_return std::unexpected{Error::endOfFile};
+	if(length && !recv_data.actualLength())
+		co_return std::unexpected{Error::endOfFile};
+	co_return recv_data.actualLength();
+}
+
+async::result<void> File::_mapCache() {
+	managarm::fs::CntRequest req;
+	req.set_req_type(managarm::fs::CntReqType::PT_MAP_CACHE);
+
+	auto ser = req.SerializeAsString();
+
+	auto [offer, send_req, recv_resp, pull_memory, pull_page] =
+		co_await helix_ng::exchangeMsgs(
+			_lane,
+			helix_ng::offer(
+				helix_ng::sendBuffer(ser.data(), ser.size()),
+				helix_ng::recvInline(),
+				helix_ng::pullDescriptor(),
+				helix_ng::pullDescriptor()
+			)
+		);
+
+	HEL_CHECK(offer.error());
+	HEL_CHECK(send_req.error());
+	// Servers that do not know PT_MAP_CACHE dismiss the request.
+	if(recv_resp.error())
+		co_return;
+
+	auto resp = *bragi::parse_head_only<managarm::fs::SvrResponse>(recv_resp);
+	if(resp.error() != managarm::fs::Errors::SUCCESS)
+		co_return;
+	HEL_CHECK(pull_memory.error());
+	HEL_CHECK(pull_page.error());
+
+	_cacheStatus = helix::Mapping{pull_page.descriptor(), 0, 4096, kHelMapProtRead};
+	_cacheMemory = pull_memory.descriptor();
+}
+
 async::result<frg::expected<Error, PollWaitResult>> File::pollWait(uint64_t sequence, int mask,
 		async::cancellation_token ct) {
 	auto cancelId = cancellationId_++;
@@ -3,6 +3,7 @@
 #include <string.h>
 #include <unistd.h>
 #include <iostream>
+#include <optional>
 #include <print>
 #include <vector>
 
@@ -79,6 +80,55 @@ async::detached handlePassthrough(smarter::shared_ptr<void> file,
 		);
 	};
 
+	// Serves WRITE and PT_PWRITE by receiving the data directly into the page cache.
+	auto writeToMemoryRange = [&] (std::optional<int64_t> offset) -> async::result<void> {
+		auto [extract_creds] = co_await helix_ng::exchangeMsgs(
+			conversation,
+			helix_ng::extractCredentials()
+		);
+		HEL_CHECK(extract_creds.error());
+
+		auto range = co_await file_ops->writeMemoryRange(file.get(), offset,
+				extract_creds.credentials(), req.size());
+
+		managarm::fs::SvrResponse resp;
+		if(!range) {
+			// Drain the data, otherwise the client's send fails.
+			std::vector<uint8_t> buffer;
+			buffer.resize(req.size());
+
+			auto [recv_buffer] = co_await helix_ng::exchangeMsgs(
+				conversation,
+				helix_ng::recvBuffer(buffer.data(), buffer.size())
+			);
+			HEL_CHECK(recv_buffer.error());
+
+			resp.set_error(range.error() | toFsError);
+		}else{
+			auto [recv_memory] = co_await helix_ng::exchangeMsgs(
+				conversation,
+				helix_ng::recvToMemory(range->memory, range->offset, range->length)
+			);
+			range->hold.reset();
+
+			// This fails if the client's buffer is not accessible.
+			if(recv_memory.error()) {
+				resp.set_error(managarm::fs::Errors::FAULT);
+			}else{
+				resp.set_error(managarm::fs::Errors::SUCCESS);
+				resp.set_size(recv_memory.actualLength());
+			}
+		}
+
+		auto ser = resp.SerializeAsString();
+		auto [send_resp] = co_await helix_ng::exchangeMsgs(
+			conversation,
+			helix_ng::sendBuffer(ser.data(), ser.size())
+		);
+		HEL_CHECK(send_resp.error());
+		logBragiSerializedReply(ser);
+	};
+
 	if(req.req_type() == managarm::fs::CntReqType::SEEK_ABS) {
 		if(!file_ops->seekAbs) {
 			managarm::fs::SvrResponse resp;
@@ -182,6 +232,59 @@ async::detached handlePassthrough(smarter::shared_ptr<void> file,
 		);
 		HEL_CHECK(extract_creds.error());
 
+		if(file_ops->readMemoryRange) {
+			auto cancelEvent = cancellationEvents.event(extract_creds.credentials(), req.cancellation_id());
+			if (!cancelEvent) {
+				std::println("protocols/fs: possibly duplicate cancellation ID registered");
+				managarm::fs::SvrResponse resp;
+				resp.set_error(managarm::fs::Errors::INTERNAL_ERROR);
+
+				auto ser = resp.SerializeAsString();
+				auto [send_resp] = co_await helix_ng::exchangeMsgs(
+					conversation,
+					helix_ng::sendBuffer(ser.data(), ser.size())
+				);
+				HEL_CHECK(send_resp.error());
+				logBragiSerializedReply(ser);
+				co_return;
+			}
+
+			auto range = co_await file_ops->readMemoryRange(file.get(), std::nullopt,
+					extract_creds.credentials(), req.size(), cancelEvent);
+
+			managarm::fs::SvrResponse resp;
+			if(!range) {
+				resp.set_error(range.error() | toFsError);
+
+				auto ser = resp.SerializeAsString();
+				auto [send_resp, send_data] = co_await helix_ng::exchangeMsgs(
+					conversation,
+					helix_ng::sendBuffer(ser.data(), ser.size()),
+					helix_ng::sendBuffer(nullptr, 0)
+				);
+				HEL_CHECK(send_resp.error());
+				HEL_CHECK(send_data.error());
+				logBragiSerializedReply(ser);
+				co_return;
+			}
+
+			resp.set_error(managarm::fs::Errors::SUCCESS);
+
+			auto ser = resp.SerializeAsString();
+			auto [send_resp, send_data] = co_await helix_ng::exchangeMsgs(
+				conversation,
+				helix_ng::sendBuffer(ser.data(), ser.size()),
+				helix_ng::sendFromMemory(range->memory, range->offset, range->length)
+			);
+			HEL_CHECK(send_resp.error());
+			// This fails if the file is truncated concurrently.
+			if(send_data.error())
+				std::println("protocols/fs: Failed to send data from memory, error {}",
+						send_data.error());
+			logBragiSerializedReply(ser);
+			co_return;
+		}
+
 		if(!file_ops->read) {
 			managarm::fs::SvrResponse resp;
 			resp.set_error(managarm::fs::Errors::ILLEGAL_OPERATION_TARGET);
@@ -251,6 +354,57 @@ async::detached handlePassthrough(smarter::shared_ptr<void> file,
 		);
 		HEL_CHECK(extract_creds.error());
 
+		if(file_ops->readMemoryRange) {
+			auto cancelEvent = cancellationEvents.event(extract_creds.credentials(), req.cancellation_id());
+			if (!cancelEvent) {
+				std::println("protocols/fs: possibly duplicate cancellation ID registered");
+				managarm::fs::SvrResponse resp;
+				resp.set_error(managarm::fs::Errors::INTERNAL_ERROR);
+
+				auto ser = resp.SerializeAsString();
+				auto [send_resp] = co_await helix_ng::exchangeMsgs(
+					conversation,
+					helix_ng::sendBuffer(ser.data(), ser.size())
+				);
+				HEL_CHECK(send_resp.error());
+				logBragiSerializedReply(ser);
+				co_return;
+			}
+
+			auto range = co_await file_ops->readMemoryRange(file.get(), req.offset(),
+					extract_creds.credentials(), req.size(), cancelEvent);
+
+			managarm::fs::SvrResponse resp;
+			if(!range) {
+				resp.set_error(range.error() | toFsError);
+
+				auto ser = resp.SerializeAsString();
+				auto [send_resp] = co_await helix_ng::exchangeMsgs(
+					conversation,
+					helix_ng::sendBuffer(ser.data(), ser.size())
+				);
+				HEL_CHECK(send_resp.error());
+				logBragiSerializedReply(ser);
+				co_return;
+			}
+
+			resp.set_error(managarm::fs::Errors::SUCCESS);
+
+			auto ser = resp.SerializeAsString();
+			auto [send_resp, send_data] = co_await helix_ng::exchangeMsgs(
+				conversation,
+				helix_ng::sendBuffer(ser.data(), ser.size()),
+				helix_ng::sendFromMemory(range->memory, range->offset, range->length)
+			);
+			HEL_CHECK(send_resp.error());
+			// This fails if the file is truncated concurrently.
+			if(send_data.error())
+				std::println("protocols/fs: Failed to send data from memory, error {}",
+						send_data.error());
+			logBragiSerializedReply(ser);
+			co_return;
+		}
+
 		if(!file_ops->pread) {
 			managarm::fs::SvrResponse resp;
 			resp.set_error(managarm::fs::Errors::ILLEGAL_OPERATION_TARGET);
@@ -294,6 +448,9 @@ async::detached handlePassthrough(smarter::shared_ptr<void> file,
 			HEL_CHECK(send_data.error());
 			logBragiSerializedReply(ser);
 		}
+	}else if(req.req_type() == managarm::fs::CntReqType::WRITE
+			&& file_ops->writeMemoryRange) {
+		co_await writeToMemoryRange(std::nullopt);
 	}else if(req.req_type() == managarm::fs::CntReqType::WRITE) {
 		std::vector<uint8_t> buffer;
 		buffer.resize(req.size());
@@ -345,6 +502,9 @@ async::detached handlePassthrough(smarter::shared_ptr<void> file,
 			HEL_CHECK(send_resp.error());
 			logBragiSerializedReply(ser);
 		}
+	}else if(req.req_type() == managarm::fs::CntReqType::PT_PWRITE
+			&& file_ops->writeMemoryRange) {
+		co_await writeToMemoryRange(req.offset());
 	}else if(req.req_type() == managarm::fs::CntReqType::PT_PWRITE) {
 		std::vector<uint8_t> buffer;
 		buffer.resize(req.size());
@@ -456,6 +616,50 @@ async::detached handlePassthrough(smarter::shared_ptr<void> file,
 		HEL_CHECK(send_resp.error());
 		HEL_CHECK(push_memory.error());
 		logBragiSerializedReply(ser);
+	}else if(req.req_type() == managarm::fs::CntReqType::PT_MAP_CACHE) {
+		if(!file_ops->accessCache) {
+			managarm::fs::SvrResponse resp;
+			resp.set_error(managarm::fs::Errors::ILLEGAL_OPERATION_TARGET);
+
+			auto ser = resp.SerializeAsString();
+			auto [send_resp] = co_await helix_ng::exchangeMsgs(
+				conversation,
+				helix_ng::sendBuffer(ser.data(), ser.size())
+			);
+			HEL_CHECK(send_resp.error());
+			logBragiSerializedReply(ser);
+			co_return;
+		}
+
+		auto access = co_await file_ops->accessCache(file.get());
+
+		managarm::fs::SvrResponse resp;
+		if(!access) {
+			resp.set_error(access.error() | toFsError);
+
+			auto ser = resp.SerializeAsString();
+			auto [send_resp] = co_await helix_ng::exchangeMsgs(
+				conversation,
+				helix_ng::sendBuffer(ser.data(), ser.size())
+			);
+			HEL_CHECK(send_resp.error());
+			logBragiSerializedReply(ser);
+			co_return;
+		}
+
+		resp.set_error(managarm::fs::Errors::SUCCESS);
+
+		auto ser = resp.SerializeAsString();
+		auto [send_resp, push_memory, push_page] = co_await helix_ng::exchangeMsgs(
+			conversation,
+			helix_ng::sendBuffer(ser.data(), ser.size()),
+			helix_ng::pushDescriptor(access->memory),
+			helix_ng::pushDescriptor(access->statusPage)
+		);
+		HEL_CHECK(send_resp.error());
+		HEL_CHECK(push_memory.error());
+		HEL_CHECK(push_page.error());
+		logBragiSerializedReply(ser);
 	}else if(req.req_type() == managarm::fs::CntReqType::PT_TRUNCATE) {
 		if(!file_ops->truncate) {
 			managarm::fs::SvrResponse resp;
@@ -1534,6 +1738,91 @@ void StatusPageProvider::update(uint64_t sequence, int status) {
 	__atomic_store_n(&page->seqlock, seqlock + 2, __ATOMIC_RELEASE);
 }
 
+CacheStatusProvider::CacheStatusProvider(uint64_t fileSize) {
+	size_t page_size = 4096;
+	HelHandle handle;
+	HEL_CHECK(helAllocateMemory(page_size, 0, nullptr, &handle));
+	_memory = helix::UniqueDescriptor{handle};
+	_mapping = helix::Mapping{_memory, 0, page_size};
+
+	auto page = reinterpret_cast<protocols::fs::CacheStatusPage *>(_mapping.get());
+	__atomic_store_n(&page->fileSize, fileSize, __ATOMIC_RELAXED);
+}
+
+void CacheStatusProvider::beginResize() {
+	auto page = reinterpret_cast<protocols::fs::CacheStatusPage *>(_mapping.get());
+
+	if(_resizes++)
+		return;
+	auto seqlock = __atomic_load_n(&page->seqlock, __ATOMIC_RELAXED);
+	assert(!(seqlock & 1));
+	__atomic_store_n(&page->seqlock, seqlock + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+void CacheStatusProvider::endResize(uint64_t fileSize) {
+	auto page = reinterpret_cast<protocols::fs::CacheStatusPage *>(_mapping.get());
+
+	assert(_resizes);
+	__atomic_store_n(&page->fileSize, fileSize, __ATOMIC_RELAXED);
+	if(--_resizes)
+		return;
+	auto seqlock = __atomic_load_n(&page->seqlock, __ATOMIC_RELAXED);
+	assert(seqlock & 1);
+	__atomic_store_n(&page->seqlock, seqlock + 1, __ATOMIC_RELEASE);
+}
+
+namespace {
+
+// Limits the memory consumption if clients do not collect changes.
+constexpr size_t maxChangeLog = 1024;
+
+} // anonymous namespace
+
+ChangeTracker::ChangeTracker() {
+	size_t page_size = 4096;
+	HelHandle handle;
+	HEL_CHECK(helAllocateMemory(page_size, 0, nullptr, &handle));
+	_memory = helix::UniqueDescriptor{handle};
+	_mapping = helix::Mapping{_memory, 0, page_size};
+}
+
+void ChangeTracker::notify(uint64_t inode) {
+	auto page = reinterpret_cast<protocols::fs::ChangePage *>(_mapping.get());
+
+	_generation++;
+	__atomic_store_n(&page->generation, _generation, __ATOMIC_RELEASE);
+
+	_log.push_back({_generation, inode});
+	if(_log.size() > maxChangeLog)
+		_log.pop_front();
+	_changeEvent.raise();
+}
+
+async::detached ChangeTracker::serveWatch(helix::UniqueLane conversation, uint64_t sequence) {
+	while(_generation <= sequence)
+		co_await _changeEvent.async_wait();
+
+	managarm::fs::WatchChangesResponse resp;
+	resp.set_error(managarm::fs::Errors::SUCCESS);
+	resp.set_sequence(_generation);
+	if(_log.empty() || _log.front().first > sequence + 1) {
+		resp.set_overflow(true);
+	}else{
+		for(auto &[generation, inode] : _log) {
+			if(generation > sequence)
+				resp.add_inodes(inode);
+		}
+	}
+
+	auto [send_resp, send_tail] = co_await helix_ng::exchangeMsgs(
+		conversation,
+		helix_ng::sendBragiHeadTail(resp, frg::stl_allocator{})
+	);
+	HEL_CHECK(send_resp.error());
+	HEL_CHECK(send_tail.error());
+}
+
 async::detached serveNode(helix::UniqueLane lane, std::shared_ptr<void> node,
 		const NodeOperations *node_ops) {
 	while(true) {
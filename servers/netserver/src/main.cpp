@@ -884,5 +884,7 @@ int main() {
 
 	async::detach(protocols::svrctl::serveControl(&controlOps));
 	advertise();
+	// This does not use multiple helix::Executor workers: sockets, routes and links are
+	// not synchronized, and packets of all links pass through them.
 	async::run_forever(helix::currentDispatcher);
 }
@@ -1,12 +1,28 @@
+#include <errno.h>
+#include <fcntl.h>
 #include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
 
 #include <async/result.hpp>
 #include <async/algorithm.hpp>
 #include <async/wait-group.hpp>
 #include <helix/ipc.hpp>
+#include <helix/passthrough-fd.hpp>
+#include <protocols/fs/client.hpp>
 
+#include <algorithm>
 #include <atomic>
 #include <print>
+#include <random>
 #include <thread>
 #include <vector>
 
@@ -30,7 +46,7 @@ struct IterationsPerSecondBenchmark {
 		results_.push_back(iters);
 	}
 
-	void finalizeStatistics() {
+	void finalizeStatistics(bool showLatency = false) {
 		double avg = 0;
 		for(uint64_t n : results_)
 			avg += n;
@@ -43,6 +59,9 @@ struct IterationsPerSecondBenchmark {
 
 		std::cout << "    avg: " << static_cast<uint64_t>(avg)
 				<< ", std: " << static_cast<uint64_t>(sqrt(var)) << std::endl;
+		if(showLatency)
+			std::cout << "    latency: " << static_cast<uint64_t>(1'000'000'000 / avg)
+					<< " ns" << std::endl;
 	}
 
 private:
@@ -50,6 +69,71 @@ private:
 	std::chrono::time_point<clock> ref_;
 };
 
+// Runs a benchmark on multiple threads and reports the total number of iterations.
+// Each worker runs numRepetitions repetitions; in each repetition, it calls
+// beginRepetition() once and then performs work while keepRunning() returns true.
+// Thread 0 measures the time and announces the iterations of all threads.
+struct ParallelBenchmark {
+	static constexpr int numRepetitions = 5;
+
+	ParallelBenchmark(unsigned int numThreads)
+	: numThreads_{numThreads} { }
+
+	// Runs worker(c) on threads c = 0, ..., numThreads - 1 and waits for them.
+	template<typename F>
+	void run(F worker) {
+		std::vector<std::thread> threads;
+		threads.reserve(numThreads_);
+		for(unsigned int c = 0; c < numThreads_; ++c)
+			threads.emplace_back(worker, c);
+		for(auto &t : threads)
+			t.join();
+	}
+
+	// Waits until all threads have reached repetition k.
+	void beginRepetition(unsigned int c, int k) {
+		if (barrier_.fetch_add(1, std::memory_order_acquire) + 1 == numThreads_) {
+			barrier_.store(0, std::memory_order_relaxed);
+			stop_.store(false, std::memory_order_relaxed);
+			totalIterations_.store(0, std::memory_order_relaxed);
+			iter_.store(k, std::memory_order_release);
+		}
+		while(iter_.load(std::memory_order_acquire) < k)
+			;
+
+		if (!c)
+			bench_.launchRepetition();
+	}
+
+	bool keepRunning(unsigned int c) {
+		if (c)
+			return !stop_.load(std::memory_order_relaxed);
+
+		if (bench_.isRepetitionDone()) {
+			stop_.store(true, std::memory_order_relaxed);
+			bench_.announceIterations(totalIterations_.load(std::memory_order_acquire));
+			return false;
+		}
+		return true;
+	}
+
+	void addIterations(uint64_t n) {
+		totalIterations_.fetch_add(n, std::memory_order_release);
+	}
+
+	void finalizeStatistics(bool showLatency = false) {
+		bench_.finalizeStatistics(showLatency);
+	}
+
+private:
+	unsigned int numThreads_;
+	IterationsPerSecondBenchmark bench_;
+	std::atomic<unsigned int> barrier_{0};
+	std::atomic<int> iter_{-1};
+	std::atomic<bool> stop_{false};
+	std::atomic<uint64_t> totalIterations_{0};
+};
+
 void doNopBenchmark() {
 	std::cout << "syscall ops" << std::endl;
 
@@ -84,7 +168,7 @@ async::result<void> doAsyncNopBenchmark() {
 		}
 		bench.announceIterations(n);
 	}
-	bench.finalizeStatistics();
+	bench.finalizeStatistics(true);
 }
 
 async::result<void> doMultiSubmitAsyncNopBenchmark() {
@@ -123,57 +207,56 @@ void doParallelAsyncNopBenchmark() {
 	unsigned int numCpus = std::thread::hardware_concurrency();
 	std::cout << "ipc ops (parallel, " << numCpus << " threads)" << std::endl;
 
-	IterationsPerSecondBenchmark bench;
-	std::atomic<unsigned int> barrier{0};
-	std::atomic<int> iter{-1};
-	std::atomic<bool> stop{false};
-	std::atomic<uint64_t> totalIterations{0};
+	ParallelBenchmark bench{numCpus};
 
 	auto worker = [&](unsigned int c) -> async::result<void> {
-		for(int k = 0; k < 5; ++k) {
-			if (barrier.fetch_add(1, std::memory_order_acquire) + 1 == numCpus) {
-				barrier.store(0, std::memory_order_relaxed);
-				stop.store(false, std::memory_order_relaxed);
-				totalIterations.store(0, std::memory_order_relaxed);
-				iter.store(k, std::memory_order_release);
+		for(int k = 0; k < ParallelBenchmark::numRepetitions; ++k) {
+			bench.beginRepetition(c, k);
+			while (bench.keepRunning(c)) {
+				int n = 100;
+				for(int i = 0; i < n; ++i) {
+					auto result = co_await helix_ng::asyncNop();
+					HEL_CHECK(result.error());
+				}
+				bench.addIterations(n);
 			}
-			while(iter.load(std::memory_order_acquire) < k)
-				;
+		}
+	};
 
-			if (!c) {
-				bench.launchRepetition();
-			}
+	bench.run([&](unsigned int c) {
+		async::run(worker(c), helix::currentDispatcher);
+	});
+	bench.finalizeStatistics();
+}
 
-			while (true) {
-				if (!c) {
-					if (bench.isRepetitionDone()) {
-						stop.store(true, std::memory_order_relaxed);
-						bench.announceIterations(totalIterations.load(std::memory_order_acquire));
-						break;
-					}
-				} else {
-					if (stop.load(std::memory_order_relaxed))
-						break;
-				}
+void doParallelHandleLookupBenchmark() {
+	unsigned int numCpus = std::thread::hardware_concurrency();
+	std::cout << "handle lookups (parallel, " << numCpus << " threads)" << std::endl;
+
+	ParallelBenchmark bench{numCpus};
+
+	auto worker = [&](unsigned int c) {
+		// helGetCredentials() does little work apart from resolving the handle.
+		HelHandle lane1, lane2;
+		HEL_CHECK(helCreateStream(&lane1, &lane2, 1));
+
+		for(int k = 0; k < ParallelBenchmark::numRepetitions; ++k) {
+			bench.beginRepetition(c, k);
+			while (bench.keepRunning(c)) {
 				int n = 100;
 				for(int i = 0; i < n; ++i) {
-					auto result = co_await helix_ng::asyncNop();
-					HEL_CHECK(result.error());
+					char creds[16];
+					HEL_CHECK(helGetCredentials(lane1, 0, creds));
 				}
-				totalIterations.fetch_add(n, std::memory_order_release);
+				bench.addIterations(n);
 			}
 		}
+
+		HEL_CHECK(helCloseDescriptor(kHelThisUniverse, lane1));
+		HEL_CHECK(helCloseDescriptor(kHelThisUniverse, lane2));
 	};
 
-	std::vector<std::thread> threads;
-	threads.reserve(numCpus);
-	for(unsigned int c = 0; c < numCpus; ++c) {
-		threads.emplace_back([worker](unsigned int c) {
-			async::run(worker(c), helix::currentDispatcher);
-		}, c);
-	}
-	for(auto &t : threads)
-		t.join();
+	bench.run(worker);
 	bench.finalizeStatistics();
 }
 
@@ -196,6 +279,68 @@ void doFutexBenchmark() {
 	bench.finalizeStatistics();
 }
 
+void doParallelFutexBenchmark() {
+	// Threads are paired up, hence we need an even number of them.
+	unsigned int numThreads = std::max(std::thread::hardware_concurrency() & ~1u, 2u);
+	std::cout << "futex ping-pong (parallel, " << numThreads << " threads)" << std::endl;
+
+	// The two threads of each pair hand a futex word back and forth. Each side parks
+	// on the value that it last observed and the other side changes the value before
+	// waking it, i.e., every round trip involves two blocking waits and two wakes.
+	// Thread 2j runs while the word is 0, thread 2j + 1 runs while it is pingPongOdd.
+	// Once the even thread stops, it sets pingPongStop, which the odd thread resets.
+	constexpr int pingPongOdd = 1;
+	constexpr int pingPongStop = 2;
+	struct alignas(64) PingPong {
+		int word = 0;
+	};
+	std::vector<PingPong> pairs(numThreads / 2);
+
+	ParallelBenchmark bench{numThreads};
+
+	auto worker = [&](unsigned int c) {
+		auto word = &pairs[c / 2].word;
+
+		for(int k = 0; k < ParallelBenchmark::numRepetitions; ++k) {
+			bench.beginRepetition(c, k);
+			if (!(c & 1)) {
+				while (bench.keepRunning(c)) {
+					int n = 100;
+					for(int i = 0; i < n; ++i) {
+						int value;
+						while ((value = __atomic_load_n(word, __ATOMIC_ACQUIRE)))
+							HEL_CHECK(helFutexWait(word, value, -1));
+						__atomic_store_n(word, pingPongOdd, __ATOMIC_RELEASE);
+						HEL_CHECK(helFutexWake(word, 1));
+					}
+					bench.addIterations(n);
+				}
+
+				int value;
+				while ((value = __atomic_load_n(word, __ATOMIC_ACQUIRE)))
+					HEL_CHECK(helFutexWait(word, value, -1));
+				__atomic_store_n(word, pingPongStop, __ATOMIC_RELEASE);
+				HEL_CHECK(helFutexWake(word, 1));
+			} else {
+				while (true) {
+					int value = __atomic_load_n(word, __ATOMIC_ACQUIRE);
+					if (!value) {
+						HEL_CHECK(helFutexWait(word, value, -1));
+						continue;
+					}
+					__atomic_store_n(word, 0, __ATOMIC_RELEASE);
+					HEL_CHECK(helFutexWake(word, 1));
+					if (value == pingPongStop)
+						break;
+				}
+			}
+		}
+	};
+
+	bench.run(worker);
+	bench.finalizeStatistics();
+}
+
 void doAllocateBenchmark(size_t size) {
 	std::cout << "allocate memory, size = " << (size / (1024 * 1024)) << " MiB" << std::endl;
 
@@ -214,8 +359,9 @@ void doAllocateBenchmark(size_t size) {
 	bench.finalizeStatistics();
 }
 
-void doMapBenchmark(size_t size) {
-	std::cout << "memory mapping, size = " << (size / (1024 * 1024)) << " MiB" << std::endl;
+void doMapBenchmark(size_t size, uint32_t allocFlags = 0) {
+	std::cout << "memory mapping, size = " << (size / (1024 * 1024)) << " MiB"
+			<< ((allocFlags & kHelAllocLargePages) ? " (large pages)" : "") << std::endl;
 
 	IterationsPerSecondBenchmark bench;
 	for(int k = 0; k < 5; ++k) {
@@ -223,7 +369,7 @@ void doMapBenchmark(size_t size) {
 		bench.launchRepetition();
 		while(!bench.isRepetitionDone()) {
 			HelHandle handle;
-			HEL_CHECK(helAllocateMemory(size, 0, nullptr, &handle));
+			HEL_CHECK(helAllocateMemory(size, allocFlags, nullptr, &handle));
 			void *window;
 			HEL_CHECK(helMapMemory(handle, kHelNullHandle, nullptr, 0, size,
 					kHelMapProtRead | kHelMapProtWrite, &window));
@@ -270,8 +416,9 @@ void doMapPopulatedBenchmark(size_t size) {
 	HEL_CHECK(helCloseDescriptor(kHelThisUniverse, handle));
 }
 
-void doPageFaultBenchmark(size_t size) {
-	std::cout << "page faults (mapping size = " << (size / (1024 * 1024)) << " MiB)" << std::endl;
+void doPageFaultBenchmark(size_t size, uint32_t allocFlags = 0) {
+	std::cout << "page faults (mapping size = " << (size / (1024 * 1024)) << " MiB"
+			<< ((allocFlags & kHelAllocLargePages) ? ", large pages" : "") << ")" << std::endl;
 
 	IterationsPerSecondBenchmark bench;
 	for(int k = 0; k < 5; ++k) {
@@ -279,7 +426,7 @@ void doPageFaultBenchmark(size_t size) {
 		bench.launchRepetition();
 		while(!bench.isRepetitionDone()) {
 			HelHandle handle;
-			HEL_CHECK(helAllocateMemory(size, 0, nullptr, &handle));
+			HEL_CHECK(helAllocateMemory(size, allocFlags, nullptr, &handle));
 			void *window;
 			HEL_CHECK(helMapMemory(handle, kHelNullHandle, nullptr, 0, size,
 					kHelMapProtRead | kHelMapProtWrite, &window));
@@ -299,6 +446,210 @@ void doPageFaultBenchmark(size_t size) {
 	bench.finalizeStatistics();
 }
 
+// Measures the latency of first-touch page faults. If warmPool is true, we give the kernel time
+// to refill its pool of pre-zeroed pages before each repetition. Otherwise, we drain the pool first.
+void doPageFaultLatencyBenchmark(size_t size, bool warmPool) {
+	using clock = std::chrono::high_resolution_clock;
+
+	std::cout << "page fault latency (mapping size = " << (size / 1024) << " KiB, "
+			<< (warmPool ? "zeroed pool hot" : "zeroed pool cold") << ")" << std::endl;
+
+	auto touchMapping = [] (size_t size) {
+		HelHandle handle;
+		HEL_CHECK(helAllocateMemory(size, 0, nullptr, &handle));
+		void *window;
+		HEL_CHECK(helMapMemory(handle, kHelNullHandle, nullptr, 0, size,
+				kHelMapProtRead | kHelMapProtWrite, &window));
+
+		auto ref = clock::now();
+		auto p = reinterpret_cast<volatile std::byte *>(window);
+		for(size_t progress = 0; progress < size; progress += 0x1000)
+			p[progress] = static_cast<std::byte>(0);
+		auto elapsed = duration_cast<std::chrono::nanoseconds>(clock::now() - ref);
+
+		HEL_CHECK(helUnmapMemory(kHelNullHandle, window, size));
+		HEL_CHECK(helCloseDescriptor(kHelThisUniverse, handle));
+		return elapsed.count();
+	};
+
+	double avg = 0;
+	for(int k = 0; k < 5; ++k) {
+		if(warmPool) {
+			std::this_thread::sleep_for(std::chrono::milliseconds{200});
+		}else{
+			touchMapping(16 << 20);
+		}
+
+		auto latency = touchMapping(size) / (size / 0x1000);
+		std::cout << "    " << latency << " ns per fault" << std::endl;
+		avg += latency;
+	}
+	std::cout << "    avg: " << static_cast<uint64_t>(avg / 5) << " ns" << std::endl;
+}
+
+void doParallelPageFaultBenchmark(size_t size) {
+	unsigned int numCpus = std::thread::hardware_concurrency();
+	std::cout << "page faults (parallel, " << numCpus << " threads, mapping size = "
+			<< (size / (1024 * 1024)) << " MiB)" << std::endl;
+
+	ParallelBenchmark bench{numCpus};
+
+	auto worker = [&](unsigned int c) {
+		for(int k = 0; k < ParallelBenchmark::numRepetitions; ++k) {
+			bench.beginRepetition(c, k);
+			while (bench.keepRunning(c)) {
+
+				HelHandle handle;
+				HEL_CHECK(helAllocateMemory(size, 0, nullptr, &handle));
+				void *window;
+				HEL_CHECK(helMapMemory(handle, kHelNullHandle, nullptr, 0, size,
+						kHelMapProtRead | kHelMapProtWrite, &window));
+
+				// Touch all mapped pages.
+				uint64_t n = 0;
+				auto p = reinterpret_cast<volatile std::byte *>(window);
+				for(size_t progress = 0; progress < size; progress += 0x1000) {
+					p[progress] = static_cast<std::byte>(0);
+					++n;
+				}
+
+				HEL_CHECK(helUnmapMemory(kHelNullHandle, window, size));
+				HEL_CHECK(helCloseDescriptor(kHelThisUniverse, handle));
+				bench.addIterations(n);
+			}
+		}
+	};
+
+	bench.run(worker);
+	bench.finalizeStatistics();
+}
+
+// Measures the latency of fork() + execve() + waitpid() of a (preferably large) binary.
+// This is dominated by the page faults that are taken while loading the program.
+void doExecBenchmark(const char *path) {
+	std::cout << "exec startup (" << path << ")" << std::endl;
+
+	if(access(path, X_OK)) {
+		std::cout << "    skipped, binary is not available" << std::endl;
+		return;
+	}
+
+	IterationsPerSecondBenchmark bench;
+	for(int k = 0; k < 5; ++k) {
+		uint64_t n = 0;
+		bench.launchRepetition();
+		while(!bench.isRepetitionDone()) {
+			auto pid = fork();
+			if(pid < 0) {
+				perror("fork");
+				abort();
+			}
+			if(!pid) {
+				int fd = open("/dev/null", O_WRONLY);
+				if(fd >= 0) {
+					dup2(fd, STDOUT_FILENO);
+					dup2(fd, STDERR_FILENO);
+				}
+				execl(path, path, "--version", nullptr);
+				_exit(127);
+			}
+
+			int status;
+			if(waitpid(pid, &status, 0) != pid) {
+				perror("waitpid");
+				abort();
+			}
+			++n;
+		}
+		bench.announceIterations(n);
+	}
+	bench.finalizeStatistics(true);
+}
+
+// Measures small random reads from the page cache of the benchmark binary.
+// pread() sends a PT_PREAD request to the file system server, while
+// protocols::fs::File::pread() copies the data directly from the page cache.
+async::result<void> doPreadBenchmark(bool cached) {
+	std::cout << "pread, 512 B at random offsets"
+			<< (cached ? " (mapped page cache)" : " (PT_PREAD)") << std::endl;
+
+	int fd = open("/proc/self/exe", O_RDONLY);
+	if(fd < 0) {
+		perror("open");
+		abort();
+	}
+	struct stat st;
+	if(fstat(fd, &st)) {
+		perror("fstat");
+		abort();
+	}
+
+	protocols::fs::File file{helix::BorrowedLane{helix::handleForFd(fd)}.dup()};
+	std::mt19937 prng;
+	std::uniform_int_distribution<off_t> offsets{0, st.st_size - 512};
+
+	char buffer[512];
+	IterationsPerSecondBenchmark bench;
+	for(int k = 0; k < 5; ++k) {
+		uint64_t n = 0;
+		bench.launchRepetition();
+		while(!bench.isRepetitionDone()) {
+			for(int i = 0; i < 100; ++i) {
+				auto offset = offsets(prng);
+				if(cached) {
+					auto result = co_await file.pread(offset, buffer, 512);
+					if(!result || *result != 512) {
+						std::cout << "    protocols::fs::File::pread() failed" << std::endl;
+						abort();
+					}
+				}else{
+					if(pread(fd, buffer, 512, offset) != 512) {
+						perror("pread");
+						abort();
+					}
+				}
+				++n;
+			}
+		}
+		bench.announceIterations(n);
+	}
+	bench.finalizeStatistics(true);
+
+	close(fd);
+}
+
+// Repeatedly stats the same path. On extern_fs mounts, both positive and negative
+// lookups are served from the caches of the posix subsystem.
+void doStatBenchmark(const char *path, bool exists) {
+	std::cout << "stat() of " << (exists ? "existing" : "missing")
+			<< " path (" << path << ")" << std::endl;
+
+	struct stat st;
+	IterationsPerSecondBenchmark bench;
+	for(int k = 0; k < 5; ++k) {
+		uint64_t n = 0;
+		bench.launchRepetition();
+		while(!bench.isRepetitionDone()) {
+			for(int i = 0; i < 100; ++i) {
+				if(exists) {
+					if(stat(path, &st)) {
+						perror("stat");
+						abort();
+					}
+				}else{
+					if(!stat(path, &st) || errno != ENOENT) {
+						std::cout << "    stat() did not fail with ENOENT" << std::endl;
+						abort();
+					}
+				}
+				++n;
+			}
+		}
+		bench.announceIterations(n);
+	}
+	bench.finalizeStatistics(true);
+}
+
 async::result<void> doSendRecvBufferBenchmark(size_t size) {
 	auto [lane1, lane2] = helix::createStream();
 	std::vector<std::byte> sBuf(size);
@@ -415,26 +766,280 @@ void doCrossThreadSendRecvBufferBenchmark(size_t size) {
 	bench.finalizeStatistics();
 }
 
+// Measures the round-trip latency of request/reply messages between two threads.
+// If sameCpu is true, both threads are pinned to the same CPU;
+// this allows the kernel to switch directly between them.
+void doPingPongBenchmark(bool sameCpu) {
+	auto [lane1, lane2] = helix::createStream();
+
+	std::cout << "ping-pong" << (sameCpu ? " (same CPU)" : "") << std::endl;
+
+	auto pin = [sameCpu] {
+		if(!sameCpu)
+			return;
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(0, &set);
+		if(pthread_setaffinity_np(pthread_self(), sizeof(set), &set))
+			std::cout << "    failed to set affinity" << std::endl;
+	};
+
+	// Replies to each request. A non-zero request terminates the server.
+	auto server = [&] () -> async::result<void> {
+		uint8_t buf;
+		while(true) {
+			auto [recv] = co_await helix_ng::exchangeMsgs(lane2, helix_ng::recvBuffer(&buf, 1));
+			HEL_CHECK(recv.error());
+			auto [send] = co_await helix_ng::exchangeMsgs(lane2, helix_ng::sendBuffer(&buf, 1));
+			HEL_CHECK(send.error());
+			if(buf)
+				break;
+		}
+	};
+
+	auto client = [&] () -> async::result<void> {
+		uint8_t buf = 0;
+		auto roundTrip = [&] () -> async::result<void> {
+			auto [send] = co_await helix_ng::exchangeMsgs(lane1, helix_ng::sendBuffer(&buf, 1));
+			HEL_CHECK(send.error());
+			auto [recv] = co_await helix_ng::exchangeMsgs(lane1, helix_ng::recvBuffer(&buf, 1));
+			HEL_CHECK(recv.error());
+		};
+
+		IterationsPerSecondBenchmark bench;
+		for(int k = 0; k < 5; ++k) {
+			uint64_t n = 0;
+			bench.launchRepetition();
+			while(!bench.isRepetitionDone()) {
+				for(int i = 0; i < 100; ++i) {
+					co_await roundTrip();
+					++n;
+				}
+			}
+			bench.announceIterations(n);
+		}
+
+		buf = 1;
+		co_await roundTrip();
+		bench.finalizeStatistics(true);
+	};
+
+	std::thread serverThread([pin, server] {
+		pin();
+		async::run(server(), helix::currentDispatcher);
+	});
+	std::thread clientThread([pin, client] {
+		pin();
+		async::run(client(), helix::currentDispatcher);
+	});
+
+	clientThread.join();
+	serverThread.join();
+}
+
+// Measures the round-trip latency of calls that offer a lane, send a request
+// and receive a reply over it (this is what bragi-based clients do).
+// If sync is true, helCallLane() and helReplyAndWait() are used,
+// otherwise both sides submit their actions asynchronously.
+void doCallLaneBenchmark(bool sync) {
+	auto [lane1, lane2] = helix::createStream();
+
+	std::cout << "call lane" << (sync ? " (synchronous)" : " (asynchronous)") << std::endl;
+
+	// Replies to each call. A non-zero request terminates the server.
+	auto server = [&, sync] () -> async::result<void> {
+		if(sync) {
+			uint8_t req = 0;
+			uint8_t resp = 0;
+			HelHandle conversation = kHelNullHandle;
+			bool done = false;
+			while(true) {
+				HelLaneMessage msg{
+					.sendBuffer = &resp,
+					.sendLength = 1,
+					.recvBuffer = &req,
+					.recvMaxLength = 1,
+					.recvLength = 0,
+					.handle = kHelNullHandle
+				};
+				HEL_CHECK(helReplyAndWait(conversation,
+						done ? kHelNullHandle : lane2.getHandle(), 0, &msg));
+				if(done)
+					break;
+				conversation = msg.handle;
+				done = req;
+			}
+			co_return;
+		}
+
+		while(true) {
+			auto [accept, recv] = co_await helix_ng::exchangeMsgs(
+				lane2,
+				helix_ng::accept(
+					helix_ng::recvInline()
+				)
+			);
+			HEL_CHECK(accept.error());
+			HEL_CHECK(recv.error());
+			auto conversation = accept.descriptor();
+			bool done = *static_cast<const uint8_t *>(recv.data());
+
+			uint8_t resp = 0;
+			auto [send] = co_await helix_ng::exchangeMsgs(
+				conversation,
+				helix_ng::sendBuffer(&resp, 1)
+			);
+			HEL_CHECK(send.error());
+			if(done)
+				break;
+		}
+	};
+
+	auto client = [&, sync] () -> async::result<void> {
+		uint8_t req = 0;
+		auto call = [&] () -> async::result<void> {
+			if(sync) {
+				auto result = helix_ng::callLane(lane1, &req, 1, 1);
+				HEL_CHECK(result.error());
+				assert(result.size() == 1);
+				co_return;
+			}
+
+			auto [offer, send, recv] = co_await helix_ng::exchangeMsgs(
+				lane1,
+				helix_ng::offer(
+					helix_ng::sendBuffer(&req, 1),
+					helix_ng::recvInline()
+				)
+			);
+			HEL_CHECK(offer.error());
+			HEL_CHECK(send.error());
+			HEL_CHECK(recv.error());
+		};
+
+		IterationsPerSecondBenchmark bench;
+		for(int k = 0; k < 5; ++k) {
+			uint64_t n = 0;
+			bench.launchRepetition();
+			while(!bench.isRepetitionDone()) {
+				for(int i = 0; i < 100; ++i) {
+					co_await call();
+					++n;
+				}
+			}
+			bench.announceIterations(n);
+		}
+
+		req = 1;
+		co_await call();
+		bench.finalizeStatistics(true);
+	};
+
+	std::thread serverThread([server] {
+		async::run(server(), helix::currentDispatcher);
+	});
+	std::thread clientThread([client] {
+		async::run(client(), helix::currentDispatcher);
+	});
+
+	clientThread.join();
+	serverThread.join();
+}
+
+#if defined(__x86_64__)
+// Measures the cost of a context switch (in cycles) between two threads on the same CPU.
+// If dirtyAvx is true, both threads modify AVX state before each switch,
+// such that the kernel cannot skip saving the AVX components.
+void doSimdSwitchBenchmark(bool dirtyAvx) {
+	if(dirtyAvx && !__builtin_cpu_supports("avx"))
+		return;
+
+	std::cout << "context switch" << (dirtyAvx ? " (dirty AVX state)" : "") << std::endl;
+
+	auto pin = [] {
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(0, &set);
+		if(pthread_setaffinity_np(pthread_self(), sizeof(set), &set))
+			std::cout << "    failed to set affinity" << std::endl;
+	};
+
+	auto dirty = [dirtyAvx] {
+		if(dirtyAvx)
+			asm volatile ("vpcmpeqd %%ymm15, %%ymm15, %%ymm15" : : : "xmm15");
+	};
+
+	std::atomic<bool> stop{false};
+	std::thread partner([&] {
+		pin();
+		while(!stop.load(std::memory_order_relaxed)) {
+			dirty();
+			HEL_CHECK(helYield());
+		}
+	});
+
+	std::thread measure([&] {
+		pin();
+		for(int k = 0; k < 5; ++k) {
+			constexpr uint64_t iterations = 100'000;
+			auto start = __rdtsc();
+			for(uint64_t i = 0; i < iterations; ++i) {
+				dirty();
+				HEL_CHECK(helYield());
+			}
+			// Each iteration switches to the partner and back.
+			auto cycles = (__rdtsc() - start) / (2 * iterations);
+			std::cout << "    " << cycles << " cycles per switch" << std::endl;
+		}
+		stop.store(true, std::memory_order_relaxed);
+	});
+
+	measure.join();
+	partner.join();
+}
+#endif
+
 } // anonymous namespace
 
-int main() {
+int main(int argc, char **argv) {
 	doNopBenchmark();
 	doFutexBenchmark();
 	async::run(doAsyncNopBenchmark(), helix::currentDispatcher);
 	async::run(doMultiSubmitAsyncNopBenchmark(), helix::currentDispatcher);
 	doParallelAsyncNopBenchmark();
+	doParallelHandleLookupBenchmark();
+	doParallelFutexBenchmark();
 	doAllocateBenchmark(1 << 20);
 	doMapBenchmark(1 << 20);
 	doMapPopulatedBenchmark(1 << 20);
 	doPageFaultBenchmark(1 << 20);
-	async::run(doSendRecvBufferBenchmark(1), helix::currentDispatcher);
-	async::run(doSendRecvBufferBenchmark(4096), helix::currentDispatcher);
-	async::run(doSendRecvBufferBenchmark(16 * 1024), helix::currentDispatcher);
-	async::run(doSendRecvBufferBenchmark(64 * 1024), helix::currentDispatcher);
-	async::run(doSendRecvBufferBenchmark(1024 * 1024), helix::currentDispatcher);
-	doCrossThreadSendRecvBufferBenchmark(1);
-	doCrossThreadSendRecvBufferBenchmark(4096);
-	doCrossThreadSendRecvBufferBenchmark(16 * 1024);
-	doCrossThreadSendRecvBufferBenchmark(64 * 1024);
-	doCrossThreadSendRecvBufferBenchmark(1024 * 1024);
+	doPageFaultLatencyBenchmark(512 << 10, true);
+	doPageFaultLatencyBenchmark(512 << 10, false);
+	doParallelPageFaultBenchmark(1 << 20);
+	doMapBenchmark(32 << 20);
+	doMapBenchmark(32 << 20, kHelAllocLargePages);
+	doPageFaultBenchmark(32 << 20);
+	doPageFaultBenchmark(32 << 20, kHelAllocLargePages);
+	// By default, use a large dynamically linked binary that is part of every image.
+	doExecBenchmark((argc > 1) ? argv[1] : "/usr/bin/udevadm");
+	async::run(doPreadBenchmark(false), helix::currentDispatcher);
+	async::run(doPreadBenchmark(true), helix::currentDispatcher);
+	doStatBenchmark("/usr/lib", true);
+	doStatBenchmark("/usr/lib/kernel-bench-missing.so", false);
+	const size_t bufferSizes[] = {
+		1, 4096, 16 * 1024, 64 * 1024, 256 * 1024,
+		1024 * 1024, 4 * 1024 * 1024, 16 * 1024 * 1024
+	};
+	for(auto size : bufferSizes)
+		async::run(doSendRecvBufferBenchmark(size), helix::currentDispatcher);
+	for(auto size : bufferSizes)
+		doCrossThreadSendRecvBufferBenchmark(size);
+	doPingPongBenchmark(false);
+	doPingPongBenchmark(true);
+	doCallLaneBenchmark(false);
+	doCallLaneBenchmark(true);
+#if defined(__x86_64__)
+	doSimdSwitchBenchmark(false);
+	doSimdSwitchBenchmark(true);
+#endif
 }
@@ -0,0 +1,119 @@
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <lz-compress.hpp>
+
+#include "testsuite.hpp"
+
+namespace {
+
+constexpr size_t pageSize = 0x1000;
+
+// Same limit as thor's compressed swap.
+constexpr size_t maxCompressedSize = pageSize * 3 / 4;
+
+common::LzWorkspace workspace;
+
+// Returns the compressed size or zero if the page is incompressible.
+size_t roundTrip(const std::vector<uint8_t> &page, size_t capacity) {
+	std::vector<uint8_t> compressed(capacity);
+	auto size = common::lzCompress(page.data(), page.size(),
+			compressed.data(), compressed.size(), &workspace);
+	if(!size)
+		return 0;
+	assert(size <= capacity);
+
+	std::vector<uint8_t> decompressed(page.size(), 0xCC);
+	assert(common::lzDecompress(compressed.data(), size, decompressed.data(), page.size()));
+	assert(decompressed == page);
+	return size;
+}
+
+std::vector<uint8_t> randomPage(uint32_t seed) {
+	std::vector<uint8_t> page(pageSize);
+	for(auto &b : page) {
+		seed = seed * 1103515245 + 12345;
+		b = seed >> 24;
+	}
+	return page;
+}
+
+} // anonymous namespace
+
+DEFINE_TEST(lzZeroPage, ([] {
+	std::vector<uint8_t> page(pageSize, 0);
+	auto size = roundTrip(page, maxCompressedSize);
+	assert(size && size < 64);
+}))
+
+DEFINE_TEST(lzIncompressiblePage, ([] {
+	auto page = randomPage(42);
+	assert(!roundTrip(page, maxCompressedSize));
+
+	// Literal-only output still round trips if there is enough space.
+	assert(roundTrip(page, 2 * pageSize) > pageSize);
+}))
+
+DEFINE_TEST(lzMixedPage, ([] {
+	// Text, runs, repeated structures and random bytes.
+	auto page = randomPage(7);
+	const char *text = "The quick brown fox jumps over the lazy dog. ";
+	for(size_t i = 0; i < 0x400; i++)
+		page[i] = text[i % strlen(text)];
+	memset(page.data() + 0x400, 0xFF, 0x300);
+	for(size_t i = 0x800; i < 0xC00; i += 16) {
+		uint64_t entry[2] = {0x7F0000001000 + i, i};
+		memcpy(page.data() + i, entry, sizeof(entry));
+	}
+
+	auto size = roundTrip(page, maxCompressedSize);
+	assert(size && size < pageSize / 2);
+
+	// Matches that overlap their own output (i.e., short periods) are handled as well.
+	for(size_t period : {1, 2, 3, 7}) {
+		std::vector<uint8_t> runs(pageSize);
+		for(size_t i = 0; i < pageSize; i++)
+			runs[i] = i % period;
+		assert(roundTrip(runs, maxCompressedSize));
+	}
+}))
+
+DEFINE_TEST(lzMalformedInput, ([] {
+	auto page = randomPage(1);
+	memset(page.data(), 0, 0x800);
+	std::vector<uint8_t> compressed(2 * pageSize);
+	auto size = common::lzCompress(page.data(), page.size(),
+			compressed.data(), compressed.size(), &workspace);
+	assert(size);
+
+	std::vector<uint8_t> out(pageSize);
+	// Truncated input.
+	for(size_t n : {size_t{0}, size_t{1}, size_t{3}, size / 2, size - 1})
+		assert(!common::lzDecompress(compressed.data(), n, out.data(), pageSize));
+
+	// Output size does not match.
+	assert(!common::lzDecompress(compressed.data(), size, out.data(), pageSize - 1));
+	assert(!common::lzDecompress(compressed.data(), size, out.data(), pageSize + 1));
+
+	// Match offsets that point before the start of the output.
+	const uint8_t zeroOffset[] = {0x10, 'a', 0x00, 0x00, 0x00};
+	assert(!common::lzDecompress(zeroOffset, sizeof(zeroOffset), out.data(), pageSize));
+	const uint8_t farOffset[] = {0x10, 'a', 0x02, 0x00, 0x00};
+	assert(!common::lzDecompress(farOffset, sizeof(farOffset), out.data(), pageSize));
+
+	// Matches and extra lengths that overrun the output.
+	const uint8_t longMatch[] = {0x1F, 'a', 0x01, 0x00, 0xFF, 0xFF, 0xFF, 0xFF,
+			0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+			0xFF, 0x00, 0x00};
+	assert(!common::lzDecompress(longMatch, sizeof(longMatch), out.data(), 0x100));
+	const uint8_t unterminated[] = {0xF0, 0xFF, 0xFF};
+	assert(!common::lzDecompress(unterminated, sizeof(unterminated), out.data(), pageSize));
+
+	// Random garbage must not crash the decompressor.
+	for(uint32_t seed = 0; seed < 256; seed++) {
+		auto garbage = randomPage(seed);
+		common::lzDecompress(garbage.data(), 1 + seed * 13, out.data(), pageSize);
+	}
+}))
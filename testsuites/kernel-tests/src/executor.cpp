@@ -0,0 +1,107 @@
+#include <cassert>
+#include <cstring>
+
+#include <async/algorithm.hpp>
+#include <async/cancellation.hpp>
+#include <async/result.hpp>
+#include <helix/executor.hpp>
+#include <helix/ipc.hpp>
+#include <helix/timer.hpp>
+
+#include "testsuite.hpp"
+
+namespace {
+
+// The calling thread becomes worker 0. Since the other workers run forever,
+// all tests share a single executor that is never destroyed.
+helix::Executor &getExecutor() {
+	static auto executor = new helix::Executor{3};
+	return *executor;
+}
+
+async::result<void> testScheduleAcrossWorkers(helix::Executor &executor) {
+	assert(helix::Executor::currentWorker() == 0);
+
+	for(unsigned int i = 0; i < 8; i++) {
+		auto worker = 1 + i % 2;
+		co_await executor.schedule(worker);
+		assert(helix::Executor::currentWorker() == static_cast<int>(worker));
+
+		// Operations complete on the worker that submitted them.
+		co_await helix::sleepFor(1'000'000);
+		assert(helix::Executor::currentWorker() == static_cast<int>(worker));
+	}
+
+	co_await executor.schedule(0);
+	assert(helix::Executor::currentWorker() == 0);
+}
+
+// Receives more elements on worker 1 than its queue has chunks, but releases them
+// on worker 2. This only completes if worker 1 resupplies the surrendered chunks.
+async::result<void> testReleaseOnOtherWorker(helix::Executor &executor) {
+	auto [lane1, lane2] = helix::createStream();
+
+	for(int i = 0; i < 64; i++) {
+		co_await executor.schedule(1);
+		helix::RecvInlineResult recv;
+		co_await async::when_all(
+			async::lambda([&]() -> async::result<void> {
+				auto [result] = co_await helix_ng::exchangeMsgs(lane2, helix_ng::recvInline());
+				HEL_CHECK(result.error());
+				recv = std::move(result);
+			})(),
+			async::lambda([&]() -> async::result<void> {
+				auto [send] = co_await helix_ng::exchangeMsgs(lane1,
+						helix_ng::sendBuffer(&i, sizeof(int)));
+				HEL_CHECK(send.error());
+			})()
+		);
+
+		co_await executor.schedule(2);
+		int value;
+		assert(recv.length() == sizeof(int));
+		memcpy(&value, recv.data(), sizeof(int));
+		assert(value == i);
+	}
+
+	co_await executor.schedule(0);
+}
+
+// Cancels a sleep on worker 1 from worker 0.
+async::result<void> testCancelFromOtherWorker(helix::Executor &executor) {
+	async::cancellation_event ce;
+
+	co_await executor.schedule(1);
+	bool completed = true;
+	co_await async::when_all(
+		async::lambda([&]() -> async::result<void> {
+			completed = co_await helix::sleepFor(60'000'000'000, ce);
+		})(),
+		// when_all() starts this after the sleep was submitted.
+		async::lambda([&]() -> async::result<void> {
+			executor.post(0, [&] {
+				assert(helix::Executor::currentWorker() == 0);
+				ce.cancel();
+			});
+			co_return;
+		})()
+	);
+	assert(!completed);
+	assert(helix::Executor::currentWorker() == 1);
+
+	co_await executor.schedule(0);
+}
+
+} // anonymous namespace
+
+DEFINE_TEST(executorSchedule, ([] {
+	async::run(testScheduleAcrossWorkers(getExecutor()), helix::currentDispatcher);
+}))
+
+DEFINE_TEST(executorRelease, ([] {
+	async::run(testReleaseOnOtherWorker(getExecutor()), helix::currentDispatcher);
+}))
+
+DEFINE_TEST(executorCancel, ([] {
+	async::run(testCancelFromOtherWorker(getExecutor()), helix::currentDispatcher);
+}))
@@ -0,0 +1,63 @@
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include <async/result.hpp>
+#include <helix/ipc.hpp>
+#include <helix/passthrough-fd.hpp>
+#include <protocols/fs/client.hpp>
+
+#include "testsuite.hpp"
+
+namespace {
+
+// Reads the test binary, which is stored on a file system that supports PT_MAP_CACHE.
+async::result<void> testCachedPread() {
+	int fd = open("/proc/self/exe", O_RDONLY);
+	assert(fd >= 0);
+	struct stat st;
+	assert(!fstat(fd, &st));
+	assert(st.st_size > 0x2000);
+
+	std::vector<char> expected(0x2000);
+	assert(pread(fd, expected.data(), expected.size(), 0) == 0x2000);
+
+	helix::BorrowedLane fileLane{helix::handleForFd(fd)};
+	protocols::fs::File file{fileLane.dup()};
+
+	// The first pread() maps the page cache.
+	std::vector<char> buffer(0x2000);
+	auto first = co_await file.pread(0, buffer.data(), buffer.size());
+	assert(first && *first == 0x2000);
+	assert(!memcmp(buffer.data(), expected.data(), 0x2000));
+
+	// From now on, the server cannot be reached. Reads need to be served from the page cache.
+	HEL_CHECK(helShutdownLane(fileLane.getHandle()));
+
+	for(size_t offset : {0x0, 0x1, 0xF00, 0x1000, 0x1FFF}) {
+		size_t length = std::min(size_t{0x200}, 0x2000 - offset);
+		memset(buffer.data(), 0, buffer.size());
+		auto result = co_await file.pread(offset, buffer.data(), length);
+		assert(result && *result == length);
+		assert(!memcmp(buffer.data(), expected.data() + offset, length));
+	}
+
+	// Reads are truncated at EOF.
+	auto tail = co_await file.pread(st.st_size - 0x10, buffer.data(), 0x100);
+	assert(tail && *tail == 0x10);
+
+	auto eof = co_await file.pread(st.st_size, buffer.data(), 0x100);
+	assert(!eof && eof.error() == protocols::fs::Error::endOfFile);
+
+	close(fd);
+}
+
+} // anonymous namespace
+
+DEFINE_TEST(fsCachedPread, ([] {
+	async::run(testCachedPread(), helix::currentDispatcher);
+}))
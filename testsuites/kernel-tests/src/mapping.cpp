@@ -2,8 +2,11 @@
 #include <cstddef>
 #include <iostream>
 
+#include <async/algorithm.hpp>
+#include <async/result.hpp>
 #include <hel.h>
 #include <hel-syscalls.h>
+#include <helix/ipc.hpp>
 
 #include "testsuite.hpp"
 
@@ -49,3 +52,65 @@ DEFINE_TEST(unmapPartialPreserve, ([] {
 	HEL_CHECK(helUnmapMemory(kHelNullHandle, p, 0x1000));
 	HEL_CHECK(helUnmapMemory(kHelNullHandle, p + 0x2000, 0x1000));
 }))
+
+namespace {
+
+async::result<void> testAsyncMapUnmap() {
+	HelHandle handle;
+	HEL_CHECK(helAllocateMemory(0x2000, 0, nullptr, &handle));
+
+	// Submit both mappings before waiting, such that they are processed in one batch.
+	void *p1 = nullptr;
+	void *p2 = nullptr;
+	co_await async::when_all(
+		async::transform(
+			helix_ng::mapMemory(helix::BorrowedDescriptor{handle},
+					helix::BorrowedDescriptor{kHelNullHandle},
+					nullptr, 0, 0x2000, kHelMapProtRead | kHelMapProtWrite),
+			[&] (auto result) {
+				HEL_CHECK(result.error());
+				p1 = result.pointer();
+			}
+		),
+		async::transform(
+			helix_ng::mapMemory(helix::BorrowedDescriptor{handle},
+					helix::BorrowedDescriptor{kHelNullHandle},
+					nullptr, 0, 0x2000, kHelMapProtRead),
+			[&] (auto result) {
+				HEL_CHECK(result.error());
+				p2 = result.pointer();
+			}
+		)
+	);
+
+	// Both mappings must refer to the same memory.
+	auto p = reinterpret_cast<std::byte *>(p1);
+	auto q = reinterpret_cast<std::byte *>(p2);
+	p[0x1000] = static_cast<std::byte>(42);
+	assert(q[0x1000] == static_cast<std::byte>(42));
+
+	co_await async::when_all(
+		async::transform(
+			helix_ng::unmapMemory(helix::BorrowedDescriptor{kHelNullHandle}, p, 0x2000),
+			[] (auto result) { HEL_CHECK(result.error()); }
+		),
+		async::transform(
+			helix_ng::unmapMemory(helix::BorrowedDescriptor{kHelNullHandle}, q, 0x2000),
+			[] (auto result) { HEL_CHECK(result.error()); }
+		),
+		async::transform(
+			helix_ng::closeDescriptor(kHelThisUniverse, handle),
+			[] (auto result) { HEL_CHECK(result.error()); }
+		)
+	);
+
+	// The descriptor is gone now.
+	auto closeAgain = co_await helix_ng::closeDescriptor(kHelThisUniverse, handle);
+	assert(closeAgain.error() == kHelErrNoDescriptor);
+}
+
+} // anonymous namespace
+
+DEFINE_TEST(asyncMapUnmap, ([] {
+	async::run(testAsyncMapUnmap(), helix::currentDispatcher);
+}))
@@ -1,5 +1,9 @@
 #include <cassert>
+#include <cstdlib>
+#include <cstring>
 #include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
@@ -22,3 +26,112 @@ DEFINE_TEST(stat_pipe, ([] {
 	close(fds[1]);
 }))
 
+
+namespace {
+
+// Creates a directory on the root file system. Unlike /tmp (which is a tmpfs),
+// lookups on the root file system go through the lookup caches of extern_fs.
+void makeTestDirectory(char (&path)[32]) {
+	strcpy(path, "/var/tmp/posix-tests.XXXXXX");
+	if(!mkdtemp(path))
+		assert(!"mkdtemp() failed");
+}
+
+} // anonymous namespace
+
+DEFINE_TEST(stat_create_after_negative_lookup, ([] {
+	char dirPath[32];
+	makeTestDirectory(dirPath);
+	char filePath[64];
+	sprintf(filePath, "%s/file", dirPath);
+
+	// Repeat the lookup such that the negative result is cached.
+	struct stat res;
+	for(int i = 0; i < 2; i++) {
+		int e = stat(filePath, &res);
+		assert(e == -1 && errno == ENOENT);
+	}
+
+	int fd = open(filePath, O_CREAT | O_WRONLY, 0644);
+	assert(fd >= 0);
+	close(fd);
+
+	int e = stat(filePath, &res);
+	assert(!e);
+	assert(S_ISREG(res.st_mode));
+
+	e = unlink(filePath);
+	assert(!e);
+	e = rmdir(dirPath);
+	assert(!e);
+}))
+
+DEFINE_TEST(stat_after_chmod_and_utimes, ([] {
+	char dirPath[32];
+	makeTestDirectory(dirPath);
+	char filePath[64];
+	sprintf(filePath, "%s/file", dirPath);
+
+	int fd = open(filePath, O_CREAT | O_WRONLY, 0644);
+	assert(fd >= 0);
+	close(fd);
+
+	struct stat res;
+	int e = stat(filePath, &res);
+	assert(!e);
+	assert((res.st_mode & 0777) == 0644);
+
+	e = chmod(filePath, 0600);
+	assert(!e);
+	e = stat(filePath, &res);
+	assert(!e);
+	assert((res.st_mode & 0777) == 0600);
+
+	struct timespec times[2] = {{1000000, 0}, {2000000, 0}};
+	e = utimensat(AT_FDCWD, filePath, times, 0);
+	assert(!e);
+	e = stat(filePath, &res);
+	assert(!e);
+	assert(res.st_mtim.tv_sec == 2000000);
+
+	e = unlink(filePath);
+	assert(!e);
+	e = rmdir(dirPath);
+	assert(!e);
+}))
+
+DEFINE_TEST(stat_after_unlink_and_rename, ([] {
+	char dirPath[32];
+	makeTestDirectory(dirPath);
+	char filePath[64];
+	sprintf(filePath, "%s/file", dirPath);
+	char newPath[64];
+	sprintf(newPath, "%s/renamed", dirPath);
+
+	int fd = open(filePath, O_CREAT | O_WRONLY, 0644);
+	assert(fd >= 0);
+	close(fd);
+
+	struct stat res;
+	int e = stat(filePath, &res);
+	assert(!e);
+	auto ino = res.st_ino;
+	e = stat(newPath, &res);
+	assert(e == -1 && errno == ENOENT);
+
+	e = rename(filePath, newPath);
+	assert(!e);
+	e = stat(filePath, &res);
+	assert(e == -1 && errno == ENOENT);
+	e = stat(newPath, &res);
+	assert(!e);
+	assert(res.st_ino == ino);
+
+	e = unlink(newPath);
+	assert(!e);
+	e = stat(newPath, &res);
+	assert(e == -1 && errno == ENOENT);
+
+	e = rmdir(dirPath);
+	assert(!e);
+}))
@@ -3,8 +3,12 @@
 #include <stdio.h>
 #include <sys/eventfd.h>
 #include <sys/wait.h>
+#include <time.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
+
 #include "testsuite.hpp"
 
 struct join_test_data {
@@ -56,3 +60,81 @@ DEFINE_TEST(pthread_join_on_exiting_thread, ([] {
 	assert(WIFEXITED(status));
 	assert(WEXITSTATUS(status) == 0);
 }));
+
+namespace {
+
+struct blocking_wait_data {
+	pid_t child;
+	std::atomic<bool> done{false};
+};
+
+void *waitForChild(void *arg) {
+	auto data = static_cast<blocking_wait_data *>(arg);
+
+	int status;
+	pid_t ret = waitpid(data->child, &status, 0);
+	assert(ret == data->child);
+	// The child is killed by SIGALRM if the parent cannot finish its getpid() calls.
+	assert(WIFEXITED(status));
+	data->done.store(true);
+	return nullptr;
+}
+
+} // anonymous namespace
+
+// Checks that getpid() is served while another thread of the same process blocks
+// in waitpid(), i.e., that a blocking request does not stall other threads.
+DEFINE_TEST(getpid_during_blocking_wait, ([] {
+	constexpr int iterations = 1000;
+
+	int efd = eventfd(0, 0);
+	assert(efd >= 0);
+
+	pid_t child = fork();
+	assert(child >= 0);
+	if(!child) {
+		// Only exit once the parent is done with its getpid() calls.
+		alarm(10);
+		uint64_t val;
+		ssize_t bytes_read = read(efd, &val, sizeof(uint64_t));
+		assert(bytes_read == sizeof(uint64_t));
+		_exit(0);
+	}
+
+	blocking_wait_data data{.child = child};
+	pthread_t waiter;
+	int ret = pthread_create(&waiter, nullptr, waitForChild, &data);
+	assert(!ret);
+
+	// Give the waiter a chance to block in waitpid().
+	usleep(100000);
+
+	pid_t self = getpid();
+	long maxLatency = 0;
+	for(int i = 0; i < iterations; i++) {
+		struct timespec start, end;
+		ret = clock_gettime(CLOCK_MONOTONIC, &start);
+		assert(!ret);
+		pid_t pid = getpid();
+		assert(pid == self);
+		ret = clock_gettime(CLOCK_MONOTONIC, &end);
+		assert(!ret);
+
+		long latency = (end.tv_sec - start.tv_sec) * 1000000000L + (end.tv_nsec - start.tv_nsec);
+		maxLatency = std::max(maxLatency, latency);
+	}
+
+	// All calls completed while waitpid() was still blocked.
+	assert(!data.done.load());
+	// Generous bound that still rules out waiting for the child's alarm.
+	assert(maxLatency < 1'000'000'000L);
+
+	uint64_t val = 1;
+	ssize_t bytes_written = write(efd, &val, sizeof(uint64_t));
+	assert(bytes_written == sizeof(uint64_t));
+
+	ret = pthread_join(waiter, nullptr);
+	assert(!ret);
+	assert(data.done.load());
+	close(efd);
+}))
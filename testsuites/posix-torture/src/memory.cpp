@@ -1,5 +1,7 @@
 #include <cassert>
+#include <stdint.h>
 #include <sys/mman.h>
+#include <unistd.h>
 
 #include "testsuite.hpp"
 
@@ -9,3 +11,45 @@ DEFINE_TEST(map_unmap_anonymous, ([] {
 	assert(window != MAP_FAILED);
 	munmap(window, 0x1000);
 }))
+
+namespace {
+	// Twice the size of physical memory. Filled with compressible data,
+	// such that the kernel can only keep it resident by compressing cold pages.
+	uint64_t *overcommitWindow;
+	size_t overcommitPages;
+	size_t overcommitCursor;
+
+	void fillPage(uint64_t *page, size_t index) {
+		for(size_t i = 0; i < 0x1000 / sizeof(uint64_t); i++)
+			page[i] = (i % 64) ? index : ~index;
+	}
+
+	void checkPage(uint64_t *page, size_t index) {
+		for(size_t i = 0; i < 0x1000 / sizeof(uint64_t); i++)
+			assert(page[i] == ((i % 64) ? index : ~index));
+	}
+}
+
+DEFINE_TEST(overcommit_anonymous, ([] {
+	if(!overcommitWindow) {
+		long physPages = sysconf(_SC_PHYS_PAGES);
+		long pageSize = sysconf(_SC_PAGESIZE);
+		assert(pageSize == 0x1000);
+		overcommitPages = (physPages > 0) ? 2 * physPages : (size_t{1} << 18);
+
+		void *window = mmap(nullptr, overcommitPages * 0x1000, PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		assert(window != MAP_FAILED);
+		overcommitWindow = static_cast<uint64_t *>(window);
+	}
+
+	// Write the next page, then verify a page that was written long ago.
+	auto index = overcommitCursor++;
+	auto page = index % overcommitPages;
+	fillPage(overcommitWindow + page * (0x1000 / sizeof(uint64_t)), index);
+
+	if(index >= overcommitPages / 2) {
+		auto old = index - overcommitPages / 2;
+		checkPage(overcommitWindow + (old % overcommitPages) * (0x1000 / sizeof(uint64_t)), old);
+	}
+}))